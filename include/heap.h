@@ -109,6 +109,27 @@ typedef struct st_heap_block
 
 struct st_heap_info;			/* For referense */
 
+/*
+  Rows of internal temporary tables may be stored in variable-length
+  format: the key columns and everything before them are kept in the
+  fixed-size record in HP_SHARE::block, the remaining columns are packed
+  into a chain of fixed-size chunks in HP_SHARE::var_block.
+  See hp_dynrec.c
+*/
+
+enum en_hp_column_type
+{
+  HP_COLUMN_FIXED, HP_COLUMN_VARCHAR, HP_COLUMN_BLOB
+};
+
+typedef struct st_hp_columndef		/* Column stored in var_block */
+{
+  uint8 type;				/* enum en_hp_column_type */
+  uint8 length_bytes;			/* VARCHAR length / BLOB packlength */
+  uint offset;				/* Offset of the column in record */
+  uint length;				/* Length of the column in record */
+} HP_COLUMNDEF;
+
 typedef struct st_hp_keydef		/* Key definition with open */
 {
   uint flag;				/* HA_NOSAME | HA_NULL_PART_KEY */
@@ -157,6 +178,14 @@ typedef struct st_heap_share
   uint auto_key;
   uint auto_key_type;			/* real type of the auto key segment */
   ulonglong auto_increment;
+  uint fixed_length;			/* Bytes of a record kept in block */
+  uint visible;				/* Offset of the "not deleted" byte */
+  HP_COLUMNDEF *columndef;		/* Columns kept in var_block */
+  uint columns;				/* 0 if rows are fixed-length */
+  uint blobs;				/* Blob columns in columndef */
+  HP_BLOCK var_block;			/* Chunks of variable-length rows */
+  ulong var_chunks;			/* Chunks used or free in var_block */
+  uchar *var_del_link;			/* Link to next free chunk */
 } HP_SHARE;
 
 struct st_hp_hash_info;
@@ -172,6 +201,8 @@ typedef struct st_heap_info
   uint opt_flag,update;
   uchar *lastkey;			/* Last used key with rkey */
   uchar *recbuf;                         /* Record buffer for rb-tree keys */
+  uchar *blob_buff;			/* Blobs of the last read record */
+  size_t blob_buff_length;
   enum ha_rkey_function last_find_flag;
   TREE_ELEMENT *parents[MAX_TREE_HEIGHT+1];
   TREE_ELEMENT **last_pos;
@@ -192,6 +223,10 @@ typedef struct st_heap_create_info
   ulonglong auto_increment;
   my_bool with_auto_increment;
   my_bool internal_table;
+  /* Variable-length rows: columns stored after fixed_length bytes */
+  uint fixed_length;
+  uint columns;
+  HP_COLUMNDEF *columndef;
 } HP_CREATE_INFO;
 
 	/* Prototypes for heap-functions */
@@ -205,6 +240,7 @@ extern int heap_update(HP_INFO *info,const uchar *old,const uchar *newdata);
 extern int heap_rrnd(HP_INFO *info,uchar *buf,uchar *pos);
 extern int heap_scan_init(HP_INFO *info);
 extern int heap_scan(register HP_INFO *info, uchar *record);
+extern int heap_scan_restart(HP_INFO *info, uchar *record, ulong row);
 extern int heap_delete(HP_INFO *info,const uchar *buff);
 extern int heap_info(HP_INFO *info,HEAPINFO *x,int flag);
 extern int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
@@ -235,6 +271,8 @@ int heap_rkey(HP_INFO *info, uchar *record, int inx, const uchar *key,
 extern uchar * heap_find(HP_INFO *info,int inx,const uchar *key);
 extern int heap_check_heap(HP_INFO *info, my_bool print_status);
 extern uchar *heap_position(HP_INFO *info);
+extern ulong heap_row_number(HP_INFO *info);
+extern uchar *heap_row_position(HP_INFO *info, ulong row);
 
 /* The following is for programs that uses the old HEAP interface where
    pointer to rows where a long instead of a (uchar*).
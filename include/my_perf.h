@@ -115,6 +115,16 @@ struct comp_stat_struct {
   ulonglong compressed_primary_usec;
   /** Duration of successful primary index page compressions in microseconds */
   ulonglong compressed_primary_ok_usec;
+  /** Number of page compressions with LZ4 */
+  ulonglong compressed_lz4;
+  /** Number of successful page compressions with LZ4 */
+  ulonglong compressed_lz4_ok;
+  /** Duration of page compressions with LZ4 in microseconds */
+  ulonglong compressed_lz4_usec;
+  /** Number of decompressions of pages compressed with LZ4 */
+  ulonglong decompressed_lz4;
+  /** Duration of decompressions of pages compressed with LZ4 in microseconds */
+  ulonglong decompressed_lz4_usec;
 };
 
 /** Compression statistics */
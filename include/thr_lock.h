@@ -28,7 +28,7 @@ extern "C" {
 #include <my_list.h>
 
 struct st_thr_lock;
-extern ulong locks_immediate,locks_waited ;
+extern ulong locks_immediate,locks_waited,locks_fast;
 
 /*
   Important: if a new lock type is added, a matching lock description
@@ -87,6 +87,7 @@ enum enum_thr_lock_result { THR_LOCK_SUCCESS= 0, THR_LOCK_ABORTED= 1,
 
 extern ulong max_write_lock_count;
 extern ulong table_lock_wait_timeout;
+extern my_bool table_lock_fast_path;
 extern my_bool thr_lock_inited;
 extern enum thr_lock_type thr_upgraded_concurrent_insert_lock;
 
@@ -122,6 +123,7 @@ typedef struct st_thr_lock_data {
   enum thr_lock_type type;
   void *status_param;			/* Param to status functions */
   void *debug_print_param;
+  uint fast_path_state;                 /* THR_LOCK_FAST_xxx, see thr_lock.c */
 } THR_LOCK_DATA;
 
 struct st_lock_list {
@@ -143,6 +145,16 @@ typedef struct st_thr_lock {
   void (*update_status)(void*);		/* Before release of write */
   void (*restore_status)(void*);         /* Before release of read */
   my_bool (*check_status)(void *);
+  /*
+    Fast path for engines that do their own row locking, see
+    thr_lock_set_fast_path(). fast_locks counts the weak locks that were
+    granted without the mutex, slow_locks the strong lock requests that
+    keep new weak locks on the normal path.
+  */
+  my_bool fast_path;
+  volatile int32 fast_locks;
+  volatile int32 slow_locks;
+  pthread_cond_t fast_drained;
 } THR_LOCK;
 
 
@@ -154,6 +166,7 @@ my_bool init_thr_lock(void);		/* Must be called once/thread */
 void thr_lock_info_init(THR_LOCK_INFO *info);
 void thr_lock_init(THR_LOCK *lock);
 void thr_lock_delete(THR_LOCK *lock);
+void thr_lock_set_fast_path(THR_LOCK *lock);
 void thr_lock_data_init(THR_LOCK *lock,THR_LOCK_DATA *data,
 			void *status_param);
 enum enum_thr_lock_result thr_lock(THR_LOCK_DATA *data,
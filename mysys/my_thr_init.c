@@ -379,6 +379,22 @@ struct st_my_thread_var *_my_thread_var(void)
   return  my_pthread_getspecific(struct st_my_thread_var*,THR_KEY_mysys);
 }
 
+#if !defined(__WIN__) || defined(USE_TLS)
+/*
+  Replace the thread specific variables of the current thread
+
+  NOTE
+    Used by thread pools, where a connection keeps its own variables
+    while it is handled by different threads. The variables must come
+    from my_thread_init() in some thread.
+*/
+
+void set_mysys_var(struct st_my_thread_var *mysys_var)
+{
+  pthread_setspecific(THR_KEY_mysys, mysys_var);
+}
+#endif
+
 
 /****************************************************************************
   Get name of current thread.
@@ -70,6 +70,16 @@ The lock algorithm allows one to have one TL_WRITE_ALLOW_READ,
 TL_WRITE_CONCURRENT_INSERT or one TL_WRITE_DELAYED lock at the same time as
 multiple read locks.
 
+Engines that do their own row locking (InnoDB) only ask for the weak
+types TL_READ, TL_READ_WITH_SHARED_LOCKS, TL_READ_HIGH_PRIORITY and
+TL_WRITE_ALLOW_WRITE for normal statements. These are all compatible with
+each other, so for a lock marked with thr_lock_set_fast_path() they are
+granted by incrementing an atomic counter, without taking the lock mutex
+or linking the lock instance into a list. Any other lock type (LOCK TABLES,
+ALTER TABLE ...) first announces itself in slow_locks, which sends new weak
+locks back to the normal path, and then waits for the fast locks to drain
+before it is handled as usual.
+
 */
 
 #if !defined(MAIN) && !defined(DBUG_OFF) && !defined(EXTRA_DEBUG)
@@ -82,10 +92,17 @@ multiple read locks.
 #include "thr_lock.h"
 #include <m_string.h>
 #include <errno.h>
+#include "my_atomic.h"
 
 my_bool thr_lock_inited=0;
-ulong locks_immediate = 0L, locks_waited = 0L;
+ulong locks_immediate = 0L, locks_waited = 0L, locks_fast= 0L;
 ulong table_lock_wait_timeout;
+my_bool table_lock_fast_path= 1;
+
+/* THR_LOCK_DATA::fast_path_state */
+#define THR_LOCK_FAST_NONE    0         /* Normal lock, not counted */
+#define THR_LOCK_FAST_GRANTED 1         /* Granted on the fast path */
+#define THR_LOCK_FAST_SLOW    2         /* Counted in lock->slow_locks */
 enum thr_lock_type thr_upgraded_concurrent_insert_lock = TL_WRITE;
 
 /* The following constants are only for debug output */
@@ -322,6 +339,7 @@ void thr_lock_init(THR_LOCK *lock)
   lock->read_wait.last= &lock->read_wait.data;
   lock->write_wait.last= &lock->write_wait.data;
   lock->write.last= &lock->write.data;
+  VOID(pthread_cond_init(&lock->fast_drained, NULL));
 
   pthread_mutex_lock(&THR_LOCK_lock);		/* Add to locks in use */
   lock->list.data=(void*) lock;
@@ -337,11 +355,28 @@ void thr_lock_delete(THR_LOCK *lock)
   pthread_mutex_lock(&THR_LOCK_lock);
   thr_lock_thread_list=list_delete(thr_lock_thread_list,&lock->list);
   pthread_mutex_unlock(&THR_LOCK_lock);
+  pthread_cond_destroy(&lock->fast_drained);
   pthread_mutex_destroy(&lock->mutex);
   DBUG_VOID_RETURN;
 }
 
 
+/*
+  Let weak locks on this lock skip the mutex and the lock lists.
+
+  Only for engines that do their own locking and don't use the
+  get_status/update_status callbacks. Must be called before the lock is
+  used.
+*/
+
+void thr_lock_set_fast_path(THR_LOCK *lock)
+{
+  DBUG_ASSERT(!lock->get_status && !lock->update_status &&
+              !lock->restore_status && !lock->check_status);
+  lock->fast_path= 1;
+}
+
+
 void thr_lock_info_init(THR_LOCK_INFO *info)
 {
   struct st_my_thread_var *tmp= my_thread_var;
@@ -359,6 +394,7 @@ void thr_lock_data_init(THR_LOCK *lock,THR_LOCK_DATA *data, void *param)
   data->owner= 0;                               /* no owner yet */
   data->status_param=param;
   data->cond=0;
+  data->fast_path_state= THR_LOCK_FAST_NONE;
 }
 
 
@@ -388,6 +424,108 @@ static inline my_bool have_specific_lock(THR_LOCK_DATA *data,
 static void wake_up_waiters(THR_LOCK *lock);
 
 
+/* The lock types that may be granted on the fast path */
+
+static inline my_bool thr_lock_type_is_fast(enum thr_lock_type lock_type)
+{
+  return (lock_type == TL_READ ||
+          lock_type == TL_READ_WITH_SHARED_LOCKS ||
+          lock_type == TL_READ_HIGH_PRIORITY ||
+          lock_type == TL_WRITE_ALLOW_WRITE);
+}
+
+
+static inline void release_fast_lock(THR_LOCK *lock)
+{
+  /* Wake up strong lock requests waiting for the last fast lock */
+  if (my_atomic_add32(&lock->fast_locks, -1) == 1 &&
+      my_atomic_load32(&lock->slow_locks))
+  {
+    pthread_mutex_lock(&lock->mutex);
+    pthread_cond_broadcast(&lock->fast_drained);
+    pthread_mutex_unlock(&lock->mutex);
+  }
+}
+
+
+/*
+  Try to grant a weak lock without the lock mutex.
+
+  The counter increments are full barriers, so either we see the
+  strong request in slow_locks, or it sees our lock in fast_locks.
+*/
+
+static inline my_bool get_fast_lock(THR_LOCK *lock)
+{
+  my_atomic_add32(&lock->fast_locks, 1);
+  if (!my_atomic_load32(&lock->slow_locks))
+    return 1;
+  release_fast_lock(lock);
+  return 0;
+}
+
+
+/*
+  Announce a strong lock request and wait until all fast locks on the
+  lock are released. On success the request stays counted in slow_locks
+  until the lock is released.
+*/
+
+static enum enum_thr_lock_result
+wait_for_fast_locks(THR_LOCK *lock, THR_LOCK_OWNER *owner)
+{
+  struct st_my_thread_var *thread_var;
+  struct timespec wait_timeout;
+  enum enum_thr_lock_result result= THR_LOCK_SUCCESS;
+  my_bool can_deadlock;
+  DBUG_ENTER("wait_for_fast_locks");
+
+  my_atomic_add32(&lock->slow_locks, 1);
+  if (!my_atomic_load32(&lock->fast_locks))
+    DBUG_RETURN(THR_LOCK_SUCCESS);
+
+  thread_var= my_thread_var;
+  can_deadlock= test(owner->info->n_cursors);
+  pthread_mutex_lock(&lock->mutex);
+  thread_var->current_mutex= &lock->mutex;
+  thread_var->current_cond=  &lock->fast_drained;
+  statistic_increment(locks_waited, &THR_LOCK_lock);
+
+  if (can_deadlock)
+    set_timespec(wait_timeout, table_lock_wait_timeout);
+  while (my_atomic_load32(&lock->fast_locks))
+  {
+    int rc;
+    if (thread_var->abort)
+    {
+      result= THR_LOCK_ABORTED;
+      break;
+    }
+    rc= (can_deadlock ?
+         pthread_cond_timedwait(&lock->fast_drained, &lock->mutex,
+                                &wait_timeout) :
+         pthread_cond_wait(&lock->fast_drained, &lock->mutex));
+    if ((rc == ETIMEDOUT || rc == ETIME) &&
+        my_atomic_load32(&lock->fast_locks))
+    {
+      DBUG_PRINT("thr_lock", ("wait for fast locks timed out"));
+      result= THR_LOCK_WAIT_TIMEOUT;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&lock->mutex);
+
+  pthread_mutex_lock(&thread_var->mutex);
+  thread_var->current_mutex= 0;
+  thread_var->current_cond=  0;
+  pthread_mutex_unlock(&thread_var->mutex);
+
+  if (result != THR_LOCK_SUCCESS)
+    my_atomic_add32(&lock->slow_locks, -1);
+  DBUG_RETURN(result);
+}
+
+
 static enum enum_thr_lock_result
 wait_for_lock(struct st_lock_list *wait, THR_LOCK_DATA *data,
               my_bool in_wait_list)
@@ -509,9 +647,14 @@ wait_for_lock(struct st_lock_list *wait, THR_LOCK_DATA *data,
 }
 
 
-enum enum_thr_lock_result
-thr_lock(THR_LOCK_DATA *data, THR_LOCK_OWNER *owner,
-         enum thr_lock_type lock_type)
+/*
+  Get a lock. allow_fast is false when the caller also asks for a strong
+  lock on the same THR_LOCK, which would wait for our own fast lock.
+*/
+
+static enum enum_thr_lock_result
+thr_lock_low(THR_LOCK_DATA *data, THR_LOCK_OWNER *owner,
+             enum thr_lock_type lock_type, my_bool allow_fast)
 {
   THR_LOCK *lock=data->lock;
   enum enum_thr_lock_result result= THR_LOCK_SUCCESS;
@@ -523,6 +666,30 @@ thr_lock(THR_LOCK_DATA *data, THR_LOCK_OWNER *owner,
   data->cond=0;					/* safety */
   data->type=lock_type;
   data->owner= owner;                           /* Must be reset ! */
+  data->fast_path_state= THR_LOCK_FAST_NONE;
+  if (lock->fast_path)
+  {
+    if (thr_lock_type_is_fast(lock_type))
+    {
+      if (allow_fast && table_lock_fast_path && get_fast_lock(lock))
+      {
+        DBUG_PRINT("lock",("data: 0x%lx  lock: 0x%lx  type: %d  fast path",
+                           (long) data, (long) lock, (int) lock_type));
+        data->fast_path_state= THR_LOCK_FAST_GRANTED;
+        statistic_increment(locks_fast, &THR_LOCK_lock);
+        DBUG_RETURN(THR_LOCK_SUCCESS);
+      }
+    }
+    else
+    {
+      if ((result= wait_for_fast_locks(lock, owner)) != THR_LOCK_SUCCESS)
+      {
+        data->type= TL_UNLOCK;
+        DBUG_RETURN(result);
+      }
+      data->fast_path_state= THR_LOCK_FAST_SLOW;
+    }
+  }
   VOID(pthread_mutex_lock(&lock->mutex));
   DBUG_PRINT("lock",("data: 0x%lx  thread: 0x%lx  lock: 0x%lx  type: %d",
                      (long) data, data->owner->info->thread_id,
@@ -724,13 +891,29 @@ thr_lock(THR_LOCK_DATA *data, THR_LOCK_OWNER *owner,
     goto end;
   }
   /* Can't get lock yet;  Wait for it */
-  DBUG_RETURN(wait_for_lock(wait_queue, data, 0));
+  result= wait_for_lock(wait_queue, data, 0);
+  goto unlocked;
 end:
   pthread_mutex_unlock(&lock->mutex);
+unlocked:
+  if (result != THR_LOCK_SUCCESS &&
+      data->fast_path_state == THR_LOCK_FAST_SLOW)
+  {
+    data->fast_path_state= THR_LOCK_FAST_NONE;
+    my_atomic_add32(&lock->slow_locks, -1);
+  }
   DBUG_RETURN(result);
 }
 
 
+enum enum_thr_lock_result
+thr_lock(THR_LOCK_DATA *data, THR_LOCK_OWNER *owner,
+         enum thr_lock_type lock_type)
+{
+  return thr_lock_low(data, owner, lock_type, 1);
+}
+
+
 static inline void free_all_read_locks(THR_LOCK *lock,
 				       my_bool using_concurrent_insert)
 {
@@ -787,9 +970,17 @@ void thr_unlock(THR_LOCK_DATA *data)
 {
   THR_LOCK *lock=data->lock;
   enum thr_lock_type lock_type=data->type;
+  uint fast_path_state= data->fast_path_state;
   DBUG_ENTER("thr_unlock");
   DBUG_PRINT("lock",("data: 0x%lx  thread: 0x%lx  lock: 0x%lx",
                      (long) data, data->owner->info->thread_id, (long) lock));
+  data->fast_path_state= THR_LOCK_FAST_NONE;
+  if (fast_path_state == THR_LOCK_FAST_GRANTED)
+  {
+    data->type=TL_UNLOCK;			/* Mark unlocked */
+    release_fast_lock(lock);
+    DBUG_VOID_RETURN;
+  }
   pthread_mutex_lock(&lock->mutex);
   check_locks(lock,"start of release lock",0);
 
@@ -823,6 +1014,8 @@ void thr_unlock(THR_LOCK_DATA *data)
   check_locks(lock,"after releasing lock",1);
   wake_up_waiters(lock);
   pthread_mutex_unlock(&lock->mutex);
+  if (fast_path_state == THR_LOCK_FAST_SLOW)
+    my_atomic_add32(&lock->slow_locks, -1);
   DBUG_VOID_RETURN;
 }
 
@@ -986,6 +1179,7 @@ enum enum_thr_lock_result
 thr_multi_lock(THR_LOCK_DATA **data, uint count, THR_LOCK_OWNER *owner)
 {
   THR_LOCK_DATA **pos,**end;
+  my_bool allow_fast= 1;
   DBUG_ENTER("thr_multi_lock");
   DBUG_PRINT("lock",("data: 0x%lx  count: %d", (long) data, count));
   if (count > 1)
@@ -993,7 +1187,23 @@ thr_multi_lock(THR_LOCK_DATA **data, uint count, THR_LOCK_OWNER *owner)
   /* lock everything */
   for (pos=data,end=data+count; pos < end ; pos++)
   {
-    enum enum_thr_lock_result result= thr_lock(*pos, owner, (*pos)->type);
+    enum enum_thr_lock_result result;
+    if ((*pos)->lock->fast_path &&
+        (pos == data || pos[-1]->lock != (*pos)->lock))
+    {
+      /*
+        Don't take fast locks on a lock we also lock strongly, as the
+        strong lock would wait for them.
+      */
+      THR_LOCK_DATA **next;
+      allow_fast= 1;
+      for (next= pos; next < end && (*next)->lock == (*pos)->lock; next++)
+      {
+        if (!thr_lock_type_is_fast((*next)->type))
+          allow_fast= 0;
+      }
+    }
+    result= thr_lock_low(*pos, owner, (*pos)->type, allow_fast);
     if (result != THR_LOCK_SUCCESS)
     {						/* Aborted */
       thr_multi_unlock(data,(uint) (pos-data));
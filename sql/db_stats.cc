@@ -3,7 +3,6 @@
 #include "my_perf.h"
 #include <stdio.h>
 
-#define MAX_DB_STATS_ENTRIES 255
 HASH global_db_stats_hash;
 DB_STATS* global_db_stats_array;
 static pthread_mutex_t LOCK_global_db_stats;
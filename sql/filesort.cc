@@ -48,11 +48,16 @@ static uchar **make_char_array(uchar **old_pos, uint fields,
                               uint length, myf my_flag);
 static uchar *read_buffpek_from_file(IO_CACHE *buffer_file, uint count,
                                      uchar *buf);
+class Sort_chunks;
+static int compare_sort_keys(void *sort_length, uchar *a, uchar *b);
 static ha_rows find_all_keys(SORTPARAM *param,SQL_SELECT *select,
 			     uchar * *sort_keys, IO_CACHE *buffer_file,
-			     IO_CACHE *tempfile,IO_CACHE *indexfile);
+			     IO_CACHE *tempfile,IO_CACHE *indexfile,
+			     Sort_chunks *chunks, QUEUE *pq);
 static int write_keys(SORTPARAM *param,uchar * *sort_keys,
 		      uint count, IO_CACHE *buffer_file, IO_CACHE *tempfile);
+static int write_sorted_keys(SORTPARAM *param, uchar **sort_keys, uint count,
+                             IO_CACHE *buffpek_pointers, IO_CACHE *tempfile);
 static void make_sortkey(SORTPARAM *param,uchar *to, uchar *ref_pos);
 static void register_used_fields(SORTPARAM *param);
 static int merge_index(SORTPARAM *param,uchar *sort_buffer,
@@ -60,14 +65,564 @@ static int merge_index(SORTPARAM *param,uchar *sort_buffer,
 		       uint maxbuffer,IO_CACHE *tempfile,
 		       IO_CACHE *outfile);
 static bool save_index(SORTPARAM *param,uchar **sort_keys, uint count, 
-                       FILESORT_INFO *table_sort);
+                       FILESORT_INFO *table_sort, uint chunk_keys);
 static uint suffix_length(ulong string_length);
 static uint sortlength(THD *thd, SORT_FIELD *sortorder, uint s_length,
 		       bool *multi_byte_charset);
 static SORT_ADDON_FIELD *get_addon_fields(THD *thd, Field **ptabfield,
-                                          uint sortlength, uint *plength);
+                                          uint sortlength, uint *plength,
+                                          bool *ppacked);
 static void unpack_addon_fields(struct st_sort_addon_field *addon_field,
                                 uchar *buff);
+static void unpack_packed_addon_fields(struct st_sort_addon_field *addon_field,
+                                       uchar *buff);
+static uint read_packed_to_buffer(SORTPARAM *param, IO_CACHE *fromfile,
+                                  BUFFPEK *buffpek);
+
+/*
+  Parallel filesort
+
+  When sort_threads > 1 and the sort buffer holds enough keys, filesort()
+  starts sort_threads - 1 helper threads for the sort:
+
+  - The sort buffer is split in one chunk per thread. The connection
+    thread reads the rows and makes their keys in one chunk while the
+    helpers sort the chunks that are full. A sorted chunk is written as
+    a run only when its space is needed again, so the chunks of an input
+    that fits in the sort buffer are merged in memory by save_index().
+  - merge_many_buff_parallel() merges the groups of runs of each merge
+    pass in parallel. Each group uses its own part of the sort buffer and
+    writes at its own offset of the output file.
+
+  The connection thread runs queued jobs too while it waits, so a sort
+  uses at most sort_threads threads, and it completes on its own if no
+  helper thread could be started. Sort keys are always made by the
+  connection thread, as they evaluate items of the query.
+*/
+
+/* Smallest chunk of the sort buffer worth sorting in another thread */
+#define MIN_SORT_CHUNK_KEYS 1024
+
+class Sort_job
+{
+public:
+  Sort_job *next;
+  bool done;
+  int error;
+  Sort_job() :next(0), done(TRUE), error(0) {}
+  virtual ~Sort_job() {}
+  /* Do the job using the sort buffer part of thread 'slot' */
+  virtual int run(uint slot)= 0;
+};
+
+
+class Sort_workers
+{
+public:
+  struct st_worker
+  {
+    Sort_workers *workers;
+    pthread_t thread;
+    uint slot;
+  };
+
+  Sort_workers()
+    :slots(1), thd(0), workers(0), stopping(FALSE), first(0), last(&first)
+  {}
+  ~Sort_workers() { stop(); }
+  void start(THD *thd, uint threads);
+  void add(Sort_job *job);
+  int wait(Sort_job *job);
+  void run_jobs(uint slot);
+  void stop();
+  /* Number of threads that run jobs, the connection thread included */
+  uint slots;
+  THD *thd;
+
+private:
+  Sort_job *pop_job();
+  void job_done(Sort_job *job, int error);
+
+  struct st_worker *workers;
+  pthread_mutex_t lock;
+  pthread_cond_t cond_job, cond_done;
+  bool stopping;
+  Sort_job *first, **last;
+};
+
+
+pthread_handler_t sort_worker_thread(void *arg)
+{
+  my_thread_init();
+  Sort_workers::st_worker *worker= (Sort_workers::st_worker*) arg;
+  /* merge_buffers() checks if the query is killed */
+  my_pthread_setspecific_ptr(THR_THD, worker->workers->thd);
+  worker->workers->run_jobs(worker->slot);
+  my_thread_end();
+  pthread_exit(0);
+  return 0;
+}
+
+
+/**
+  Start the helper threads of a sort.
+
+  @param thd      Thread of the sort
+  @param threads  Number of threads the sort may use
+*/
+
+void Sort_workers::start(THD *thd_arg, uint threads)
+{
+  pthread_attr_t attr;
+  thd= thd_arg;
+  if (!(workers= (struct st_worker*) my_malloc(sizeof(*workers) * threads,
+                                               MYF(0))))
+    return;
+  pthread_mutex_init(&lock, MY_MUTEX_INIT_FAST);
+  pthread_cond_init(&cond_job, NULL);
+  pthread_cond_init(&cond_done, NULL);
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+  for (slots= 1; slots < threads; slots++)
+  {
+    struct st_worker *worker= workers + slots;
+    worker->workers= this;
+    worker->slot= slots;
+    if (pthread_create(&worker->thread, &attr, sort_worker_thread,
+                       (void*) worker))
+      break;
+  }
+  pthread_attr_destroy(&attr);
+  DBUG_PRINT("info", ("sort threads: %u", slots));
+}
+
+
+void Sort_workers::stop()
+{
+  if (!workers)
+    return;
+  pthread_mutex_lock(&lock);
+  stopping= TRUE;
+  pthread_cond_broadcast(&cond_job);
+  pthread_mutex_unlock(&lock);
+  for (uint i= 1; i < slots; i++)
+    pthread_join(workers[i].thread, NULL);
+  DBUG_ASSERT(!first);
+  my_free(workers, MYF(0));
+  workers= 0;
+  slots= 1;
+  pthread_mutex_destroy(&lock);
+  pthread_cond_destroy(&cond_job);
+  pthread_cond_destroy(&cond_done);
+}
+
+
+void Sort_workers::add(Sort_job *job)
+{
+  job->done= FALSE;
+  job->next= 0;
+  if (slots == 1)
+  {
+    /* No helpers: the job is run when it is waited for */
+    *last= job;
+    last= &job->next;
+    return;
+  }
+  pthread_mutex_lock(&lock);
+  *last= job;
+  last= &job->next;
+  pthread_cond_signal(&cond_job);
+  pthread_mutex_unlock(&lock);
+}
+
+
+/* Take the first queued job; lock is held */
+
+Sort_job *Sort_workers::pop_job()
+{
+  Sort_job *job;
+  if ((job= first) && !(first= job->next))
+    last= &first;
+  return job;
+}
+
+
+void Sort_workers::job_done(Sort_job *job, int error)
+{
+  job->error= error;
+  job->done= TRUE;
+  pthread_cond_broadcast(&cond_done);
+}
+
+
+void Sort_workers::run_jobs(uint slot)
+{
+  pthread_mutex_lock(&lock);
+  for (;;)
+  {
+    Sort_job *job;
+    int error;
+    if (!(job= pop_job()))
+    {
+      if (stopping)
+        break;
+      pthread_cond_wait(&cond_job, &lock);
+      continue;
+    }
+    pthread_mutex_unlock(&lock);
+    error= job->run(slot);
+    pthread_mutex_lock(&lock);
+    job_done(job, error);
+  }
+  pthread_mutex_unlock(&lock);
+}
+
+
+/**
+  Wait until a job is done, running queued jobs in the meantime.
+
+  @return The error of the job
+*/
+
+int Sort_workers::wait(Sort_job *job)
+{
+  if (slots == 1)
+  {
+    /* Only this thread: run the queue up to the job */
+    while (!job->done)
+    {
+      Sort_job *next= pop_job();
+      next->error= next->run(0);
+      next->done= TRUE;
+    }
+    return job->error;
+  }
+  pthread_mutex_lock(&lock);
+  while (!job->done)
+  {
+    Sort_job *next;
+    int error;
+    if (!(next= pop_job()))
+    {
+      pthread_cond_wait(&cond_done, &lock);
+      continue;
+    }
+    pthread_mutex_unlock(&lock);
+    error= next->run(0);
+    pthread_mutex_lock(&lock);
+    job_done(next, error);
+  }
+  pthread_mutex_unlock(&lock);
+  return job->error;
+}
+
+
+/* Sort one chunk of the sort buffer */
+
+class Sort_chunk_job :public Sort_job
+{
+public:
+  uchar **keys;
+  uint count;
+  size_t sort_length;
+  int run(uint slot)
+  {
+    my_string_ptr_sort((uchar*) keys, count, sort_length);
+    return 0;
+  }
+};
+
+
+/**
+  The chunks of the sort buffer of a parallel sort, see find_all_keys().
+*/
+
+class Sort_chunks
+{
+public:
+  Sort_workers *workers;
+  Sort_chunk_job chunk[MAX_SORT_THREADS];
+  uchar **sort_keys;
+  uint chunks, chunk_keys;
+  uint current;                         /* Chunk where keys are made */
+  bool written;                         /* A chunk was written as a run */
+
+  void init(Sort_workers *workers_arg, uchar **sort_keys_arg, uint keys,
+            size_t sort_length)
+  {
+    workers= workers_arg;
+    sort_keys= sort_keys_arg;
+    chunks= workers->slots;
+    chunk_keys= keys / chunks;
+    current= 0;
+    written= FALSE;
+    for (uint i= 0; i < chunks; i++)
+    {
+      chunk[i].keys= sort_keys + i * chunk_keys;
+      chunk[i].count= 0;
+      chunk[i].sort_length= sort_length;
+    }
+  }
+  /* Index in sort_keys of the end of the current chunk */
+  uint end() { return (current + 1) * chunk_keys; }
+  uint next(SORTPARAM *param, IO_CACHE *buffpek_pointers,
+            IO_CACHE *tempfile);
+  int finish(SORTPARAM *param, uint idx, IO_CACHE *buffpek_pointers,
+             IO_CACHE *tempfile);
+  void abort();
+};
+
+
+/**
+  Hand the full current chunk to the sort threads and take the next one,
+  writing it as a run if it holds keys.
+
+  @return Index in sort_keys of the first key of the new chunk, or
+          UINT_MAX on error
+*/
+
+uint Sort_chunks::next(SORTPARAM *param, IO_CACHE *buffpek_pointers,
+                       IO_CACHE *tempfile)
+{
+  Sort_chunk_job *job= chunk + current;
+  job->count= chunk_keys;
+  workers->add(job);
+  current= (current + 1) % chunks;
+  job= chunk + current;
+  if (job->count)
+  {
+    if (workers->wait(job) ||
+        write_sorted_keys(param, job->keys, job->count, buffpek_pointers,
+                          tempfile))
+      return UINT_MAX;
+    job->count= 0;
+    written= TRUE;
+  }
+  return current * chunk_keys;
+}
+
+
+/**
+  Sort the last chunk and wait for the others.
+
+  If some chunk was written, all chunks are written as runs in the order
+  they were filled. Otherwise the keys are sort_keys[0..idx), sorted by
+  chunks of chunk_keys keys.
+
+  @param idx  Index in sort_keys after the last key made
+*/
+
+int Sort_chunks::finish(SORTPARAM *param, uint idx,
+                        IO_CACHE *buffpek_pointers, IO_CACHE *tempfile)
+{
+  Sort_chunk_job *job= chunk + current;
+  int error= 0;
+  if ((job->count= idx - current * chunk_keys))
+    workers->add(job);
+  for (uint i= 1; i <= chunks; i++)
+  {
+    job= chunk + (current + i) % chunks;
+    if (!job->count)
+      continue;
+    if (workers->wait(job))
+      error= 1;
+    else if (written && !error &&
+             write_sorted_keys(param, job->keys, job->count,
+                               buffpek_pointers, tempfile))
+      error= 1;
+  }
+  return error;
+}
+
+
+/* Wait for the chunks being sorted; the sort has failed */
+
+void Sort_chunks::abort()
+{
+  for (uint i= 0; i < chunks; i++)
+  {
+    if (chunk[i].count)
+      workers->wait(chunk + i);
+  }
+}
+
+
+/* Merge one group of runs of a merge pass, see merge_many_buff_parallel() */
+
+class Sort_merge_job :public Sort_job
+{
+public:
+  SORTPARAM *param;
+  uchar *sort_buffer;
+  uint slot_keys;
+  IO_CACHE *from_file;
+  File to_file;
+  my_off_t to_pos;
+  BUFFPEK *first_buff, *last_buff;
+  BUFFPEK result;
+  int run(uint slot);
+};
+
+
+/*
+  IO_CACHE write_function of Sort_merge_job: the cache writes to its
+  offset of a file shared by the jobs with pwrite(), never with a seek
+  of the file.
+*/
+
+static int flush_merge_cache(IO_CACHE *info)
+{
+  size_t length= (size_t) (info->write_pos - info->write_buffer);
+  if (length &&
+      my_pwrite(info->file, info->write_buffer, length, info->pos_in_file,
+                info->myflags | MY_NABP))
+    return (info->error= -1);
+  info->pos_in_file+= length;
+  info->write_pos= info->write_buffer;
+  info->write_end= info->write_buffer + info->buffer_length;
+  return 0;
+}
+
+
+static int write_merge_cache(IO_CACHE *info, const uchar *buffer,
+                             size_t count)
+{
+  for (;;)
+  {
+    size_t rest= (size_t) (info->write_end - info->write_pos);
+    if (count <= rest)
+    {
+      memcpy(info->write_pos, buffer, count);
+      info->write_pos+= count;
+      return 0;
+    }
+    memcpy(info->write_pos, buffer, rest);
+    info->write_pos+= rest;
+    buffer+= rest;
+    count-= rest;
+    if (flush_merge_cache(info))
+      return 1;
+  }
+}
+
+
+int Sort_merge_job::run(uint slot)
+{
+  SORTPARAM job_param= *param;
+  IO_CACHE to_cache;
+  int error;
+
+  job_param.keys= slot_keys;
+  if (init_io_cache(&to_cache, to_file, DISK_BUFFER_SIZE, WRITE_CACHE,
+                    to_pos, 0, MYF(MY_WME)))
+    return 1;
+  to_cache.write_function= write_merge_cache;
+  error= merge_buffers(&job_param, from_file, &to_cache,
+                       sort_buffer + slot * slot_keys * param->rec_length,
+                       &result, first_buff, last_buff, 0);
+  if (flush_merge_cache(&to_cache))
+    error= 1;
+  end_io_cache(&to_cache);
+  return error;
+}
+
+
+/**
+  Merge buffers to make < MERGEBUFF2 buffers, like merge_many_buff(),
+  with the groups of each pass merged in parallel.
+
+  A group of runs makes no more bytes than its runs, so the offset of
+  each group in the output file is known before the pass starts. With
+  max_rows a group may leave a gap after its result.
+*/
+
+static int merge_many_buff_parallel(SORTPARAM *param, uchar *sort_buffer,
+                                    BUFFPEK *buffpek, uint *maxbuffer,
+                                    IO_CACHE *t_file, Sort_workers *workers)
+{
+  Sort_merge_job job[MAX_SORT_THREADS];
+  IO_CACHE t_file2, *from_file, *to_file, *temp;
+  uint slots= workers->slots;
+  uint slot_keys= param->keys / slots;
+  int error= 0;
+  DBUG_ENTER("merge_many_buff_parallel");
+
+  if (*maxbuffer < MERGEBUFF2)
+    DBUG_RETURN(0);
+  if (flush_io_cache(t_file) ||
+      open_cached_file(&t_file2,mysql_tmpdir,TEMP_PREFIX,DISK_BUFFER_SIZE,
+			MYF(MY_WME)))
+    DBUG_RETURN(1);
+  if (real_open_cached_file(&t_file2))
+  {
+    close_cached_file(&t_file2);
+    DBUG_RETURN(1);
+  }
+
+  for (uint j= 0; j < slots; j++)
+  {
+    job[j].param= param;
+    job[j].sort_buffer= sort_buffer;
+    job[j].slot_keys= slot_keys;
+  }
+  from_file= t_file ; to_file= &t_file2;
+  while (*maxbuffer >= MERGEBUFF2 && !error)
+  {
+    my_off_t to_pos= 0;
+    uint i= 0, groups= 0;
+    bool last= FALSE;
+
+    while (!last && !error)
+    {
+      uint jobs;
+      /* Start a group per thread, in the order of merge_many_buff() */
+      for (jobs= 0; jobs < slots && !last; jobs++)
+      {
+        Sort_merge_job *group= job + jobs;
+        group->from_file= from_file;
+        group->to_file= to_file->file;
+        group->to_pos= to_pos;
+        group->first_buff= buffpek + i;
+        if (i + MERGEBUFF * 3 / 2 <= *maxbuffer)
+          i+= MERGEBUFF;
+        else
+        {
+          i= *maxbuffer + 1;
+          last= TRUE;
+        }
+        group->last_buff= buffpek + i - 1;
+        for (BUFFPEK *b= group->first_buff; b <= group->last_buff; b++)
+          to_pos+= b->end_pos - b->file_pos;
+        workers->add(group);
+      }
+      /*
+        Each pass stores the result of group N in buffpek[N], which the
+        groups that are not started yet don't read.
+      */
+      for (uint j= 0; j < jobs; j++)
+      {
+        if (workers->wait(job + j))
+          error= 1;
+        else
+          buffpek[groups + j]= job[j].result;
+      }
+      groups+= jobs;
+    }
+    if (error)
+      break;
+    temp=from_file; from_file=to_file; to_file=temp;
+    *maxbuffer= groups - 1;
+  }
+  close_cached_file(to_file);			// This holds old result
+  if (to_file == t_file)
+  {
+    *t_file=t_file2;				// Copy result file
+    setup_io_cache(t_file);
+  }
+  DBUG_RETURN(error || *maxbuffer >= MERGEBUFF2);
+}
+
+
 /**
   Sort a table.
   Creates a set of pointers that can be used to read the rows
@@ -117,6 +672,10 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
   IO_CACHE tempfile, buffpek_pointers, *selected_records_file, *outfile; 
   SORTPARAM param;
   bool multi_byte_charset;
+  Sort_workers workers;
+  Sort_chunks sort_chunks, *chunks= 0;
+  QUEUE pq;
+  bool use_pq;
   DBUG_ENTER("filesort");
   DBUG_EXECUTE("info",TEST_filesort(sortorder,s_length););
 #ifdef SKIP_DBUG_IN_FILESORT
@@ -143,6 +702,7 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
   outfile= table_sort.io_cache;
   my_b_clear(&tempfile);
   my_b_clear(&buffpek_pointers);
+  bzero((char*) &pq, sizeof(pq));
   buffpek=0;
   error= 1;
   bzero((char*) &param,sizeof(param));
@@ -159,13 +719,16 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
     */
     param.addon_field= get_addon_fields(thd, table->field, 
                                         param.sort_length,
-                                        &param.addon_length);
+                                        &param.addon_length,
+                                        &param.packed_addons);
   }
 
   table_sort.addon_buf= 0;
   table_sort.addon_length= param.addon_length;
   table_sort.addon_field= param.addon_field;
-  table_sort.unpack= unpack_addon_fields;
+  table_sort.unpack= (param.packed_addons ? unpack_packed_addon_fields :
+                      unpack_addon_fields);
+  table_sort.packed_addons= param.packed_addons;
   if (param.addon_field)
   {
     param.res_length= param.addon_length;
@@ -219,11 +782,20 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
 
   memavl= thd->variables.sortbuff_size;
   min_sort_memory= max(MIN_SORT_MEMORY, param.sort_length*MERGEBUFF2);
+  /*
+    With ORDER BY ... LIMIT, if the first max_rows keys and one more fit
+    in the sort buffer, keep the smallest keys in a priority queue while
+    the rows are read. The rows are never written to disk or merged.
+  */
+  use_pq= (max_rows && max_rows < records &&
+           max_rows < memavl / (param.rec_length + sizeof(char*)));
   while (memavl >= min_sort_memory)
   {
     ulong old_memavl;
     ulong keys= memavl/(param.rec_length+sizeof(char*));
     param.keys=(uint) min(records+1, keys);
+    if (use_pq)
+      param.keys= (uint) max_rows + 1;
 
     if (table_sort.sort_keys &&
         table_sort.sort_keys_size != char_array_size(param.keys,
@@ -257,15 +829,42 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
   param.keys--;  			/* TODO: check why we do this */
   param.sort_form= table;
   param.end=(param.local_sortorder=sortorder)+s_length;
+  if (use_pq)
+  {
+    if (init_queue(&pq, param.keys, 0, 1, compare_sort_keys,
+                   (void*) &param.sort_length))
+      goto err;
+    status_var_increment(thd->status_var.filesort_pq_sorts);
+  }
+  else if (thd->variables.sort_threads > 1 && !selected_records_file &&
+           param.keys / thd->variables.sort_threads >= MIN_SORT_CHUNK_KEYS)
+  {
+    workers.start(thd, (uint) thd->variables.sort_threads);
+    if (workers.slots > 1)
+    {
+      sort_chunks.init(&workers, sort_keys, param.keys, param.sort_length);
+      chunks= &sort_chunks;
+    }
+  }
+  if (param.packed_addons && !use_pq && !chunks)
+  {
+    /*
+      The records take their packed length in the sort buffer: the key
+      pointers are stored from its start and the records from its end.
+    */
+    param.sort_buffer_end= (uchar*) sort_keys + table_sort.sort_keys_size;
+  }
   if ((records=find_all_keys(&param,select,sort_keys, &buffpek_pointers,
-			     &tempfile, selected_records_file)) ==
+			     &tempfile, selected_records_file, chunks,
+			     use_pq ? &pq : 0)) ==
       HA_POS_ERROR)
     goto err;
   maxbuffer= (uint) (my_b_tell(&buffpek_pointers)/sizeof(*buffpek));
 
   if (maxbuffer == 0)			// The whole set is in memory
   {
-    if (save_index(&param,sort_keys,(uint) records, &table_sort))
+    if (save_index(&param,sort_keys,(uint) records, &table_sort,
+                   chunks ? chunks->chunk_keys : 0))
       goto err;
   }
   else
@@ -284,6 +883,13 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
       goto err;
     buffpek= (BUFFPEK *) table_sort.buffpek;
     table_sort.buffpek_len= maxbuffer;
+    if (param.packed_addons)
+    {
+      /* The length of the runs doesn't tell the number of rows */
+      records= 0;
+      for (uint i= 0; i < maxbuffer; i++)
+        records+= buffpek[i].count;
+    }
     close_cached_file(&buffpek_pointers);
 	/* Open cached file if it isn't open */
     if (! my_b_inited(outfile) &&
@@ -300,8 +906,14 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
     param.keys=((param.keys*(param.rec_length+sizeof(char*))) /
 		param.rec_length-1);
     maxbuffer--;				// Offset from 0
-    if (merge_many_buff(&param,(uchar*) sort_keys,buffpek,&maxbuffer,
-			&tempfile))
+    if (workers.slots > 1 && param.keys / workers.slots >= MERGEBUFF2)
+    {
+      if (merge_many_buff_parallel(&param, (uchar*) sort_keys, buffpek,
+                                   &maxbuffer, &tempfile, &workers))
+        goto err;
+    }
+    else if (merge_many_buff(&param,(uchar*) sort_keys,buffpek,&maxbuffer,
+			     &tempfile))
       goto err;
     if (flush_io_cache(&tempfile) ||
 	reinit_io_cache(&tempfile,READ_CACHE,0L,0,0))
@@ -315,6 +927,8 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
   error =0;
 
  err:
+  workers.stop();
+  delete_queue(&pq);
   if (param.tmp_buffer)
     x_free(param.tmp_buffer);
   if (!subselect || !subselect->is_uncacheable())
@@ -384,6 +998,7 @@ void filesort_free_buffers(TABLE *table, bool full)
     my_free((char *) table->sort.addon_field, MYF(MY_ALLOW_ZERO_PTR));
     table->sort.addon_buf=0;
     table->sort.addon_field=0;
+    table->sort.packed_addons= FALSE;
   }
 }
 
@@ -492,6 +1107,14 @@ static void dbug_print_record(TABLE *table, bool print_rowid)
 }
 #endif 
 
+/* Compare two sort keys of the priority queue of filesort() */
+
+static int compare_sort_keys(void *sort_length, uchar *a, uchar *b)
+{
+  return memcmp(a, b, *(uint*) sort_length);
+}
+
+
 /**
   Search after sort_keys and write them into tempfile.
   All produced sequences are guaranteed to be non-empty.
@@ -524,7 +1147,8 @@ static void dbug_print_record(TABLE *table, bool print_rowid)
   @endverbatim
 
   @retval
-    Number of records written on success.
+    Number of records written on success. With packed records the
+    caller counts the rows of the runs.
   @retval
     HA_POS_ERROR on error.
 */
@@ -532,11 +1156,13 @@ static void dbug_print_record(TABLE *table, bool print_rowid)
 static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
 			     uchar **sort_keys,
 			     IO_CACHE *buffpek_pointers,
-			     IO_CACHE *tempfile, IO_CACHE *indexfile)
+			     IO_CACHE *tempfile, IO_CACHE *indexfile,
+			     Sort_chunks *chunks, QUEUE *pq)
 {
   int error,flag,quick_select;
-  uint idx,indexpos,ref_length;
+  uint idx,indexpos,ref_length,end_idx;
   uchar *ref_pos,*next_pos,ref_buff[MAX_REFLENGTH];
+  uchar *free_end;
   my_off_t record;
   TABLE *sort_form;
   THD *thd= current_thd;
@@ -550,6 +1176,10 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
                       "every row")));
 
   idx=indexpos=0;
+  end_idx= chunks ? chunks->end() : param->keys;
+  /* Packed records are limited by the free space, not by their number */
+  if ((free_end= param->sort_buffer_end))
+    end_idx= UINT_MAX;
   error=quick_select=0;
   sort_form=param->sort_form;
   file=sort_form->file;
@@ -575,6 +1205,7 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
     if (select->quick->reset())
       DBUG_RETURN(HA_POS_ERROR);
   }
+  DBUG_ASSERT(!chunks || !indexfile);
 
   /* Remember original bitmaps */
   save_read_set=  sort_form->read_set;
@@ -632,6 +1263,8 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
         (void) file->extra(HA_EXTRA_NO_CACHE);
         file->ha_rnd_end();
       }
+      if (chunks)
+        chunks->abort();
       DBUG_RETURN(HA_POS_ERROR);		/* purecov: inspected */
     }
     if (error == 0)
@@ -639,14 +1272,67 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
     if (!error && (!select ||
                    (!select->skip_record(thd, &skip_record) && !skip_record)))
     {
-      if (idx == param->keys)
+      if (pq)
       {
-	if (write_keys(param,sort_keys,idx,buffpek_pointers,tempfile))
-	  DBUG_RETURN(HA_POS_ERROR);
-	idx=0;
-	indexpos++;
+        /*
+          The queue has the smallest keys found so far, with the largest
+          one at the top. sort_keys[idx] is a free key.
+        */
+        uchar *key= sort_keys[idx];
+        make_sortkey(param, key, ref_pos);
+        if (pq->elements < param->max_rows)
+        {
+          queue_insert(pq, key);
+          idx++;
+        }
+        else if (compare_sort_keys(&param->sort_length, key,
+                                   queue_top(pq)) < 0)
+        {
+          sort_keys[idx]= queue_top(pq);
+          queue_top(pq)= key;
+          queue_replaced(pq);
+        }
+      }
+      else
+      {
+        if (idx == end_idx ||
+            (free_end &&
+             (uchar*) (sort_keys + idx + 1) > free_end - param->rec_length))
+        {
+          if (chunks)
+          {
+            /* The sort threads sort the chunk while we fill the next one */
+            if ((idx= chunks->next(param, buffpek_pointers, tempfile)) ==
+                UINT_MAX)
+            {
+              chunks->abort();
+              DBUG_RETURN(HA_POS_ERROR);
+            }
+            end_idx= chunks->end();
+          }
+          else
+          {
+            if (write_keys(param,sort_keys,idx,buffpek_pointers,tempfile))
+              DBUG_RETURN(HA_POS_ERROR);
+            idx=0;
+            indexpos++;
+            free_end= param->sort_buffer_end;
+          }
+        }
+        if (free_end)
+        {
+          /* Make the record before the free end and move it up to it */
+          uchar *key= free_end - param->rec_length;
+          uint length;
+          make_sortkey(param, key, ref_pos);
+          length= sort_record_length(param, key);
+          free_end-= length;
+          memmove(free_end, key, length);
+          sort_keys[idx++]= free_end;
+        }
+        else
+          make_sortkey(param,sort_keys[idx++],ref_pos);
       }
-      make_sortkey(param,sort_keys[idx++],ref_pos);
     }
     else
       file->unlock_row();
@@ -662,7 +1348,11 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
   }
 
   if (thd->is_error())
+  {
+    if (chunks)
+      chunks->abort();
     DBUG_RETURN(HA_POS_ERROR);
+  }
   
   /* Signal we should use orignal column read and write maps */
   sort_form->column_bitmaps_set(save_read_set, save_write_set);
@@ -670,11 +1360,23 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
   DBUG_PRINT("test",("error: %d  indexpos: %d",error,indexpos));
   if (error != HA_ERR_END_OF_FILE)
   {
+    if (chunks)
+      chunks->abort();
     file->print_error(error,MYF(ME_ERROR | ME_WAITTANG)); /* purecov: inspected */
     DBUG_RETURN(HA_POS_ERROR);			/* purecov: inspected */
   }
-  if (indexpos && idx &&
-      write_keys(param,sort_keys,idx,buffpek_pointers,tempfile))
+  if (pq)
+  {
+    /* Hand the keys of the queue to save_index() */
+    memcpy(sort_keys, pq->root + 1, sizeof(uchar*) * pq->elements);
+  }
+  else if (chunks)
+  {
+    if (chunks->finish(param, idx, buffpek_pointers, tempfile))
+      DBUG_RETURN(HA_POS_ERROR);
+  }
+  else if (indexpos && idx &&
+           write_keys(param,sort_keys,idx,buffpek_pointers,tempfile))
     DBUG_RETURN(HA_POS_ERROR);			/* purecov: inspected */
   DBUG_RETURN(my_b_inited(tempfile) ?
 	      (ha_rows) (my_b_tell(tempfile)/param->rec_length) :
@@ -708,18 +1410,32 @@ static int
 write_keys(SORTPARAM *param, register uchar **sort_keys, uint count,
            IO_CACHE *buffpek_pointers, IO_CACHE *tempfile)
 {
-  size_t sort_length, rec_length;
-  uchar **end;
-  BUFFPEK buffpek;
+  size_t sort_length;
   DBUG_ENTER("write_keys");
 
   sort_length= param->sort_length;
-  rec_length= param->rec_length;
 #ifdef MC68000
   quicksort(sort_keys,count,sort_length);
 #else
   my_string_ptr_sort((uchar*) sort_keys, (uint) count, sort_length);
 #endif
+  DBUG_RETURN(write_sorted_keys(param, sort_keys, count, buffpek_pointers,
+                                tempfile));
+} /* write_keys */
+
+
+/**
+  Write sorted keys as a run, see write_keys().
+*/
+
+static int
+write_sorted_keys(SORTPARAM *param, uchar **sort_keys, uint count,
+                  IO_CACHE *buffpek_pointers, IO_CACHE *tempfile)
+{
+  uchar **end;
+  BUFFPEK buffpek;
+  DBUG_ENTER("write_sorted_keys");
+
   if (!my_b_inited(tempfile) &&
       open_cached_file(tempfile, mysql_tmpdir, TEMP_PREFIX, DISK_BUFFER_SIZE,
                        MYF(MY_WME)))
@@ -732,15 +1448,17 @@ write_keys(SORTPARAM *param, register uchar **sort_keys, uint count,
     count=(uint) param->max_rows;               /* purecov: inspected */
   buffpek.count=(ha_rows) count;
   for (end=sort_keys+count ; sort_keys != end ; sort_keys++)
-    if (my_b_write(tempfile, (uchar*) *sort_keys, (uint) rec_length))
+    if (my_b_write(tempfile, (uchar*) *sort_keys,
+                   sort_record_length(param, *sort_keys)))
       goto err;
+  buffpek.end_pos= my_b_tell(tempfile);
   if (my_b_write(buffpek_pointers, (uchar*) &buffpek, sizeof(buffpek)))
     goto err;
   DBUG_RETURN(0);
 
 err:
   DBUG_RETURN(1);
-} /* write_keys */
+} /* write_sorted_keys */
 
 
 /**
@@ -973,8 +1691,9 @@ static void make_sortkey(register SORTPARAM *param,
     /* 
       Save field values appended to sorted fields.
       First null bit indicators are appended then field values follow.
-      In this implementation we use fixed layout for field values -
-      the same for all records.
+      In the fixed layout each field value has its place, the same for
+      all records. In the packed layout the values follow each other
+      and the length of the appended part is stored before the null bits.
     */
     SORT_ADDON_FIELD *addonf= param->addon_field;
     uchar *nulls= to;
@@ -989,10 +1708,15 @@ static void make_sortkey(register SORTPARAM *param,
       }
       else
       {
-        (void) field->pack(to, field->ptr);
+        uchar *end= field->pack(to, field->ptr);
+        if (param->packed_addons)
+          to= end;
       }
-      to+= addonf->length;
+      if (!param->packed_addons)
+        to+= addonf->length;
     }
+    if (param->packed_addons)
+      int2store(nulls, (uint) (to - nulls));
   }
   else
   {
@@ -1045,23 +1769,87 @@ static void register_used_fields(SORTPARAM *param)
 }
 
 
+/* Position in a sorted chunk of the sort buffer, see save_index() */
+
+typedef struct st_sort_chunk_pos
+{
+  uchar *key;
+  uchar **next, **end;
+} SORT_CHUNK_POS;
+
+
+/**
+  Save the sorted result of a sort that fits in memory.
+
+  @param chunk_keys  0 if sort_keys is not sorted. Otherwise a parallel
+                     sort has sorted each chunk of chunk_keys keys, and
+                     the chunks are merged here.
+*/
+
 static bool save_index(SORTPARAM *param, uchar **sort_keys, uint count, 
-                       FILESORT_INFO *table_sort)
+                       FILESORT_INFO *table_sort, uint chunk_keys)
 {
-  uint offset,res_length;
+  uint offset,res_length,rows;
+  size_t length;
   uchar *to;
   DBUG_ENTER("save_index");
 
-  my_string_ptr_sort((uchar*) sort_keys, (uint) count, param->sort_length);
+  if (!chunk_keys)
+    my_string_ptr_sort((uchar*) sort_keys, (uint) count, param->sort_length);
   res_length= param->res_length;
   offset= param->rec_length-res_length;
-  if ((ha_rows) count > param->max_rows)
-    count=(uint) param->max_rows;
+  rows= (uint) min((ha_rows) count, param->max_rows);
+  length= (size_t) res_length * rows;
+  if (param->packed_addons)
+  {
+    /* Merging chunks, the rows that are kept are not known yet */
+    uchar **end= sort_keys + (chunk_keys ? count : rows);
+    length= 0;
+    for (uchar **key= sort_keys; key != end; key++)
+      length+= sort_record_length(param, *key) - offset;
+  }
   if (!(to= table_sort->record_pointers= 
-        (uchar*) my_malloc(res_length*count, MYF(MY_WME))))
+        (uchar*) my_malloc(length, MYF(MY_WME))))
     DBUG_RETURN(1);                 /* purecov: inspected */
-  for (uchar **end= sort_keys+count ; sort_keys != end ; sort_keys++)
+  if (chunk_keys && chunk_keys < count)
   {
+    SORT_CHUNK_POS chunk[MAX_SORT_THREADS], *pos;
+    QUEUE queue;
+    size_t sort_length= param->sort_length;
+    uint chunks= (count + chunk_keys - 1) / chunk_keys;
+
+    if (init_queue(&queue, chunks, offsetof(SORT_CHUNK_POS, key), 0,
+                   (queue_compare) get_ptr_compare(sort_length),
+                   (void*) &sort_length))
+      DBUG_RETURN(1);
+    for (uint i= 0; i < chunks; i++)
+    {
+      pos= chunk + i;
+      pos->next= sort_keys + i * chunk_keys;
+      pos->end= sort_keys + min(count, (i + 1) * chunk_keys);
+      pos->key= *pos->next++;
+      queue_insert(&queue, (uchar*) pos);
+    }
+    while (rows--)
+    {
+      pos= (SORT_CHUNK_POS*) queue_top(&queue);
+      res_length= sort_record_length(param, pos->key) - offset;
+      memcpy(to, pos->key+offset, res_length);
+      to+= res_length;
+      if (pos->next == pos->end)
+        VOID(queue_remove(&queue, 0));
+      else
+      {
+        pos->key= *pos->next++;
+        queue_replaced(&queue);
+      }
+    }
+    delete_queue(&queue);
+    DBUG_RETURN(0);
+  }
+  for (uchar **end= sort_keys+rows ; sort_keys != end ; sort_keys++)
+  {
+    res_length= sort_record_length(param, *sort_keys) - offset;
     memcpy(to, *sort_keys+offset, res_length);
     to+= res_length;
   }
@@ -1149,6 +1937,57 @@ uint read_to_buffer(IO_CACHE *fromfile, BUFFPEK *buffpek,
 } /* read_to_buffer */
 
 
+/**
+  Read packed records to buffer, like read_to_buffer().
+
+  As many complete records as there are in the first
+  max_keys * rec_length bytes of the rest of the sequence are read.
+
+  @retval
+    Number of bytes read, 0 at the end of the sequence
+  @retval
+    (uint)-1 if something goes wrong
+*/
+
+static uint read_packed_to_buffer(SORTPARAM *param, IO_CACHE *fromfile,
+                                  BUFFPEK *buffpek)
+{
+  uint length, count;
+  uchar *pos, *end;
+
+  if (!buffpek->count)
+    return 0;
+  length= (uint) min((my_off_t) buffpek->max_keys * param->rec_length,
+                     buffpek->end_pos - buffpek->file_pos);
+  if (my_pread(fromfile->file, (uchar*) buffpek->base, length,
+               buffpek->file_pos, MYF_RW))
+    return((uint) -1);				/* purecov: inspected */
+  end= buffpek->base + length;
+  for (pos= buffpek->base, count= 0; count < buffpek->count; count++)
+  {
+    if (pos + param->sort_length + 2 > end ||
+        pos + sort_record_length(param, pos) > end)
+      break;
+    pos+= sort_record_length(param, pos);
+  }
+  DBUG_ASSERT(count);
+  buffpek->key= buffpek->base;
+  buffpek->file_pos+= (uint) (pos - buffpek->base);
+  buffpek->count-= count;
+  buffpek->mem_count= count;
+  return length;
+} /* read_packed_to_buffer */
+
+
+static inline uint read_merge_buffer(SORTPARAM *param, IO_CACHE *fromfile,
+                                     BUFFPEK *buffpek)
+{
+  return (param->packed_addons ?
+          read_packed_to_buffer(param, fromfile, buffpek) :
+          read_to_buffer(fromfile, buffpek, param->rec_length));
+}
+
+
 /**
   Put all room used by freed buffer to use in adjacent buffer.
 
@@ -1206,7 +2045,7 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
                   int flag)
 {
   int error;
-  uint rec_length,res_length,offset;
+  uint rec_length,res_length,offset,length;
   size_t sort_length;
   ulong maxcount;
   ha_rows max_rows,org_max_rows;
@@ -1220,7 +2059,9 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
   THD::killed_state not_killable;
   DBUG_ENTER("merge_buffers");
 
-  status_var_increment(current_thd->status_var.filesort_merge_passes);
+  /* Groups of a parallel sort are merged by several threads */
+  statistic_increment(current_thd->status_var.filesort_merge_passes,
+                      &LOCK_status);
   if (param->not_killable)
   {
     killed= &not_killable;
@@ -1257,11 +2098,16 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
   {
     buffpek->base= strpos;
     buffpek->max_keys= maxcount;
-    strpos+= (uint) (error= (int) read_to_buffer(from_file, buffpek,
-                                                                         rec_length));
-    if (error == -1)
+    if ((error= (int) read_merge_buffer(param, from_file, buffpek)) == -1)
       goto err;					/* purecov: inspected */
-    buffpek->max_keys= buffpek->mem_count;	// If less data in buffers than expected
+    if (param->packed_addons)
+    {
+      /* The records may use the whole part of the buffer that was read */
+      buffpek->max_keys= ((uint) error + rec_length - 1) / rec_length;
+    }
+    else
+      buffpek->max_keys= buffpek->mem_count;	// If less data in buffers than expected
+    strpos+= buffpek->max_keys * rec_length;
     queue_insert(&queue, (uchar*) buffpek);
   }
 
@@ -1302,6 +2148,7 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
     for (;;)
     {
       buffpek= (BUFFPEK*) queue_top(&queue);
+      length= sort_record_length(param, buffpek->key);
       if (cmp)                                        // Remove duplicates
       {
         if (!(*cmp)(first_cmp_arg, &(param->unique_buff),
@@ -1311,14 +2158,15 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
       }
       if (flag == 0)
       {
-        if (my_b_write(to_file,(uchar*) buffpek->key, rec_length))
+        if (my_b_write(to_file,(uchar*) buffpek->key, length))
         {
           error=1; goto err;                        /* purecov: inspected */
         }
       }
       else
       {
-        if (my_b_write(to_file, (uchar*) buffpek->key+offset, res_length))
+        if (my_b_write(to_file, (uchar*) buffpek->key+offset,
+                       length-offset))
         {
           error=1; goto err;                        /* purecov: inspected */
         }
@@ -1330,11 +2178,10 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
       }
 
     skip_duplicate:
-      buffpek->key+= rec_length;
+      buffpek->key+= length;
       if (! --buffpek->mem_count)
       {
-        if (!(error= (int) read_to_buffer(from_file,buffpek,
-                                          rec_length)))
+        if (!(error= (int) read_merge_buffer(param, from_file, buffpek)))
         {
           VOID(queue_remove(&queue,0));
           reuse_freed_buff(&queue, buffpek, rec_length);
@@ -1371,7 +2218,7 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
       buffpek->count= 0;                        /* Don't read more */
     }
     max_rows-= buffpek->mem_count;
-    if (flag == 0)
+    if (flag == 0 && !param->packed_addons)
     {
       if (my_b_write(to_file,(uchar*) buffpek->key,
                      (rec_length*buffpek->mem_count)))
@@ -1381,25 +2228,25 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
     }
     else
     {
-      register uchar *end;
-      strpos= buffpek->key+offset;
-      for (end= strpos+buffpek->mem_count*rec_length ;
-           strpos != end ;
-           strpos+= rec_length)
+      uint skip= flag ? offset : 0;
+      strpos= buffpek->key;
+      for (ulong count= buffpek->mem_count ; count-- ; strpos+= length)
       {     
-        if (my_b_write(to_file, (uchar *) strpos, res_length))
+        length= sort_record_length(param, strpos);
+        if (my_b_write(to_file, (uchar *) strpos+skip, length-skip))
         {
           error=1; goto err;                        
         }
       }
     }
   }
-  while ((error=(int) read_to_buffer(from_file,buffpek, rec_length))
+  while ((error=(int) read_merge_buffer(param, from_file, buffpek))
          != -1 && error != 0);
 
 end:
   lastbuff->count= min(org_max_rows-max_rows, param->max_rows);
   lastbuff->file_pos= to_start_filepos;
+  lastbuff->end_pos= my_b_tell(to_file);
 err:
   delete_queue(&queue);
   DBUG_RETURN(error);
@@ -1550,6 +2397,7 @@ sortlength(THD *thd, SORT_FIELD *sortorder, uint s_length,
   @param ptabfield           Array of references to the table fields
   @param sortlength          Total length of sorted fields
   @param[out] plength        Total length of appended fields
+  @param[out] ppacked        Set if the fields are packed, see make_sortkey()
 
   @note
     The null bits for the appended values are supposed to be put together
@@ -1562,7 +2410,8 @@ sortlength(THD *thd, SORT_FIELD *sortorder, uint s_length,
 */
 
 static SORT_ADDON_FIELD *
-get_addon_fields(THD *thd, Field **ptabfield, uint sortlength, uint *plength)
+get_addon_fields(THD *thd, Field **ptabfield, uint sortlength, uint *plength,
+                 bool *ppacked)
 {
   Field **pfield;
   Field *field;
@@ -1570,6 +2419,7 @@ get_addon_fields(THD *thd, Field **ptabfield, uint sortlength, uint *plength)
   uint length= 0;
   uint fields= 0;
   uint null_fields= 0;
+  bool packed= FALSE;
   MY_BITMAP *read_set= (*ptabfield)->table->read_set;
 
   /*
@@ -1592,11 +2442,17 @@ get_addon_fields(THD *thd, Field **ptabfield, uint sortlength, uint *plength)
     length+= field->max_packed_col_length(field->pack_length());
     if (field->maybe_null())
       null_fields++;
+    /* Strings are packed to their used length */
+    if (field->real_type() == MYSQL_TYPE_VARCHAR ||
+        field->real_type() == MYSQL_TYPE_STRING)
+      packed= TRUE;
     fields++;
   } 
   if (!fields)
     return 0;
   length+= (null_fields+7)/8;
+  if (packed)
+    length+= 2;                                 // Length of packed fields
 
   if (length+sortlength > thd->variables.max_length_for_sort_data ||
       !(addonf= (SORT_ADDON_FIELD *) my_malloc(sizeof(SORT_ADDON_FIELD)*
@@ -1604,8 +2460,11 @@ get_addon_fields(THD *thd, Field **ptabfield, uint sortlength, uint *plength)
     return 0;
 
   *plength= length;
+  *ppacked= packed;
   length= (null_fields+7)/8;
   null_fields= 0;
+  if (packed)
+    length+= 2;
   for (pfield= ptabfield; (field= *pfield) ; pfield++)
   {
     if (!bitmap_is_set(read_set, field->field_index))
@@ -1614,7 +2473,7 @@ get_addon_fields(THD *thd, Field **ptabfield, uint sortlength, uint *plength)
     addonf->offset= length;
     if (field->maybe_null())
     {
-      addonf->null_offset= null_fields/8;
+      addonf->null_offset= null_fields/8 + (packed ? 2 : 0);
       addonf->null_bit= 1<<(null_fields & 7);
       null_fields++;
     }
@@ -1667,6 +2526,32 @@ unpack_addon_fields(struct st_sort_addon_field *addon_field, uchar *buff)
   }
 }
 
+
+/**
+  Unpack values appended to sorted fields in the packed layout,
+  like unpack_addon_fields().
+*/
+
+static void
+unpack_packed_addon_fields(struct st_sort_addon_field *addon_field,
+                           uchar *buff)
+{
+  Field *field;
+  SORT_ADDON_FIELD *addonf= addon_field;
+  const uchar *pos= buff + addonf->offset;
+
+  for ( ; (field= addonf->field) ; addonf++)
+  {
+    if (addonf->null_bit && (addonf->null_bit & buff[addonf->null_offset]))
+    {
+      field->set_null();
+      continue;
+    }
+    field->set_notnull();
+    pos= field->unpack(field->ptr, pos);
+  }
+}
+
 /*
 ** functions to change a double or float to a sortable string
 ** The following should work for IEEE
@@ -673,7 +673,7 @@ bool Item_in_subselect::test_limit(st_select_lex_unit *unit_arg)
 
 Item_in_subselect::Item_in_subselect(Item * left_exp,
 				     st_select_lex *select_lex):
-  Item_exists_subselect(), optimizer(0), transformed(0),
+  Item_exists_subselect(), optimizer(0), transformed(0), materialized(0),
   pushed_cond_guards(NULL), upper_item(0)
 {
   DBUG_ENTER("Item_in_subselect::Item_in_subselect");
@@ -1076,6 +1076,16 @@ Item_in_subselect::single_value_transformer(JOIN *join,
     }
     thd->lex->current_select= current;
 
+    if (func == &eq_creator && is_semijoin_candidate(join))
+    {
+      /* JOIN::prepare of the outer select merges the subquery into it */
+      select_lex->outer_select()->sj_subselect= this;
+      DBUG_RETURN(RES_OK);
+    }
+
+    if (can_materialize(join, func))
+      DBUG_RETURN(setup_materialization(join) ? RES_ERROR : RES_OK);
+
     /*
       As far as  Item_ref_in_optimizer do not substitute itself on fix_fields
       we can use same item for all selects.
@@ -1269,6 +1279,179 @@ Item_in_subselect::single_value_transformer(JOIN *join,
 }
 
 
+/**
+  Check if an IN subquery should be materialized instead of being rewritten
+  to a correlated EXISTS subquery.
+
+  The subquery must be a single uncorrelated SELECT that is deterministic,
+  and its value must compare with the left expression either as integers
+  or as non-temporal strings of the same collation, so that a lookup of
+  the left value in a unique index over the subquery values finds every
+  equal value.
+
+  Materialization runs the subquery once, while the EXISTS rewrite runs it
+  once per outer row. The rewrite is only cheaper when the subquery becomes
+  a single lookup in an index of its table (see
+  subselect_uniquesubquery_engine and subselect_indexsubquery_engine),
+  which it keeps here.
+
+  @param join    JOIN of the subquery
+  @param func    creator of the comparison
+
+  @retval TRUE   materialize the subquery
+  @retval FALSE  rewrite it to EXISTS
+*/
+
+bool Item_in_subselect::can_materialize(JOIN *join, Comp_creator *func)
+{
+  SELECT_LEX *select_lex= join->select_lex;
+  Item *inner;
+  DBUG_ENTER("Item_in_subselect::can_materialize");
+
+  if (func != &eq_creator || substype() != IN_SUBS ||
+      !optimizer_flag(thd, OPTIMIZER_SWITCH_MATERIALIZATION) ||
+      select_lex->master_unit()->is_union() ||
+      !select_lex->table_list.elements ||
+      is_correlated || select_lex->uncacheable ||
+      select_lex->master_unit()->uncacheable ||
+      select_lex->item_list.elements != 1)
+    DBUG_RETURN(FALSE);
+
+  inner= select_lex->item_list.head();
+  if (left_expr->result_type() != inner->result_type())
+    DBUG_RETURN(FALSE);
+  switch (inner->result_type()) {
+  case INT_RESULT:
+    if (left_expr->field_type() == MYSQL_TYPE_BIT ||
+        inner->field_type() == MYSQL_TYPE_BIT)
+      DBUG_RETURN(FALSE);
+    break;
+  case STRING_RESULT:
+    if (left_expr->is_datetime() || inner->is_datetime() ||
+        left_expr->collation.collation != inner->collation.collation)
+      DBUG_RETURN(FALSE);
+    break;
+  default:
+    DBUG_RETURN(FALSE);
+  }
+
+  /* Keep the index lookup the EXISTS rewrite would do */
+  if (select_lex->table_list.elements == 1 && !join->having &&
+      !select_lex->with_sum_func && !select_lex->group_list.elements &&
+      inner->real_item()->type() == Item::FIELD_ITEM &&
+      !((Item_field*) inner->real_item())->field->key_start.is_clear_all())
+    DBUG_RETURN(FALSE);
+  DBUG_RETURN(TRUE);
+}
+
+
+/**
+  Check if the subquery can be merged into the outer select as a
+  semi-join, i.e. if the IN predicate can be replaced by the subquery
+  tables, the WHERE clause of the subquery and an equality of the left
+  expression with the selected value, as long as the outer join keeps
+  one row for every outer row combination with matches.
+
+  This is the case for a single, uncorrelated or correlated, IN subquery
+  that is a conjunct of the WHERE clause of a SELECT statement, when the
+  subquery is a plain join of base tables without grouping or LIMIT and
+  the outer select is a plain join of base tables as well. Prepared
+  statements and stored programs keep the EXISTS rewrite, as the
+  conversion is not reverted for the next execution.
+
+  @param join    JOIN of the subquery
+
+  @retval TRUE   merge the subquery into the outer select
+  @retval FALSE  rewrite or materialize it
+*/
+
+bool Item_in_subselect::is_semijoin_candidate(JOIN *join)
+{
+  SELECT_LEX *select_lex= join->select_lex;
+  SELECT_LEX *outer= select_lex->outer_select();
+  SELECT_LEX_UNIT *master_unit= select_lex->master_unit();
+  TABLE_LIST *tl;
+  DBUG_ENTER("Item_in_subselect::is_semijoin_candidate");
+
+  if (!optimizer_flag(thd, OPTIMIZER_SWITCH_SEMIJOIN) ||
+      substype() != IN_SUBS || parsing_place != IN_WHERE ||
+      !thd->stmt_arena->is_conventional() ||
+      thd->lex->sql_command != SQLCOM_SELECT ||
+      master_unit->is_union() ||
+      select_lex->first_inner_unit() ||
+      ((select_lex->uncacheable | master_unit->uncacheable) &
+       ~(UNCACHEABLE_DEPENDENT | UNCACHEABLE_EXPLAIN)) ||
+      !select_lex->leaf_tables || join->having || select_lex->having ||
+      select_lex->with_sum_func || select_lex->group_list.elements ||
+      select_lex->explicit_limit || select_lex->ftfunc_list->elements ||
+      select_lex->item_list.elements != 1 ||
+      select_lex->item_list.head()->with_sum_func)
+    DBUG_RETURN(FALSE);
+
+  /* One semi-join per select, in a plain join of base tables */
+  if (!outer || !outer->join || outer->sj_subselect ||
+      !outer->leaf_tables || outer->with_sum_func ||
+      outer->join->tables + join->tables > MAX_TABLES)
+    DBUG_RETURN(FALSE);
+  for (tl= select_lex->leaf_tables; tl; tl= tl->next_leaf)
+  {
+    if (!tl->table || tl->view || tl->derived || tl->schema_table ||
+        tl->nested_join || tl->on_expr || tl->outer_join)
+      DBUG_RETURN(FALSE);
+  }
+  for (tl= outer->leaf_tables; tl; tl= tl->next_leaf)
+  {
+    if (!tl->table || tl->view || tl->derived || tl->schema_table ||
+        tl->nested_join || tl->on_expr || tl->outer_join || tl->embedding)
+      DBUG_RETURN(FALSE);
+  }
+  if (select_lex->top_join_list.elements != join->tables ||
+      outer->top_join_list.elements != outer->join->tables)
+    DBUG_RETURN(FALSE);
+
+  /* The predicate must be the WHERE clause or one of its conjuncts */
+  if (outer->where != this)
+  {
+    Item *item;
+    if (!outer->where || outer->where->type() != Item::COND_ITEM ||
+        ((Item_cond*) outer->where)->functype() != Item_func::COND_AND_FUNC)
+      DBUG_RETURN(FALSE);
+    List_iterator_fast<Item> li(*((Item_cond*) outer->where)->argument_list());
+    while ((item= li++) && item != this) ;
+    if (!item)
+      DBUG_RETURN(FALSE);
+  }
+  DBUG_RETURN(TRUE);
+}
+
+
+/**
+  Make the subquery fill a temporary table instead of being run per outer
+  row: its rows are sent to a select_materialize_subselect, and the
+  subquery engine is replaced by a subselect_materialize_engine that
+  probes the table.
+
+  @retval FALSE  OK
+  @retval TRUE   error
+*/
+
+bool Item_in_subselect::setup_materialization(JOIN *join)
+{
+  select_materialize_subselect *materialize_result;
+  subselect_single_select_engine *select_engine=
+    (subselect_single_select_engine*) engine;
+  DBUG_ENTER("Item_in_subselect::setup_materialization");
+
+  if (!(materialize_result= new select_materialize_subselect(this)) ||
+      select_engine->change_result(this, materialize_result) ||
+      !(engine= new subselect_materialize_engine(thd, select_engine, this,
+                                                 materialize_result)))
+    DBUG_RETURN(TRUE);
+  materialized= TRUE;
+  DBUG_RETURN(FALSE);
+}
+
+
 Item_subselect::trans_res
 Item_in_subselect::row_value_transformer(JOIN *join)
 {
@@ -1625,7 +1808,7 @@ err:
 
 void Item_in_subselect::print(String *str, enum_query_type query_type)
 {
-  if (transformed)
+  if (transformed && !materialized)
     str->append(STRING_WITH_LEN("<exists>"));
   else
   {
@@ -1636,6 +1819,20 @@ void Item_in_subselect::print(String *str, enum_query_type query_type)
 }
 
 
+void Item_in_subselect::fix_length_and_dec()
+{
+  if (!materialized)
+  {
+    Item_exists_subselect::fix_length_and_dec();
+    return;
+  }
+  /* All rows of the subquery are needed, unlike for EXISTS */
+  decimals= 0;
+  max_length= 1;
+  max_columns= engine->cols();
+}
+
+
 bool Item_in_subselect::fix_fields(THD *thd_arg, Item **ref)
 {
   bool result = 0;
@@ -2655,3 +2852,320 @@ bool subselect_uniquesubquery_engine::no_tables()
   /* returning value is correct, but this method should never be called */
   return 0;
 }
+
+
+/**
+  Create the temporary table of a materialized IN subquery.
+
+  The table has a unique index on its column, so that it holds every value
+  once and can be probed with an index lookup.
+*/
+
+bool select_materialize_subselect::create_result_table(THD *thd_arg,
+                                                       List<Item> *column_types)
+{
+  DBUG_ENTER("select_materialize_subselect::create_result_table");
+  DBUG_ASSERT(table == 0);
+  tmp_table_param.init();
+  tmp_table_param.field_count= column_types->elements;
+  if (!(table= create_tmp_table(thd_arg, &tmp_table_param, *column_types,
+                                (ORDER*) 0, TRUE, 1,
+                                thd_arg->options | TMP_TABLE_ALL_COLUMNS,
+                                HA_POS_ERROR, (char*) "materialized subselect")))
+    DBUG_RETURN(TRUE);
+  table->file->extra(HA_EXTRA_WRITE_CACHE);
+  table->file->extra(HA_EXTRA_IGNORE_DUP_KEY);
+  DBUG_RETURN(FALSE);
+}
+
+
+bool select_materialize_subselect::send_data(List<Item> &items)
+{
+  int error;
+  DBUG_ENTER("select_materialize_subselect::send_data");
+  has_rows= TRUE;
+  fill_record(thd, table->field, items, 1);
+  if (thd->is_error())
+    DBUG_RETURN(1);
+  /* NULL equals nothing, we only need to know there was one */
+  if (table->field[0]->is_null())
+  {
+    has_null= TRUE;
+    DBUG_RETURN(0);
+  }
+  if ((error= table->file->ha_write_row(table->record[0])))
+  {
+    /* create_myisam_from_heap will generate error if needed */
+    if (table->file->is_fatal_error(error, HA_CHECK_DUP) &&
+        create_myisam_from_heap(thd, table, &tmp_table_param, error, 1))
+      DBUG_RETURN(1);
+  }
+  DBUG_RETURN(0);
+}
+
+
+void select_materialize_subselect::cleanup()
+{
+  if (table)
+  {
+    free_tmp_table(thd, table);
+    table= 0;
+  }
+  tmp_table_param.cleanup();
+  has_rows= has_null= FALSE;
+}
+
+subselect_materialize_engine::
+subselect_materialize_engine(THD *thd_arg,
+                             subselect_single_select_engine *engine_arg,
+                             Item_subselect *subs,
+                             select_materialize_subselect *result_arg)
+  :subselect_engine(subs, result_arg), materialize_engine(engine_arg),
+   materialize_result(result_arg), key_buff(0), key_length(0),
+   is_materialized(0)
+{
+  set_thd(thd_arg);
+}
+
+
+subselect_materialize_engine::~subselect_materialize_engine()
+{
+  delete materialize_engine;
+}
+
+
+void subselect_materialize_engine::cleanup()
+{
+  DBUG_ENTER("subselect_materialize_engine::cleanup");
+  is_materialized= FALSE;
+  key_buff= 0;
+  /* This frees the temporary table */
+  materialize_engine->cleanup();
+  DBUG_VOID_RETURN;
+}
+
+
+int subselect_materialize_engine::prepare()
+{
+  materialize_engine->set_thd(thd);
+  return materialize_engine->prepare();
+}
+
+
+void subselect_materialize_engine::fix_length_and_dec(Item_cache **row)
+{
+  materialize_engine->fix_length_and_dec(row);
+}
+
+
+/**
+  Describe the distinct key of the temporary table the way the handler
+  stores it: the key parts of a DISTINCT table do not have the NULL flag
+  and the length bytes that the handler adds to the key of a nullable or
+  VARCHAR column.
+
+  @retval FALSE  OK
+  @retval TRUE   out of memory
+*/
+
+bool subselect_materialize_engine::init_lookup_key(TABLE *table)
+{
+  KEY_PART_INFO *key_part, *key_part_end;
+  lookup_key= *table->key_info;
+  if (!(lookup_key.key_part= (KEY_PART_INFO*)
+        thd->memdup(table->key_info->key_part,
+                    lookup_key.key_parts * sizeof(KEY_PART_INFO))))
+    return TRUE;
+  key_length= 0;
+  key_part_end= lookup_key.key_part + lookup_key.key_parts;
+  for (key_part= lookup_key.key_part; key_part < key_part_end; key_part++)
+  {
+    Field *field= key_part->field;
+    key_part->store_length= key_part->length;
+    if (field->real_maybe_null())
+    {
+      key_part->null_bit= field->null_bit;
+      key_part->null_offset= (uint) (field->null_ptr - table->record[0]);
+      key_part->store_length+= HA_KEY_NULL_LENGTH;
+    }
+    if (field->real_type() == MYSQL_TYPE_VARCHAR)
+    {
+      key_part->key_part_flag|= HA_VAR_LENGTH_PART;
+      key_part->length= field->key_length();
+      key_part->store_length= (key_part->store_length - field->pack_length() +
+                               key_part->length + HA_KEY_BLOB_LENGTH);
+    }
+    key_length+= key_part->store_length;
+  }
+  lookup_key.key_length= key_length;
+  return !(key_buff= (uchar*) thd->alloc(key_length));
+}
+
+
+/**
+  Check that a value found in the temporary table is equal to the left
+  expression: the lookup key is the left value converted to the type of
+  the column, which may have cut it.
+*/
+
+bool subselect_materialize_engine::matches(Item *left, Field *field)
+{
+  if (left->result_type() == INT_RESULT)
+  {
+    longlong left_value= left->val_int(), value= field->val_int();
+    bool is_unsigned= test(field->flags & UNSIGNED_FLAG);
+    return (left_value == value &&
+            (left->unsigned_flag == is_unsigned || left_value >= 0));
+  }
+  char buff[MAX_FIELD_WIDTH], left_buff[MAX_FIELD_WIDTH];
+  String tmp(buff, sizeof(buff), field->charset());
+  String left_tmp(left_buff, sizeof(left_buff), left->collation.collation);
+  String *str= field->val_str(&tmp), *left_str= left->val_str(&left_tmp);
+  return !sortcmp(left_str, str, left->collation.collation);
+}
+
+
+/**
+  Materialize the subquery on first use, then find the current value of
+  the left expression in the temporary table.
+
+  @retval 0  OK
+  @retval 1  error
+*/
+
+int subselect_materialize_engine::exec()
+{
+  Item_in_subselect *item_in= (Item_in_subselect *) item;
+  Item_cache *left= *item_in->optimizer->get_cache();
+  TABLE *table;
+  Field *field;
+  int error;
+  DBUG_ENTER("subselect_materialize_engine::exec");
+
+  if (!is_materialized)
+  {
+    SELECT_LEX *select_lex= item->get_select_lex();
+    if (!materialize_result->table &&
+        materialize_result->create_result_table(thd,
+                                                &select_lex->item_list))
+      DBUG_RETURN(1);
+    is_materialized= TRUE;
+    if (materialize_engine->exec() || thd->is_error())
+      DBUG_RETURN(1);
+    table= materialize_result->table;
+    if ((error= table->file->extra(HA_EXTRA_NO_CACHE)))
+    {
+      table->file->print_error(error, MYF(0));
+      DBUG_RETURN(1);
+    }
+    /* A unique constraint over blobs is a hash, not an index to read */
+    if (table->s->keys && !table->s->uniques)
+    {
+      if (init_lookup_key(table))
+        DBUG_RETURN(1);
+      table->file->ha_index_init(0, 0);
+    }
+    DBUG_PRINT("info", ("rows: %lu  null: %d  index: %d",
+                        (ulong) table->file->stats.records,
+                        materialize_result->has_null, test(key_buff)));
+  }
+
+  item_in->value= 0;
+  /* NULL IN (SELECT ...) is resolved by Item_in_optimizer from no_rows() */
+  if (!materialize_result->has_rows || left->null_value)
+    DBUG_RETURN(0);
+
+  table= materialize_result->table;
+  field= table->field[0];
+  if (key_buff)
+  {
+    enum_check_fields save_count_cuted_fields= thd->count_cuted_fields;
+    thd->count_cuted_fields= CHECK_FIELD_IGNORE;
+    left->save_in_field(field, TRUE);
+    thd->count_cuted_fields= save_count_cuted_fields;
+    key_copy(key_buff, table->record[0], &lookup_key, key_length);
+    error= table->file->index_read_map(table->record[0], key_buff,
+                                       HA_WHOLE_KEY, HA_READ_KEY_EXACT);
+    if (!error)
+      item_in->value= matches(left, field);
+    else if (error != HA_ERR_KEY_NOT_FOUND && error != HA_ERR_END_OF_FILE)
+      DBUG_RETURN(report_error(table, error));
+  }
+  else
+  {
+    table->file->ha_rnd_init(1);
+    while (!(error= table->file->rnd_next(table->record[0])))
+    {
+      if (matches(left, field))
+      {
+        item_in->value= 1;
+        break;
+      }
+    }
+    table->file->ha_rnd_end();
+    if (error && error != HA_ERR_END_OF_FILE && error != HA_ERR_RECORD_DELETED)
+      DBUG_RETURN(report_error(table, error));
+  }
+  if (!item_in->value && materialize_result->has_null)
+    item_in->was_null= TRUE;
+  DBUG_RETURN(0);
+}
+
+
+uint subselect_materialize_engine::cols()
+{
+  return materialize_engine->cols();
+}
+
+
+uint8 subselect_materialize_engine::uncacheable()
+{
+  return materialize_engine->uncacheable();
+}
+
+
+void subselect_materialize_engine::exclude()
+{
+  materialize_engine->exclude();
+}
+
+
+table_map subselect_materialize_engine::upper_select_const_tables()
+{
+  return materialize_engine->upper_select_const_tables();
+}
+
+
+void subselect_materialize_engine::print(String *str,
+                                         enum_query_type query_type)
+{
+  str->append(STRING_WITH_LEN("<materialize>("));
+  materialize_engine->print(str, query_type);
+  str->append(')');
+}
+
+
+bool subselect_materialize_engine::change_result(Item_subselect *si,
+                                                 select_subselect *res)
+{
+  DBUG_ASSERT(0);
+  return TRUE;
+}
+
+
+bool subselect_materialize_engine::no_tables()
+{
+  return materialize_engine->no_tables();
+}
+
+
+bool subselect_materialize_engine::may_be_null()
+{
+  return materialize_engine->may_be_null();
+}
+
+
+bool subselect_materialize_engine::no_rows()
+{
+  return !materialize_result->has_rows;
+}
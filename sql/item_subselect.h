@@ -25,6 +25,7 @@ class st_select_lex;
 class st_select_lex_unit;
 class JOIN;
 class select_subselect;
+class select_materialize_subselect;
 class subselect_engine;
 class Item_bool_func2;
 
@@ -242,6 +243,7 @@ public:
   friend class select_exists_subselect;
   friend class subselect_uniquesubquery_engine;
   friend class subselect_indexsubquery_engine;
+  friend class subselect_materialize_engine;
 };
 
 
@@ -272,6 +274,8 @@ protected:
   bool was_null;
   bool abort_on_null;
   bool transformed;
+  /* the subquery is materialized instead of being rewritten to EXISTS */
+  bool materialized;
 public:
   /* Used to trigger on/off conditions that were pushed down to subselect */
   bool *pushed_cond_guards;
@@ -292,7 +296,7 @@ public:
   Item_in_subselect(Item * left_expr, st_select_lex *select_lex);
   Item_in_subselect()
     :Item_exists_subselect(), optimizer(0), abort_on_null(0), transformed(0),
-     pushed_cond_guards(NULL), upper_item(0)
+     materialized(0), pushed_cond_guards(NULL), upper_item(0)
   {}
 
   subs_type substype() { return IN_SUBS; }
@@ -306,6 +310,11 @@ public:
   trans_res select_in_like_transformer(JOIN *join, Comp_creator *func);
   trans_res single_value_transformer(JOIN *join, Comp_creator *func);
   trans_res row_value_transformer(JOIN * join);
+  bool can_materialize(JOIN *join, Comp_creator *func);
+  bool setup_materialization(JOIN *join);
+  bool is_semijoin_candidate(JOIN *join);
+  Item_in_optimizer *get_optimizer() { return optimizer; }
+  void fix_length_and_dec();
   longlong val_int();
   double val_real();
   String *val_str(String*);
@@ -321,6 +330,7 @@ public:
   friend class Item_ref_null_helper;
   friend class Item_is_not_null_test;
   friend class subselect_indexsubquery_engine;
+  friend class subselect_materialize_engine;
 };
 
 
@@ -573,6 +583,53 @@ public:
 };
 
 
+/*
+  A subquery execution engine that evaluates an uncorrelated subquery
+
+    outer_expr IN (SELECT expr FROM ...)
+
+  once into a temporary table with a unique index on expr, and then does
+  one lookup in that table for each value of outer_expr. The subquery
+  itself is run by the single select engine it replaced.
+*/
+
+class subselect_materialize_engine: public subselect_engine
+{
+  /* engine that runs the subquery into materialize_result */
+  subselect_single_select_engine *materialize_engine;
+  select_materialize_subselect *materialize_result;
+  /* the distinct key of the table in the format of the handler */
+  KEY lookup_key;
+  uchar *key_buff;
+  uint key_length;
+  bool is_materialized;
+public:
+
+  subselect_materialize_engine(THD *thd_arg,
+                               subselect_single_select_engine *engine_arg,
+                               Item_subselect *subs,
+                               select_materialize_subselect *result_arg);
+  ~subselect_materialize_engine();
+  void cleanup();
+  int prepare();
+  void fix_length_and_dec(Item_cache** row);
+  int exec();
+  uint cols();
+  uint8 uncacheable();
+  void exclude();
+  table_map upper_select_const_tables();
+  virtual void print (String *str, enum_query_type query_type);
+  bool change_result(Item_subselect *si, select_subselect *result);
+  bool no_tables();
+  bool may_be_null();
+  bool is_executed() const { return is_materialized; }
+  bool no_rows();
+private:
+  bool init_lookup_key(TABLE *table);
+  bool matches(Item *left, Field *field);
+};
+
+
 inline bool Item_subselect::is_evaluated() const
 {
   return engine->is_executed();
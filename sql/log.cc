@@ -7315,13 +7315,23 @@ ulonglong mysql_bin_log_file_pos(void)
   return (ulonglong) mysql_bin_log.get_log_file()->pos_in_file;
 }
 
+/*
+  Relay log info of the calling thread: that of the slave worker when
+  called by one, see rpl_parallel.h, otherwise that of the SQL thread.
+*/
+static Relay_log_info *active_rli()
+{
+  THD *thd= current_thd;
+  return (thd && thd->rli_slave) ? thd->rli_slave : &active_mi->rli;
+}
+
 /** Get the file name of the MySQL relaylog from active_mi
  * @return the name of the relaylog file from active_mi
 */
 extern "C"
 const char* active_relay_log_file_name(void)
 {
-  return active_mi->rli.event_relay_log_name;
+  return active_rli()->event_relay_log_name;
 }
 
 /**
@@ -7331,7 +7341,7 @@ const char* active_relay_log_file_name(void)
 extern "C"
 ulonglong active_relay_log_file_pos(void)
 {
-  return (ulonglong) active_mi->rli.future_event_relay_log_pos;
+  return (ulonglong) active_rli()->future_event_relay_log_pos;
 }
 
 /** Get the file name of the MySQL binlog from active_mi
@@ -7340,7 +7350,7 @@ ulonglong active_relay_log_file_pos(void)
 extern "C"
 const char* active_bin_log_file_name(void)
 {
-  return active_mi->rli.group_master_log_name;
+  return active_rli()->group_master_log_name;
 }
 
 /**
@@ -7350,7 +7360,7 @@ const char* active_bin_log_file_name(void)
 extern "C"
 ulonglong active_bin_log_file_pos(void)
 {
-  return (ulonglong) active_mi->rli.future_group_master_log_pos;
+  return (ulonglong) active_rli()->future_group_master_log_pos;
 }
 
 #endif /* INNODB_COMPATIBILITY_HOOKS */
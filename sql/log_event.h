@@ -3561,6 +3561,11 @@ public:
     return m_rows_buf && m_cols.bitmap;
   }
 
+#if !defined(MYSQL_CLIENT) && defined(HAVE_REPLICATION)
+  /* Start over from the first row when the event is applied again */
+  void rewind_rows() { m_curr_row= m_rows_buf; m_curr_row_end= NULL; }
+#endif
+
   uint     m_row_count;         /* The number of rows added to the event */
 
 protected:
@@ -549,13 +549,24 @@ protected:
 #define OPTIMIZER_SWITCH_INDEX_MERGE_UNION 2
 #define OPTIMIZER_SWITCH_INDEX_MERGE_SORT_UNION 4
 #define OPTIMIZER_SWITCH_INDEX_MERGE_INTERSECT 8
-#define OPTIMIZER_SWITCH_LAST 16
+#define OPTIMIZER_SWITCH_JOIN_CACHE_HASH 16
+#define OPTIMIZER_SWITCH_MATERIALIZATION 32
+#define OPTIMIZER_SWITCH_SEMIJOIN 64
+#define OPTIMIZER_SWITCH_HASH_GROUP_BY 128
+#define OPTIMIZER_SWITCH_PLAN_CACHE 256
+#define OPTIMIZER_SWITCH_BATCHED_KEY_ACCESS 512
+#define OPTIMIZER_SWITCH_LAST 1024
 
 /* The following must be kept in sync with optimizer_switch_str in mysqld.cc */
 #define OPTIMIZER_SWITCH_DEFAULT (OPTIMIZER_SWITCH_INDEX_MERGE | \
                                   OPTIMIZER_SWITCH_INDEX_MERGE_UNION | \
                                   OPTIMIZER_SWITCH_INDEX_MERGE_SORT_UNION | \
-                                  OPTIMIZER_SWITCH_INDEX_MERGE_INTERSECT)
+                                  OPTIMIZER_SWITCH_INDEX_MERGE_INTERSECT | \
+                                  OPTIMIZER_SWITCH_JOIN_CACHE_HASH | \
+                                  OPTIMIZER_SWITCH_MATERIALIZATION | \
+                                  OPTIMIZER_SWITCH_SEMIJOIN | \
+                                  OPTIMIZER_SWITCH_HASH_GROUP_BY | \
+                                  OPTIMIZER_SWITCH_PLAN_CACHE)
 
 
 /*
@@ -1043,6 +1054,9 @@ inline bool is_supported_parser_charset(CHARSET_INFO *cs)
   return test(cs->mbminlen == 1);
 }
 bool setup_connection_thread_globals(THD *thd);
+bool login_connection(THD *thd);
+void prepare_new_connection_state(THD* thd);
+void end_connection(THD *thd);
 
 int mysql_create_db(THD *thd, char *db, HA_CREATE_INFO *create, bool silent);
 bool mysql_alter_db(THD *thd, const char *db, HA_CREATE_INFO *create);
@@ -1619,6 +1633,10 @@ void reset_global_db_stats(void);
 extern ST_FIELD_INFO table_stats_fields_info[];
 extern ST_FIELD_INFO index_stats_fields_info[];
 extern ST_FIELD_INFO db_stats_fields_info[];
+extern ST_FIELD_INFO admission_pools_fields_info[];
+extern ST_FIELD_INFO slave_parallel_workers_fields_info[];
+extern DB_STATS* global_db_stats_array;
+extern unsigned char num_db_stats_entries;
 
 int fill_table_stats(THD *thd, TABLE_LIST *tables, COND *cond);
 typedef void (*table_stats_cb)(const char *db, const char *table,
@@ -1638,6 +1656,8 @@ void fill_table_stats_cb(const char *db, const char *table,
                          const char *engine);
 
 int fill_db_stats(THD *thd, TABLE_LIST *tables, COND *cond);
+int fill_admission_pools(THD *thd, TABLE_LIST *tables, COND *cond);
+int fill_slave_parallel_workers(THD *thd, TABLE_LIST *tables, COND *cond);
 
 int fill_index_stats(THD *thd, TABLE_LIST *tables, COND *cond);
 
@@ -2016,13 +2036,14 @@ extern ulong delayed_insert_limit, delayed_queue_size;
 extern ulong delayed_insert_threads, delayed_insert_writes;
 extern ulong delayed_rows_in_use,delayed_insert_errors;
 extern ulong slave_open_temp_tables;
-extern ulong query_cache_size, query_cache_min_res_unit;
+extern ulong query_cache_size, query_cache_min_res_unit, query_cache_partitions;
 extern my_bool query_cache_skip_leading_comment;
 extern ulong slow_launch_threads, slow_launch_time;
-extern ulong table_cache_size, table_def_size;
+extern ulong table_cache_size, table_def_size, table_cache_instances;
 extern MYSQL_PLUGIN_IMPORT ulong max_connections;
 extern ulong max_connect_errors, connect_timeout;
 extern ulong slave_net_timeout, slave_trans_retries;
+extern ulong slave_parallel_workers, slave_parallel_queue_size;
 extern uint max_user_connections;
 extern ulong reserved_super_connections;
 extern ulong what_to_log,flush_time;
@@ -2034,6 +2055,8 @@ extern ulong max_binlog_size, max_relay_log_size;
 extern my_bool fix_relay_log_space_limit;
 extern ulong opt_binlog_rows_event_max_size;
 extern ulong rpl_recovery_rank, thread_cache_size, thread_pool_size;
+extern ulong thread_pool_oversubscribe, thread_pool_stall_limit;
+extern ulong thread_pool_max_threads, thread_pool_idle_timeout;
 extern ulong back_log;
 #endif /* MYSQL_SERVER */
 #if defined MYSQL_SERVER || defined INNODB_COMPATIBILITY_HOOKS
@@ -2166,6 +2189,8 @@ extern KNOWN_DATE_TIME_FORMAT known_date_time_formats[];
 extern String null_string;
 extern HASH open_cache, lock_db_cache;
 extern TABLE *unused_tables;
+/* TABLE::in_use of a table parked in a table cache instance */
+#define TABLE_CACHE_PARKED ((THD*) 1)
 extern const char* any_db;
 extern struct my_option my_long_options[];
 extern const LEX_STRING view_type;
@@ -2203,6 +2228,11 @@ extern ulong check_client_interval_msecs;
 extern my_bool admission_control;
 extern my_bool admission_control_diskio;
 extern my_bool admission_control_wait_reentry;
+extern ulong admission_control_db_max_running;
+extern ulong admission_control_db_max_queued;
+extern ulong admission_control_db_total_running;
+#define ADMISSION_CONTROL_DB_WEIGHTS_LEN 4096
+extern char admission_control_db_weights[ADMISSION_CONTROL_DB_WEIGHTS_LEN];
 extern my_bool transaction_control_disabled;
 
 extern ulong binlog_fsync_slow_usecs;
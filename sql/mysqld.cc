@@ -22,6 +22,7 @@
 #include "rpl_mi.h"
 #include "sql_repl.h"
 #include "rpl_filter.h"
+#include "rpl_parallel.h"
 #include "repl_failsafe.h"
 #include <my_stacktrace.h>
 #include "mysqld_suffix.h"
@@ -360,7 +361,9 @@ TYPELIB sql_mode_typelib= { array_elements(sql_mode_names)-1,"",
 static const char *optimizer_switch_names[]=
 {
   "index_merge","index_merge_union","index_merge_sort_union", 
-  "index_merge_intersection", "default", NullS
+  "index_merge_intersection", "join_cache_hash", "materialization",
+  "semijoin", "hash_group_by", "plan_cache", "batched_key_access",
+  "default", NullS
 };
 /* Corresponding defines are named OPTIMIZER_SWITCH_XXX */
 static const unsigned int optimizer_switch_names_len[]=
@@ -369,6 +372,12 @@ static const unsigned int optimizer_switch_names_len[]=
   sizeof("index_merge_union") - 1,
   sizeof("index_merge_sort_union") - 1,
   sizeof("index_merge_intersection") - 1,
+  sizeof("join_cache_hash") - 1,
+  sizeof("materialization") - 1,
+  sizeof("semijoin") - 1,
+  sizeof("hash_group_by") - 1,
+  sizeof("plan_cache") - 1,
+  sizeof("batched_key_access") - 1,
   sizeof("default") - 1
 };
 TYPELIB optimizer_switch_typelib= { array_elements(optimizer_switch_names)-1,"",
@@ -466,7 +475,10 @@ static const char *sql_mode_str= "OFF";
 /* Text representation for OPTIMIZER_SWITCH_DEFAULT */
 static const char *optimizer_switch_str="index_merge=on,index_merge_union=on,"
                                         "index_merge_sort_union=on,"
-                                        "index_merge_intersection=on";
+                                        "index_merge_intersection=on,"
+                                        "join_cache_hash=on,materialization=on,"
+                                        "semijoin=on,hash_group_by=on,"
+                                        "plan_cache=on,batched_key_access=off";
 static char *mysqld_user, *mysqld_chroot, *log_error_file_ptr;
 static char *opt_init_slave, *language_ptr, *opt_init_connect;
 static char *default_character_set_name;
@@ -618,14 +630,17 @@ uint tc_heuristic_recover= 0;
 uint volatile thread_count, thread_running, thread_binlog_client;
 ulonglong thd_startup_options;
 ulong back_log, connect_timeout, concurrency, server_id;
-ulong table_cache_size, table_def_size;
+ulong table_cache_size, table_def_size, table_cache_instances;
 ulong what_to_log;
 ulong query_buff_size, slow_launch_time, slave_open_temp_tables;
 ulong open_files_limit, max_binlog_size, max_relay_log_size;
 ulong slave_net_timeout, slave_trans_retries;
+ulong slave_parallel_workers, slave_parallel_queue_size;
 ulong slave_exec_mode_options;
 static const char *slave_exec_mode_str= "STRICT";
 ulong thread_cache_size=0, thread_pool_size= 0;
+ulong thread_pool_oversubscribe, thread_pool_stall_limit;
+ulong thread_pool_max_threads, thread_pool_idle_timeout;
 ulong binlog_cache_size=0;
 ulonglong  max_binlog_cache_size=0;
 ulong query_cache_size=0;
@@ -671,6 +686,11 @@ ulong check_client_interval_msecs= 1000;
 my_bool admission_control= FALSE;
 my_bool admission_control_diskio= TRUE;
 my_bool admission_control_wait_reentry= TRUE;
+ulong admission_control_db_max_running= 0;
+ulong admission_control_db_max_queued= 0;
+ulong admission_control_db_total_running= 0;
+char admission_control_db_weights[ADMISSION_CONTROL_DB_WEIGHTS_LEN];
+static char *opt_admission_control_db_weights;
 
 /* These are not in mysql_priv.h to reduce header dependencies */
 extern my_atomic_bigint admission_control_waits;
@@ -949,8 +969,9 @@ int deny_severity = LOG_WARNING;
 #ifdef HAVE_QUERY_CACHE
 static ulong query_cache_limit= 0;
 ulong query_cache_min_res_unit= QUERY_CACHE_MIN_RESULT_DATA_SIZE;
+ulong query_cache_partitions= 1;
 my_bool query_cache_skip_leading_comment= 0;
-Query_cache query_cache;
+Partitioned_query_cache query_cache;
 #endif
 #ifdef HAVE_SMEM
 char *shared_memory_base_name= default_shared_memory_base_name;
@@ -1496,6 +1517,7 @@ void clean_up(bool print_message)
   x_free(opt_perftools_profile_output);
   bitmap_free(&temp_pool);
   free_global_table_stats();
+  free_admission_pools();
   free_global_db_stats();
   free_max_user_conn();
 #ifdef HAVE_REPLICATION
@@ -4004,6 +4026,18 @@ a file name for --log-bin-index option", opt_binlog_index_name);
 
   init_global_table_stats();
   init_global_db_stats();
+  if (opt_admission_control_db_weights)
+  {
+    if (admission_pools_check_weights(opt_admission_control_db_weights))
+    {
+      sql_print_error("Invalid admission_control_db_weights '%s'",
+                      opt_admission_control_db_weights);
+      unireg_abort(1);
+    }
+    strmake(admission_control_db_weights, opt_admission_control_db_weights,
+            sizeof(admission_control_db_weights) - 1);
+  }
+  init_admission_pools();
 
   /* call ha_init_key_cache() on all key caches to init them */
   process_key_caches(&ha_init_key_cache);
@@ -5872,15 +5906,20 @@ enum options_mysqld
   OPT_PRELOAD_BUFFER_SIZE,
   OPT_QUERY_CACHE_LIMIT, OPT_QUERY_CACHE_MIN_RES_UNIT, OPT_QUERY_CACHE_SIZE,
   OPT_QUERY_CACHE_TYPE, OPT_QUERY_CACHE_WLOCK_INVALIDATE, OPT_RECORD_BUFFER,
-  OPT_QUERY_CACHE_SKIP_LEADING_COMMENT,
+  OPT_QUERY_CACHE_SKIP_LEADING_COMMENT, OPT_QUERY_CACHE_PARTITIONS,
   OPT_RECORD_RND_BUFFER, OPT_DIV_PRECINCREMENT, OPT_RELAY_LOG_SPACE_LIMIT,
   OPT_FIX_RELAY_LOG_SPACE_LIMIT,
   OPT_RELAY_LOG_PURGE,
   OPT_RELAY_FSYNC_FREQ,
   OPT_SLAVE_NET_TIMEOUT, OPT_SLAVE_COMPRESSED_PROTOCOL, OPT_SLOW_LAUNCH_TIME,
   OPT_SLAVE_TRANS_RETRIES, OPT_READONLY, OPT_DEBUGGING,
-  OPT_SORT_BUFFER, OPT_TABLE_OPEN_CACHE, OPT_TABLE_DEF_CACHE,
+  OPT_SLAVE_PARALLEL_WORKERS, OPT_SLAVE_PARALLEL_QUEUE_SIZE,
+  OPT_SORT_BUFFER, OPT_SORT_THREADS, OPT_TABLE_OPEN_CACHE, OPT_TABLE_DEF_CACHE,
+  OPT_TABLE_OPEN_CACHE_INSTANCES,
   OPT_THREAD_CONCURRENCY, OPT_THREAD_CACHE_SIZE,
+  OPT_THREAD_POOL_SIZE, OPT_THREAD_POOL_OVERSUBSCRIBE,
+  OPT_THREAD_POOL_STALL_LIMIT, OPT_THREAD_POOL_MAX_THREADS,
+  OPT_THREAD_POOL_IDLE_TIMEOUT,
   OPT_TMP_TABLE_SIZE, OPT_THREAD_STACK,
   OPT_WAIT_TIMEOUT,
   OPT_ERROR_LOG_FILE,
@@ -5929,6 +5968,7 @@ enum options_mysqld
   OPT_OLD_STYLE_USER_LIMITS,
   OPT_LOG_SLOW_ADMIN_STATEMENTS,
   OPT_TABLE_LOCK_WAIT_TIMEOUT,
+  OPT_TABLE_LOCK_FAST_PATH,
   OPT_PLUGIN_LOAD,
   OPT_PLUGIN_DIR,
   OPT_SYMBOLIC_LINKS,
@@ -5977,6 +6017,10 @@ enum options_mysqld
   OPT_ADMISSION_CONTROL,
   OPT_ADMISSION_CONTROL_DISKIO,
   OPT_ADMISSION_CONTROL_WAIT_REENTRY,
+  OPT_ADMISSION_CONTROL_DB_MAX_RUNNING,
+  OPT_ADMISSION_CONTROL_DB_MAX_QUEUED,
+  OPT_ADMISSION_CONTROL_DB_TOTAL_RUNNING,
+  OPT_ADMISSION_CONTROL_DB_WEIGHTS,
   OPT_CHECK_CLIENT_INTERVAL,
   OPT_CONNECTION_RECYCLE,
   OPT_CONNECTION_RECYCLE_PCT_CONNECTIONS_MIN,
@@ -7336,7 +7380,9 @@ thread is in the relay logs.",
    0, GET_ULONG, OPT_ARG, MAX_TABLES+1, 0, MAX_TABLES+2, 0, 1, 0},
   {"optimizer_switch", OPT_OPTIMIZER_SWITCH,
    "optimizer_switch=option=val[,option=val...], where option={index_merge, "
-   "index_merge_union, index_merge_sort_union, index_merge_intersection} and "
+   "index_merge_union, index_merge_sort_union, index_merge_intersection, "
+   "join_cache_hash, materialization, semijoin, hash_group_by, "
+   "plan_cache, batched_key_access} and "
    "val={on, off, default}.",
    &optimizer_switch_str, &optimizer_switch_str, 0, GET_STR, REQUIRED_ARG,
    /*OPTIMIZER_SWITCH_DEFAULT*/0, 0, 0, 0, 0, 0},
@@ -7371,6 +7417,12 @@ thread is in the relay logs.",
    &query_cache_min_res_unit, &query_cache_min_res_unit,
    0, GET_ULONG, REQUIRED_ARG, QUERY_CACHE_MIN_RESULT_DATA_SIZE,
    0, ULONG_MAX, 0, 1, 0},
+  {"query_cache_partitions", OPT_QUERY_CACHE_PARTITIONS,
+   "Number of partitions the query cache is split into. Each partition has "
+   "its own lock and an equal share of query_cache_size; statements are "
+   "assigned to partitions by a hash of their text.",
+   &query_cache_partitions, &query_cache_partitions, 0, GET_ULONG,
+   REQUIRED_ARG, 1, 1, QUERY_CACHE_MAX_PARTITIONS, 0, 1, 0},
   {"query_cache_skip_leading_comment", OPT_QUERY_CACHE_SKIP_LEADING_COMMENT,
    "Ignore a comment preceding a SELECT statement when checking the query cache.",
    &query_cache_skip_leading_comment,
@@ -7465,6 +7517,17 @@ thread is in the relay logs.",
    "Number of seconds to wait for more data from a master/slave connection before aborting the read.",
    &slave_net_timeout, &slave_net_timeout, 0,
    GET_ULONG, REQUIRED_ARG, SLAVE_NET_TIMEOUT, 1, LONG_TIMEOUT, 0, 1, 0},
+  {"slave_parallel_workers", OPT_SLAVE_PARALLEL_WORKERS,
+   "Number of worker threads that apply row based transactions of "
+   "different databases in parallel on the slave. 0 applies everything "
+   "in the slave SQL thread. Takes effect when the SQL thread starts.",
+   &slave_parallel_workers, &slave_parallel_workers, 0,
+   GET_ULONG, REQUIRED_ARG, 0, 0, SLAVE_PARALLEL_MAX_WORKERS, 0, 1, 0},
+  {"slave_parallel_queue_size", OPT_SLAVE_PARALLEL_QUEUE_SIZE,
+   "Number of events the slave SQL thread queues for a parallel worker "
+   "before it waits for the worker to catch up.",
+   &slave_parallel_queue_size, &slave_parallel_queue_size, 0,
+   GET_ULONG, REQUIRED_ARG, 1000, 1, (longlong) ULONG_MAX, 0, 1, 0},
   {"slave_transaction_retries", OPT_SLAVE_TRANS_RETRIES,
    "Number of times the slave SQL thread will retry a transaction in case "
    "it failed with a deadlock or elapsed lock wait timeout, "
@@ -7489,6 +7552,13 @@ thread is in the relay logs.",
    &max_system_variables.sortbuff_size, 0, GET_ULONG, REQUIRED_ARG,
    MAX_SORT_MEMORY, MIN_SORT_MEMORY+MALLOC_OVERHEAD*2, ~0L, MALLOC_OVERHEAD,
    1, 0},
+  {"sort_threads", OPT_SORT_THREADS,
+   "Maximum number of threads used by one sort, the connection thread "
+   "included. A sort that has enough rows makes its sort keys in the "
+   "connection thread while the other threads sort and merge them.",
+   &global_system_variables.sort_threads,
+   &max_system_variables.sort_threads, 0, GET_ULONG, REQUIRED_ARG,
+   1, 1, MAX_SORT_THREADS, 0, 1, 0},
   {"sync-binlog", OPT_SYNC_BINLOG,
    "Synchronously flush binary log to disk after every #th event. "
    "Use 0 (default) to disable synchronous flushing.",
@@ -7537,6 +7607,17 @@ thread is in the relay logs.",
    "The number of cached open tables.",
    &table_cache_size, &table_cache_size, 0, GET_ULONG,
    REQUIRED_ARG, TABLE_OPEN_CACHE_DEFAULT, 1, 512*1024L, 0, 1, 0},
+  {"table_open_cache_instances", OPT_TABLE_OPEN_CACHE_INSTANCES,
+   "The number of table cache instances. A thread reuses the tables it "
+   "closed through its own instance without taking LOCK_open.",
+   &table_cache_instances, &table_cache_instances, 0, GET_ULONG,
+   REQUIRED_ARG, 8, 1, 64, 0, 1, 0},
+  {"table_lock_fast_path", OPT_TABLE_LOCK_FAST_PATH,
+   "Grant the weak table locks taken by normal statements on InnoDB tables "
+   "without the table lock mutex. LOCK TABLES and ALTER TABLE wait until "
+   "these are released.",
+   &table_lock_fast_path, &table_lock_fast_path,
+   0, GET_BOOL, NO_ARG, 1, 0, 0, 0, 0, 0},
   {"table_lock_wait_timeout", OPT_TABLE_LOCK_WAIT_TIMEOUT,
    "Timeout in seconds to wait for a table level lock before returning an "
    "error. Used only if the connection has active cursors.",
@@ -7552,11 +7633,31 @@ thread is in the relay logs.",
    &concurrency, &concurrency, 0, GET_ULONG, REQUIRED_ARG,
    DEFAULT_CONCURRENCY, 1, 512, 0, 1, 0},
 #if HAVE_POOL_OF_THREADS == 1
-  {"thread_pool_size", OPT_THREAD_CACHE_SIZE,
-   "How many threads we should create to handle query requests in case of "
-   "'thread_handling=pool-of-threads'.",
+  {"thread_pool_idle_timeout", OPT_THREAD_POOL_IDLE_TIMEOUT,
+   "Seconds after which an idle worker thread of the pool exits. The last "
+   "worker of a thread group never exits.",
+   &thread_pool_idle_timeout, &thread_pool_idle_timeout, 0, GET_ULONG,
+   REQUIRED_ARG, 60, 1, UINT_MAX32, 0, 1, 0},
+  {"thread_pool_max_threads", OPT_THREAD_POOL_MAX_THREADS,
+   "Maximum number of worker threads in each thread group of the pool.",
+   &thread_pool_max_threads, &thread_pool_max_threads, 0, GET_ULONG,
+   REQUIRED_ARG, 64, 1, 16384, 0, 1, 0},
+  {"thread_pool_oversubscribe", OPT_THREAD_POOL_OVERSUBSCRIBE,
+   "How many worker threads of a thread group may execute commands at the "
+   "same time, in addition to one, unless the group is stalled.",
+   &thread_pool_oversubscribe, &thread_pool_oversubscribe, 0, GET_ULONG,
+   REQUIRED_ARG, 3, 0, 1000, 0, 1, 0},
+  {"thread_pool_size", OPT_THREAD_POOL_SIZE,
+   "Number of thread groups of the pool in case of "
+   "'thread_handling=pool-of-threads'. Each group has its own epoll set "
+   "and worker threads.",
    &thread_pool_size, &thread_pool_size, 0, GET_ULONG,
-   REQUIRED_ARG, 20, 1, 16384, 0, 1, 0},
+   REQUIRED_ARG, 20, 1, 1024, 0, 1, 0},
+  {"thread_pool_stall_limit", OPT_THREAD_POOL_STALL_LIMIT,
+   "Milliseconds after which a thread group that took no connection from "
+   "its queue is considered stalled, and may run more worker threads.",
+   &thread_pool_stall_limit, &thread_pool_stall_limit, 0, GET_ULONG,
+   REQUIRED_ARG, 500, 10, UINT_MAX32, 0, 1, 0},
 #endif
   {"thread_stack", OPT_THREAD_STACK,
    "The stack size for each thread.", &my_thread_stack_size,
@@ -7591,7 +7692,11 @@ thread is in the relay logs.",
    REQUIRED_ARG, TRANS_ALLOC_PREALLOC_SIZE, 1024, ULONG_MAX, 0, 1024, 0},
   {"thread_handling", OPT_THREAD_HANDLING,
    "Define threads usage for handling queries: "
-   "one-thread-per-connection or no-threads.", 0, 0,
+   "one-thread-per-connection or no-threads"
+#if HAVE_POOL_OF_THREADS == 1
+   " or pool-of-threads"
+#endif
+   ".", 0, 0,
    0, GET_STR, REQUIRED_ARG, 0, 0, 0, 0, 0, 0},
   {"updatable_views_with_limit", OPT_UPDATABLE_VIEWS_WITH_LIMIT,
    "1 = YES = Don't issue an error message (warning only) if a VIEW without "
@@ -7651,6 +7756,30 @@ thread is in the relay logs.",
    "or sleep() function. ",
    &admission_control_wait_reentry, &admission_control_wait_reentry,
    0, GET_BOOL, NO_ARG, 1, 0, 0, 0, 0, 0},
+  {"admission_control_db_max_running", OPT_ADMISSION_CONTROL_DB_MAX_RUNNING,
+   "Max number of queries that run concurrently per database when "
+   "admission_control is enabled, multiplied by the weight of the database. "
+   "0 (default) disables per-database admission control.",
+   &admission_control_db_max_running, &admission_control_db_max_running,
+   0, GET_ULONG, REQUIRED_ARG, 0, 0, 100000, 0, 1, 0},
+  {"admission_control_db_max_queued", OPT_ADMISSION_CONTROL_DB_MAX_QUEUED,
+   "Max number of queries that wait per database for "
+   "admission_control_db_max_running, multiplied by the weight of the "
+   "database. Queries beyond this fail. 0 (default) means no limit.",
+   &admission_control_db_max_queued, &admission_control_db_max_queued,
+   0, GET_ULONG, REQUIRED_ARG, 0, 0, 100000, 0, 1, 0},
+  {"admission_control_db_total_running",
+   OPT_ADMISSION_CONTROL_DB_TOTAL_RUNNING,
+   "Max number of queries that run concurrently in all databases when "
+   "per-database admission control is enabled. Freed slots go to the "
+   "database furthest below its weighted share. 0 (default) means no limit.",
+   &admission_control_db_total_running, &admission_control_db_total_running,
+   0, GET_ULONG, REQUIRED_ARG, 0, 0, 100000, 0, 1, 0},
+  {"admission_control_db_weights", OPT_ADMISSION_CONTROL_DB_WEIGHTS,
+   "Comma separated list of db:weight pairs for per-database admission "
+   "control. Databases not listed have weight 1.",
+   &opt_admission_control_db_weights, &opt_admission_control_db_weights,
+   0, GET_STR, REQUIRED_ARG, 0, 0, 0, 0, 0, 0},
   {"check_client_interval_milliseconds", OPT_CHECK_CLIENT_INTERVAL,
    "Interval at which server checks that client is still connected "
    "while its thread is blocked (on lock request, admission_control, "
@@ -7997,6 +8126,81 @@ static int show_open_tables(THD *thd, SHOW_VAR *var, char *buff)
   return 0;
 }
 
+#if HAVE_POOL_OF_THREADS == 1
+static int show_threadpool_threads(THD *thd, SHOW_VAR *var, char *buff)
+{
+  var->type= SHOW_LONG;
+  var->value= buff;
+  *((long *)buff)= (long) pool_of_threads_thread_count(FALSE);
+  return 0;
+}
+
+static int show_threadpool_idle_threads(THD *thd, SHOW_VAR *var, char *buff)
+{
+  var->type= SHOW_LONG;
+  var->value= buff;
+  *((long *)buff)= (long) pool_of_threads_thread_count(TRUE);
+  return 0;
+}
+#endif
+
+#ifdef HAVE_QUERY_CACHE
+/* Query cache counters are kept per partition and summed up here */
+static int show_qcache_counter(SHOW_VAR *var, char *buff,
+                               ulong Query_cache::*counter)
+{
+  var->type= SHOW_LONG;
+  var->value= buff;
+  *((long *)buff)= (long) query_cache.sum_status(counter);
+  return 0;
+}
+
+static int show_qcache_free_blocks(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_counter(var, buff, &Query_cache::free_memory_blocks);
+}
+
+static int show_qcache_free_memory(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_counter(var, buff, &Query_cache::free_memory);
+}
+
+static int show_qcache_hits(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_counter(var, buff, &Query_cache::hits);
+}
+
+static int show_qcache_inserts(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_counter(var, buff, &Query_cache::inserts);
+}
+
+static int show_qcache_lock_bypasses(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_counter(var, buff, &Query_cache::lock_bypasses);
+}
+
+static int show_qcache_lowmem_prunes(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_counter(var, buff, &Query_cache::lowmem_prunes);
+}
+
+static int show_qcache_not_cached(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_counter(var, buff, &Query_cache::refused);
+}
+
+static int show_qcache_queries_in_cache(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_counter(var, buff, &Query_cache::queries_in_cache);
+}
+
+static int show_qcache_total_blocks(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_counter(var, buff, &Query_cache::total_blocks);
+}
+#endif /*HAVE_QUERY_CACHE*/
+
 static int show_prepared_stmt_count(THD *thd, SHOW_VAR *var, char *buff)
 {
   var->type= SHOW_LONG;
@@ -8347,6 +8551,7 @@ SHOW_VAR status_vars[]= {
   {"Handler_savepoint_rollback",(char*) offsetof(STATUS_VAR, ha_savepoint_rollback_count), SHOW_LONG_STATUS},
   {"Handler_update",           (char*) offsetof(STATUS_VAR, ha_update_count), SHOW_LONG_STATUS},
   {"Handler_write",            (char*) offsetof(STATUS_VAR, ha_write_count), SHOW_LONG_STATUS},
+  {"Hash_group_spills",        (char*) offsetof(STATUS_VAR, hash_group_spills), SHOW_LONG_STATUS},
 #ifdef HAVE_JEMALLOC
   {"Jemalloc_arenas_narenas",  (char*) &show_jemalloc_arenas_narenas,   SHOW_FUNC},
   {"Jemalloc_opt_narenas",     (char*) &show_jemalloc_opt_narenas,      SHOW_FUNC},
@@ -8376,17 +8581,20 @@ SHOW_VAR status_vars[]= {
   {"Opened_fast",              (char*) &opened_fast,            SHOW_LONGLONG},
   {"Opened_not_fast",          (char*) &opened_not_fast,        SHOW_LONGLONG},
   {"Parse_seconds",            (char*) offsetof(STATUS_VAR, parse_seconds), SHOW_DOUBLE_STATUS},
+  {"Plan_cache_hits",          (char*) offsetof(STATUS_VAR, plan_cache_hits), SHOW_LONG_STATUS},
+  {"Plan_cache_misses",        (char*) offsetof(STATUS_VAR, plan_cache_misses), SHOW_LONG_STATUS},
   {"Pre_exec_seconds",         (char*) offsetof(STATUS_VAR, pre_exec_seconds), SHOW_DOUBLE_STATUS},
   {"Prepared_stmt_count",      (char*) &show_prepared_stmt_count, SHOW_FUNC},
 #ifdef HAVE_QUERY_CACHE
-  {"Qcache_free_blocks",       (char*) &query_cache.free_memory_blocks, SHOW_LONG_NOFLUSH},
-  {"Qcache_free_memory",       (char*) &query_cache.free_memory, SHOW_LONG_NOFLUSH},
-  {"Qcache_hits",              (char*) &query_cache.hits,       SHOW_LONG},
-  {"Qcache_inserts",           (char*) &query_cache.inserts,    SHOW_LONG},
-  {"Qcache_lowmem_prunes",     (char*) &query_cache.lowmem_prunes, SHOW_LONG},
-  {"Qcache_not_cached",        (char*) &query_cache.refused,    SHOW_LONG},
-  {"Qcache_queries_in_cache",  (char*) &query_cache.queries_in_cache, SHOW_LONG_NOFLUSH},
-  {"Qcache_total_blocks",      (char*) &query_cache.total_blocks, SHOW_LONG_NOFLUSH},
+  {"Qcache_free_blocks",       (char*) &show_qcache_free_blocks, SHOW_FUNC},
+  {"Qcache_free_memory",       (char*) &show_qcache_free_memory, SHOW_FUNC},
+  {"Qcache_hits",              (char*) &show_qcache_hits,       SHOW_FUNC},
+  {"Qcache_inserts",           (char*) &show_qcache_inserts,    SHOW_FUNC},
+  {"Qcache_lock_bypasses",     (char*) &show_qcache_lock_bypasses, SHOW_FUNC},
+  {"Qcache_lowmem_prunes",     (char*) &show_qcache_lowmem_prunes, SHOW_FUNC},
+  {"Qcache_not_cached",        (char*) &show_qcache_not_cached, SHOW_FUNC},
+  {"Qcache_queries_in_cache",  (char*) &show_qcache_queries_in_cache, SHOW_FUNC},
+  {"Qcache_total_blocks",      (char*) &show_qcache_total_blocks, SHOW_FUNC},
 #endif /*HAVE_QUERY_CACHE*/
   {"Queries",                  (char*) &show_queries,            SHOW_FUNC},
   {"Questions",                (char*) offsetof(STATUS_VAR, questions), SHOW_LONG_STATUS},
@@ -8477,6 +8685,7 @@ SHOW_VAR status_vars[]= {
   {"Slow_launch_threads",      (char*) &slow_launch_threads,    SHOW_LONG},
   {"Slow_queries",             (char*) offsetof(STATUS_VAR, long_query_count), SHOW_LONG_STATUS},
   {"Sort_merge_passes",	       (char*) offsetof(STATUS_VAR, filesort_merge_passes), SHOW_LONG_STATUS},
+  {"Sort_priority_queue_sorts", (char*) offsetof(STATUS_VAR, filesort_pq_sorts), SHOW_LONG_STATUS},
   {"Sort_range",	       (char*) offsetof(STATUS_VAR, filesort_range_count), SHOW_LONG_STATUS},
   {"Sort_rows",		       (char*) offsetof(STATUS_VAR, filesort_rows), SHOW_LONG_STATUS},
   {"Sort_scan",		       (char*) offsetof(STATUS_VAR, filesort_scan_count), SHOW_LONG_STATUS},
@@ -8505,12 +8714,17 @@ SHOW_VAR status_vars[]= {
   {"Ssl_verify_mode",          (char*) &show_ssl_get_verify_mode, SHOW_FUNC},
   {"Ssl_version",              (char*) &show_ssl_get_version, SHOW_FUNC},
 #endif /* HAVE_OPENSSL */
+  {"Table_locks_fast",         (char*) &locks_fast,             SHOW_LONG},
   {"Table_locks_immediate",    (char*) &locks_immediate,        SHOW_LONG},
   {"Table_locks_waited",       (char*) &locks_waited,           SHOW_LONG},
 #ifdef HAVE_MMAP
   {"Tc_log_max_pages_used",    (char*) &tc_log_max_pages_used,  SHOW_LONG},
   {"Tc_log_page_size",         (char*) &tc_log_page_size,       SHOW_LONG},
   {"Tc_log_page_waits",        (char*) &tc_log_page_waits,      SHOW_LONG},
+#endif
+#if HAVE_POOL_OF_THREADS == 1
+  {"Threadpool_idle_threads",  (char*) &show_threadpool_idle_threads, SHOW_FUNC},
+  {"Threadpool_threads",       (char*) &show_threadpool_threads, SHOW_FUNC},
 #endif
   {"Threads_binlog_client",    (char*) &thread_binlog_client,   SHOW_INT},
   {"Threads_cached",           (char*) &cached_thread_count,    SHOW_LONG_NOFLUSH},
@@ -8687,6 +8901,11 @@ static int mysql_init_variables(void)
   admission_control= FALSE;
   admission_control_diskio= TRUE;
   admission_control_wait_reentry= FALSE;
+  admission_control_db_max_running= 0;
+  admission_control_db_max_queued= 0;
+  admission_control_db_total_running= 0;
+  admission_control_db_weights[0]= 0;
+  opt_admission_control_db_weights= NULL;
 
   transaction_control_disabled= FALSE;
 
@@ -10085,6 +10304,9 @@ void refresh_status(THD *thd)
 
   /* Reset some global variables */
   reset_status_vars();
+#ifdef HAVE_QUERY_CACHE
+  query_cache.reset_status();
+#endif
 
   /* Reset the counters of all key caches (default and named). */
   process_key_caches(reset_key_cache_counters);
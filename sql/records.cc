@@ -255,8 +255,17 @@ void init_read_record(READ_RECORD *info,THD *thd, TABLE *table,
     DBUG_PRINT("info",("using record_pointers"));
     table->file->ha_rnd_init(0);
     info->cache_pos=table->sort.record_pointers;
-    info->cache_end=info->cache_pos+ 
-                    table->sort.found_records*info->ref_length;
+    if (table->sort.addon_field && table->sort.packed_addons)
+    {
+      /* The records start with their length */
+      uchar *pos= info->cache_pos;
+      for (ha_rows i= 0; i < table->sort.found_records; i++)
+        pos+= uint2korr(pos);
+      info->cache_end= pos;
+    }
+    else
+      info->cache_end=info->cache_pos+ 
+                      table->sort.found_records*info->ref_length;
     info->read_record= (table->sort.addon_field ?
                         rr_unpack_from_buffer : rr_from_pointers);
   }
@@ -447,9 +456,17 @@ static int rr_from_tempfile(READ_RECORD *info)
 
 static int rr_unpack_from_tempfile(READ_RECORD *info)
 {
-  if (my_b_read(info->io_cache, info->rec_buf, info->ref_length))
-    return -1;
   TABLE *table= info->table;
+  if (table->sort.packed_addons)
+  {
+    /* The record starts with its length */
+    if (my_b_read(info->io_cache, info->rec_buf, 2) ||
+        my_b_read(info->io_cache, info->rec_buf + 2,
+                  uint2korr(info->rec_buf) - 2))
+      return -1;
+  }
+  else if (my_b_read(info->io_cache, info->rec_buf, info->ref_length))
+    return -1;
   (*table->sort.unpack)(table->sort.addon_field, info->rec_buf);
 
   return 0;
@@ -502,7 +519,8 @@ static int rr_unpack_from_buffer(READ_RECORD *info)
     return -1;                      /* End of buffer */
   TABLE *table= info->table;
   (*table->sort.unpack)(table->sort.addon_field, info->cache_pos);
-  info->cache_pos+= info->ref_length;
+  info->cache_pos+= (table->sort.packed_addons ? uint2korr(info->cache_pos) :
+                     info->ref_length);
 
   return 0;
 }
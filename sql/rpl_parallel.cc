@@ -0,0 +1,944 @@
+/*
+  Parallel apply of the relay log, see rpl_parallel.h
+*/
+
+#include "mysql_priv.h"
+
+#ifdef HAVE_REPLICATION
+
+#include "rpl_mi.h"
+#include "rpl_rli.h"
+#include "rpl_filter.h"
+#include "slave.h"
+#include "log_event.h"
+#include "rpl_parallel.h"
+
+RPL_PARALLEL_WORKER_STATS rpl_parallel_worker_stats[SLAVE_PARALLEL_MAX_WORKERS];
+uint rpl_parallel_worker_count= 0;
+
+#define NO_ABORT_SEQ (~(ulonglong) 0)
+
+static bool is_query(Log_event *ev, const char *query)
+{
+  return ev->get_type_code() == QUERY_EVENT &&
+         !strcmp(((Query_log_event*) ev)->query, query);
+}
+
+static bool is_end_event(Log_event *ev)
+{
+  return ev->get_type_code() == XID_EVENT ||
+         is_query(ev, "COMMIT") || is_query(ev, "ROLLBACK");
+}
+
+/* Events a worker may get after the Table_map that started its group */
+static bool is_group_event(Log_event *ev)
+{
+  switch (ev->get_type_code()) {
+  case TABLE_MAP_EVENT:
+  case WRITE_ROWS_EVENT:
+  case UPDATE_ROWS_EVENT:
+  case DELETE_ROWS_EVENT:
+    return TRUE;
+  default:
+    return is_end_event(ev);
+  }
+}
+
+
+pthread_handler_t handle_slave_worker(void *arg)
+{
+  THD *thd;                     /* needs to be first for thread_stack */
+  RPL_PARALLEL_WORKER *w= (RPL_PARALLEL_WORKER*) arg;
+  Rpl_parallel *pool= w->pool;
+  Relay_log_info *rli;
+
+  my_thread_init();
+  DBUG_ENTER("handle_slave_worker");
+
+  thd= new THD;
+  thd->thread_stack= (char*) &thd;
+  rli= new Relay_log_info;
+  rli->no_storage= TRUE;
+  rli->sql_thd= thd;
+  rli->mi= w->rli->mi;
+  pthread_detach_this_thread();
+  if (init_slave_thread(thd, SLAVE_THD_SQL))
+  {
+    delete rli;
+    delete thd;
+    w->thd= NULL;
+    goto end;
+  }
+  thd->init_for_queries();
+  thd->rli_slave= rli;
+  w->thd= thd;
+  w->rli= rli;
+  w->stats->thread_id= thd->thread_id;
+  pthread_mutex_lock(&LOCK_thread_count);
+  threads.append(thd);
+  pthread_mutex_unlock(&LOCK_thread_count);
+
+  pool->run_worker(w);
+
+  thd->clear_error();
+  rli->cleanup_context(thd, 1);
+  net_end(&thd->net);
+  /* The format description belongs to the coordinator */
+  rli->relay_log.description_event_for_exec= NULL;
+  thd->rli_slave= NULL;
+  delete rli;
+  w->stats->thread_id= 0;
+  pthread_mutex_lock(&LOCK_thread_count);
+  THD_CHECK_SENTRY(thd);
+  delete thd;
+  pthread_mutex_unlock(&LOCK_thread_count);
+
+end:
+  pool->worker_ended(w);
+  DBUG_LEAVE;
+  my_thread_end();
+  pthread_exit(0);
+  return 0;
+}
+
+
+Rpl_parallel::Rpl_parallel(Relay_log_info *rli_arg)
+  :rli(rli_arg), workers(NULL), n_workers(0), last_seq(0), committed_seq(0),
+   abort_seq(NO_ABORT_SEQ), error(FALSE), cur_group(NULL), full_worker(NULL),
+   held_begin(NULL), held_begin_pos(0), held_begin_end_pos(0),
+   force_serial(FALSE)
+{
+  pthread_mutex_init(&lock, MY_MUTEX_INIT_FAST);
+  pthread_cond_init(&commit_cond, NULL);
+  pthread_cond_init(&coordinator_cond, NULL);
+}
+
+
+Rpl_parallel::~Rpl_parallel()
+{
+  uint i;
+  for (i= 0; i < n_workers; i++)
+    pthread_cond_destroy(&workers[i].cond);
+  my_free(workers, MYF(MY_ALLOW_ZERO_PTR));
+  delete held_begin;
+  pthread_mutex_destroy(&lock);
+  pthread_cond_destroy(&commit_cond);
+  pthread_cond_destroy(&coordinator_cond);
+}
+
+
+/*
+  Start n_workers worker threads for the SQL thread of rli.
+
+  Returns NULL if a thread could not be started.
+*/
+Rpl_parallel *Rpl_parallel::start(Relay_log_info *rli, uint n_workers)
+{
+  Rpl_parallel *pool;
+  uint i;
+  DBUG_ENTER("Rpl_parallel::start");
+
+  if (!(pool= new Rpl_parallel(rli)) ||
+      !(pool->workers= (RPL_PARALLEL_WORKER*)
+        my_malloc(n_workers * sizeof(RPL_PARALLEL_WORKER),
+                  MYF(MY_WME | MY_ZEROFILL))))
+  {
+    delete pool;
+    DBUG_RETURN(NULL);
+  }
+
+  bzero(rpl_parallel_worker_stats, sizeof(rpl_parallel_worker_stats));
+  rpl_parallel_worker_count= n_workers;
+
+  for (i= 0; i < n_workers; i++)
+  {
+    RPL_PARALLEL_WORKER *w= &pool->workers[i];
+    w->id= i;
+    w->pool= pool;
+    w->rli= rli;
+    w->queue_last= &w->queue;
+    w->stats= &rpl_parallel_worker_stats[i];
+    pthread_cond_init(&w->cond, NULL);
+    pool->n_workers++;
+
+    w->running= TRUE;
+    if (pthread_create(&w->thread, &connection_attrib, handle_slave_worker,
+                       (void*) w))
+    {
+      w->running= FALSE;
+      pool->stop();
+      DBUG_RETURN(NULL);
+    }
+  }
+
+  /* Fail if a worker could not initialize its THD */
+  pthread_mutex_lock(&pool->lock);
+  for (i= 0; i < n_workers; i++)
+  {
+    RPL_PARALLEL_WORKER *w= &pool->workers[i];
+    while (w->running && !w->thd)
+      pthread_cond_wait(&pool->coordinator_cond, &pool->lock);
+    if (!w->thd)
+      break;
+  }
+  pthread_mutex_unlock(&pool->lock);
+  if (i < n_workers)
+  {
+    pool->stop();
+    DBUG_RETURN(NULL);
+  }
+  DBUG_RETURN(pool);
+}
+
+
+/*
+  Let the workers commit the transactions they have completely received,
+  roll back the others and end the worker threads.  Deletes the pool.
+*/
+void Rpl_parallel::stop()
+{
+  uint i;
+  RPL_PARALLEL_GROUP *g;
+  DBUG_ENTER("Rpl_parallel::stop");
+
+  pthread_mutex_lock(&lock);
+  for (i= 0; i < n_workers; i++)
+    for (g= workers[i].queue; g; g= g->next)
+      if (!g->complete && g->seq < abort_seq)
+        set_abort(g->seq);
+  for (i= 0; i < n_workers; i++)
+    while (workers[i].queue)
+      pthread_cond_wait(&coordinator_cond, &lock);
+  for (i= 0; i < n_workers; i++)
+  {
+    workers[i].exit= TRUE;
+    pthread_cond_signal(&workers[i].cond);
+  }
+  for (i= 0; i < n_workers; i++)
+    while (workers[i].running)
+      pthread_cond_wait(&coordinator_cond, &lock);
+  pthread_mutex_unlock(&lock);
+
+  delete this;
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Roll back transactions from seq on.  Called with the pool lock held.
+*/
+void Rpl_parallel::set_abort(ulonglong seq)
+{
+  uint i;
+  safe_mutex_assert_owner(&lock);
+  if (seq < abort_seq)
+    abort_seq= seq;
+  for (i= 0; i < n_workers; i++)
+    pthread_cond_signal(&workers[i].cond);
+  pthread_cond_broadcast(&commit_cond);
+}
+
+
+RPL_PARALLEL_WORKER *Rpl_parallel::pick_worker(Log_event *ev)
+{
+  const char *db;
+  size_t len;
+  ulong nr1= 1, nr2= 4;
+
+  db= ((Table_map_log_event*) ev)->get_db();
+  len= strlen(db);
+  db= rpl_filter->get_rewrite_db(db, &len);
+  my_charset_bin.coll->hash_sort(&my_charset_bin, (const uchar*) db, len,
+                                 &nr1, &nr2);
+  return &workers[nr1 % n_workers];
+}
+
+
+/*
+  Queue a new transaction, starting with the held BEGIN, for worker w.
+*/
+RPL_PARALLEL_GROUP *Rpl_parallel::new_group(RPL_PARALLEL_WORKER *w)
+{
+  RPL_PARALLEL_GROUP *g;
+
+  if (!(g= (RPL_PARALLEL_GROUP*) my_malloc(sizeof(RPL_PARALLEL_GROUP),
+                                           MYF(MY_WME | MY_ZEROFILL))))
+    return NULL;
+  g->worker= w;
+  strmake(g->relay_log_name, rli->event_relay_log_name,
+          sizeof(g->relay_log_name) - 1);
+  g->relay_log_pos= held_begin_pos;
+  strmake(g->master_log_name, rli->group_master_log_name,
+          sizeof(g->master_log_name) - 1);
+  g->master_log_pos= rli->group_master_log_pos;
+  g->description_event= rli->relay_log.description_event_for_exec;
+  g->when= held_begin->when;
+  g->last_event= &g->events;
+
+  pthread_mutex_lock(&lock);
+  g->seq= ++last_seq;
+  *w->queue_last= g;
+  w->queue_last= &g->next;
+  if (!w->stats->queued_trx++)
+    w->stats->oldest_when= g->when;
+  pthread_cond_signal(&w->cond);
+  pthread_mutex_unlock(&lock);
+  return g;
+}
+
+
+/*
+  Append an event to a queued transaction, waiting while the queue of
+  its worker is full.  The event is deleted on error.
+*/
+bool Rpl_parallel::append(RPL_PARALLEL_GROUP *g, Log_event *ev,
+                          my_off_t end_pos, bool is_end)
+{
+  RPL_PARALLEL_WORKER *w= g->worker;
+  RPL_PARALLEL_EVENT *e;
+
+  if (!(e= (RPL_PARALLEL_EVENT*) my_malloc(sizeof(RPL_PARALLEL_EVENT),
+                                           MYF(MY_WME))))
+  {
+    delete ev;
+    rli->report(ERROR_LEVEL, ER_OUT_OF_RESOURCES,
+                "Out of memory queueing an event for a slave worker");
+    return TRUE;
+  }
+  e->ev= ev;
+  e->end_pos= end_pos;
+  e->is_end= is_end;
+  e->next= NULL;
+
+  pthread_mutex_lock(&lock);
+  if (w->stats->queued_events >= slave_parallel_queue_size &&
+      abort_seq == NO_ABORT_SEQ)
+  {
+    w->stats->queue_full_waits++;
+    full_worker= w;
+    pthread_mutex_unlock(&lock);
+    if (coordinator_wait(&Rpl_parallel::queue_has_room,
+                         "Waiting for a slave worker to make room"))
+    {
+      delete ev;
+      my_free(e, MYF(0));
+      return TRUE;
+    }
+    pthread_mutex_lock(&lock);
+  }
+  if (abort_seq != NO_ABORT_SEQ)
+  {
+    /* A worker failed, g may have been rolled back and freed */
+    pthread_mutex_unlock(&lock);
+    delete ev;
+    my_free(e, MYF(0));
+    return TRUE;
+  }
+  *g->last_event= e;
+  g->last_event= &e->next;
+  g->n_events++;
+  w->stats->queued_events++;
+  if (is_end)
+    g->complete= TRUE;
+  pthread_cond_signal(&w->cond);
+  pthread_mutex_unlock(&lock);
+  return FALSE;
+}
+
+
+/*
+  Wait on coordinator_cond until done() holds.
+
+  Returns TRUE if a worker failed or the SQL thread was stopped first.
+*/
+bool Rpl_parallel::coordinator_wait(bool (Rpl_parallel::*done)(),
+                                    const char *msg)
+{
+  THD *thd= rli->sql_thd;
+  const char *old_msg;
+  bool res;
+
+  pthread_mutex_lock(&lock);
+  if ((this->*done)() || error)
+  {
+    res= error;
+    pthread_mutex_unlock(&lock);
+    return res;
+  }
+  old_msg= thd->enter_cond(&coordinator_cond, &lock, msg);
+  while (!(this->*done)() && !error &&
+         !thd->killed && !rli->abort_slave && !abort_loop)
+    pthread_cond_wait(&coordinator_cond, &lock);
+  res= error || !(this->*done)();
+  thd->exit_cond(old_msg);
+  return res;
+}
+
+
+bool Rpl_parallel::workers_idle()
+{
+  uint i;
+  for (i= 0; i < n_workers; i++)
+    if (workers[i].queue)
+      return FALSE;
+  return TRUE;
+}
+
+
+bool Rpl_parallel::queue_has_room()
+{
+  return full_worker->stats->queued_events < slave_parallel_queue_size;
+}
+
+
+/*
+  Apply an event read earlier on the coordinator, at its relay log
+  position.  The workers must be idle.
+*/
+int Rpl_parallel::apply_here(Log_event *ev, my_off_t pos, my_off_t end_pos)
+{
+  my_off_t save_pos, save_future_pos;
+  int res;
+
+  pthread_mutex_lock(&rli->data_lock);
+  save_pos= rli->event_relay_log_pos;
+  save_future_pos= rli->future_event_relay_log_pos;
+  rli->event_relay_log_pos= pos;
+  rli->future_event_relay_log_pos= end_pos;
+  res= apply_event_and_update_pos(ev, rli->sql_thd, rli);
+  delete ev;
+  pthread_mutex_lock(&rli->data_lock);
+  rli->event_relay_log_pos= save_pos;
+  rli->future_event_relay_log_pos= save_future_pos;
+  pthread_mutex_unlock(&rli->data_lock);
+  return res;
+}
+
+
+/*
+  The transaction of the held BEGIN is not parallel safe: apply the BEGIN
+  on the coordinator, which then applies the rest of the transaction.
+*/
+int Rpl_parallel::apply_held_begin()
+{
+  Log_event *ev= held_begin;
+
+  held_begin= NULL;
+  if (coordinator_wait(&Rpl_parallel::workers_idle,
+                       "Waiting for slave workers to commit"))
+  {
+    delete ev;
+    return 1;
+  }
+  return apply_here(ev, held_begin_pos, held_begin_end_pos) ? 1 : 0;
+}
+
+
+/*
+  The transaction being handed out is not parallel safe.  Take it back
+  from its worker, rolling back what the worker applied of it, and seek
+  back to its start so that the coordinator applies it when it reads it
+  again.
+*/
+int Rpl_parallel::abandon_group()
+{
+  const char *errmsg;
+  DBUG_ENTER("Rpl_parallel::abandon_group");
+
+  pthread_mutex_lock(&lock);
+  if (abort_seq != NO_ABORT_SEQ)
+  {
+    /* A worker failed meanwhile */
+    cur_group= NULL;
+    pthread_mutex_unlock(&lock);
+    DBUG_RETURN(1);
+  }
+  set_abort(cur_group->seq);
+  cur_group= NULL;
+  pthread_mutex_unlock(&lock);
+  if (coordinator_wait(&Rpl_parallel::workers_idle,
+                       "Waiting for slave workers to roll back"))
+    DBUG_RETURN(1);
+  pthread_mutex_lock(&lock);
+  committed_seq= last_seq;
+  abort_seq= NO_ABORT_SEQ;
+  pthread_mutex_unlock(&lock);
+
+  if (init_master_info(rli->mi, 0, 0, 0, SLAVE_SQL))
+  {
+    rli->report(ERROR_LEVEL, ER_SLAVE_FATAL_ERROR,
+                "Failed to initialize the master info structure");
+    DBUG_RETURN(1);
+  }
+  if (init_relay_log_pos(rli, rli->group_relay_log_name,
+                         rli->group_relay_log_pos, 1, &errmsg, 1))
+  {
+    rli->report(ERROR_LEVEL, ER_SLAVE_FATAL_ERROR,
+                "Error initializing relay log position: %s", errmsg);
+    DBUG_RETURN(1);
+  }
+  force_serial= TRUE;
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Hand an event read by the SQL thread to a worker.
+
+  Called with rli->data_lock held, which is released.  Returns -1 when
+  the SQL thread must apply the event itself, the workers are idle then.
+  Otherwise the event is consumed and 0 is returned, or 1 on error.
+*/
+int Rpl_parallel::schedule(Log_event *ev)
+{
+  RPL_PARALLEL_WORKER *w;
+  RPL_PARALLEL_GROUP *g;
+  my_off_t end_pos;
+  bool end, safe;
+  DBUG_ENTER("Rpl_parallel::schedule");
+
+  if ((g= cur_group))
+  {
+    w= ev->get_type_code() == TABLE_MAP_EVENT ? pick_worker(ev) : NULL;
+    pthread_mutex_lock(&lock);
+    if (abort_seq != NO_ABORT_SEQ)
+    {
+      /*
+        A worker failed and the transaction was rolled back: its worker
+        may have freed it already.  The worker reported the error.
+      */
+      pthread_mutex_unlock(&lock);
+      pthread_mutex_unlock(&rli->data_lock);
+      delete ev;
+      cur_group= NULL;
+      DBUG_RETURN(1);
+    }
+    safe= is_group_event(ev) && (!w || w == g->worker) &&
+          !strcmp(rli->event_relay_log_name, g->relay_log_name);
+    pthread_mutex_unlock(&lock);
+    if (!safe)
+    {
+      pthread_mutex_unlock(&rli->data_lock);
+      delete ev;
+      DBUG_RETURN(abandon_group());
+    }
+    end= is_end_event(ev);
+    end_pos= rli->future_event_relay_log_pos;
+    rli->inc_event_relay_log_pos();
+    pthread_mutex_unlock(&rli->data_lock);
+    if (end)
+      cur_group= NULL;
+    DBUG_RETURN(append(g, ev, end_pos, end) ? 1 : 0);
+  }
+
+  if (held_begin)
+  {
+    if (ev->get_type_code() == TABLE_MAP_EVENT)
+    {
+      w= pick_worker(ev);
+      if (!(g= new_group(w)))
+      {
+        pthread_mutex_unlock(&rli->data_lock);
+        delete ev;
+        rli->report(ERROR_LEVEL, ER_OUT_OF_RESOURCES,
+                    "Out of memory queueing a transaction for a slave worker");
+        DBUG_RETURN(1);
+      }
+      end_pos= rli->future_event_relay_log_pos;
+      rli->inc_event_relay_log_pos();
+      pthread_mutex_unlock(&rli->data_lock);
+      cur_group= g;
+      Log_event *begin= held_begin;
+      held_begin= NULL;
+      if (append(g, begin, held_begin_end_pos, FALSE))
+      {
+        delete ev;
+        DBUG_RETURN(1);
+      }
+      DBUG_RETURN(append(g, ev, end_pos, FALSE) ? 1 : 0);
+    }
+    pthread_mutex_unlock(&rli->data_lock);
+    if (apply_held_begin())
+    {
+      delete ev;
+      DBUG_RETURN(1);
+    }
+    pthread_mutex_lock(&rli->data_lock);
+    DBUG_RETURN(-1);
+  }
+
+  if (is_query(ev, "BEGIN"))
+  {
+    if (!force_serial &&
+        rli->until_condition == Relay_log_info::UNTIL_NONE &&
+        !rli->slave_skip_counter && !rli->is_in_group())
+    {
+      held_begin= ev;
+      held_begin_pos= rli->event_relay_log_pos;
+      held_begin_end_pos= rli->future_event_relay_log_pos;
+      rli->inc_event_relay_log_pos();
+      pthread_mutex_unlock(&rli->data_lock);
+      DBUG_RETURN(0);
+    }
+    force_serial= FALSE;
+  }
+
+  pthread_mutex_unlock(&rli->data_lock);
+  if (coordinator_wait(&Rpl_parallel::workers_idle,
+                       "Waiting for slave workers to commit"))
+  {
+    delete ev;
+    DBUG_RETURN(1);
+  }
+  pthread_mutex_lock(&rli->data_lock);
+  DBUG_RETURN(-1);
+}
+
+
+void Rpl_parallel::worker_ended(RPL_PARALLEL_WORKER *w)
+{
+  pthread_mutex_lock(&lock);
+  w->running= FALSE;
+  pthread_cond_broadcast(&coordinator_cond);
+  pthread_mutex_unlock(&lock);
+}
+
+
+void Rpl_parallel::run_worker(RPL_PARALLEL_WORKER *w)
+{
+  THD *thd= w->thd;
+  RPL_PARALLEL_GROUP *g;
+  const char *old_msg;
+  DBUG_ENTER("Rpl_parallel::run_worker");
+
+  pthread_mutex_lock(&lock);
+  pthread_cond_broadcast(&coordinator_cond);
+  for (;;)
+  {
+    old_msg= thd->enter_cond(&w->cond, &lock,
+                             "Waiting for a transaction from the coordinator");
+    while (!(g= w->queue) && !w->exit)
+      pthread_cond_wait(&w->cond, &lock);
+    /* Start when the transaction is complete or fills the queue */
+    while (g && !g->complete && g->n_events < slave_parallel_queue_size &&
+           g->seq < abort_seq)
+      pthread_cond_wait(&w->cond, &lock);
+    thd->exit_cond(old_msg);
+    if (!g)
+      break;
+
+    apply_group(w, g);
+
+    pthread_mutex_lock(&lock);
+    w->queue= g->next;
+    if (!w->queue)
+      w->queue_last= &w->queue;
+    w->stats->queued_trx--;
+    w->stats->queued_events-= g->n_events - g->n_applied;
+    w->stats->oldest_when= w->queue ? w->queue->when : 0;
+    free_group(g);
+    pthread_cond_broadcast(&coordinator_cond);
+  }
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Apply a transaction, retrying it on temporary errors.
+
+  Returns 0 if it was committed, 1 if it was rolled back because an
+  earlier one failed or the slave is stopping and 2 if it failed.
+*/
+int Rpl_parallel::apply_group(RPL_PARALLEL_WORKER *w, RPL_PARALLEL_GROUP *g)
+{
+  THD *thd= w->thd;
+  Relay_log_info *wrli= w->rli;
+  RPL_PARALLEL_EVENT *e, **next;
+  const char *old_msg;
+  uint n, retries= 0;
+  int res;
+  DBUG_ENTER("Rpl_parallel::apply_group");
+
+retry:
+  pthread_mutex_lock(&wrli->data_lock);
+  strmake(wrli->group_relay_log_name, g->relay_log_name,
+          sizeof(wrli->group_relay_log_name) - 1);
+  strmake(wrli->event_relay_log_name, g->relay_log_name,
+          sizeof(wrli->event_relay_log_name) - 1);
+  wrli->group_relay_log_pos= wrli->event_relay_log_pos= g->relay_log_pos;
+  strmake(wrli->group_master_log_name, g->master_log_name,
+          sizeof(wrli->group_master_log_name) - 1);
+  wrli->group_master_log_pos= g->master_log_pos;
+  wrli->relay_log.description_event_for_exec= g->description_event;
+  pthread_mutex_unlock(&wrli->data_lock);
+
+  pthread_mutex_lock(&lock);
+  g->started= TRUE;
+  next= &g->events;
+  for (n= 0;; n++)
+  {
+    if (!(e= *next) && g->seq < abort_seq && !thd->killed)
+    {
+      old_msg= thd->enter_cond(&w->cond, &lock,
+                               "Waiting for an event from the coordinator");
+      while (!(e= *next) && g->seq < abort_seq && !thd->killed)
+        pthread_cond_wait(&w->cond, &lock);
+      thd->exit_cond(old_msg);
+      pthread_mutex_lock(&lock);
+    }
+    if (g->seq >= abort_seq)
+    {
+      pthread_mutex_unlock(&lock);
+      wrli->cleanup_context(thd, 1);
+      DBUG_RETURN(1);
+    }
+    if (!e)
+    {
+      /* Killed while waiting for the coordinator */
+      pthread_mutex_unlock(&lock);
+      thd->send_kill_message();
+      report_error(w, g);
+      wrli->cleanup_context(thd, 1);
+      DBUG_RETURN(2);
+    }
+    if (n == g->n_applied)
+    {
+      g->n_applied++;
+      w->stats->queued_events--;
+      pthread_cond_broadcast(&coordinator_cond);
+    }
+    if (e->is_end && !wait_for_turn(w, g))
+    {
+      pthread_mutex_unlock(&lock);
+      wrli->cleanup_context(thd, 1);
+      DBUG_RETURN(1);
+    }
+    pthread_mutex_unlock(&lock);
+
+    if (thd->killed)
+    {
+      thd->send_kill_message();
+      res= 1;
+    }
+    else
+    {
+      pthread_mutex_lock(&wrli->data_lock);
+      wrli->future_event_relay_log_pos= e->end_pos;
+      if (e->ev->get_type_code() >= WRITE_ROWS_EVENT &&
+          e->ev->get_type_code() <= DELETE_ROWS_EVENT)
+        ((Rows_log_event*) e->ev)->rewind_rows();
+      res= apply_event_and_update_pos(e->ev, thd, wrli);
+    }
+    if (res)
+    {
+      if (res == 1 && has_temporary_error(thd) &&
+          retries < slave_trans_retries)
+      {
+        struct timespec abstime;
+
+        wrli->cleanup_context(thd, 1);
+        thd->clear_error();
+        retries++;
+        w->stats->retries++;
+        pthread_mutex_lock(&rli->data_lock);    // because of SHOW STATUS
+        rli->retried_trans++;
+        pthread_mutex_unlock(&rli->data_lock);
+
+        /* chance for concurrent connection to get more locks */
+        set_timespec(abstime, min(retries, MAX_SLAVE_RETRY_PAUSE));
+        pthread_mutex_lock(&lock);
+        old_msg= thd->enter_cond(&w->cond, &lock,
+                                 "Waiting to retry a transaction");
+        while (g->seq < abort_seq && !thd->killed &&
+               pthread_cond_timedwait(&w->cond, &lock, &abstime) != ETIMEDOUT)
+        {}
+        thd->exit_cond(old_msg);
+        goto retry;
+      }
+      report_error(w, g);
+      wrli->cleanup_context(thd, 1);
+      DBUG_RETURN(2);
+    }
+    w->stats->events++;
+    if (e->is_end)
+      break;
+    pthread_mutex_lock(&lock);
+    next= &e->next;
+  }
+
+  commit_group(w, g);
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Wait until all transactions before g have committed.  Called with the
+  pool lock held.  Returns FALSE if g must be rolled back instead.
+*/
+bool Rpl_parallel::wait_for_turn(RPL_PARALLEL_WORKER *w,
+                                 RPL_PARALLEL_GROUP *g)
+{
+  THD *thd= w->thd;
+  const char *old_msg;
+  ulonglong start;
+
+  if (committed_seq + 1 >= g->seq)
+    return TRUE;
+
+  w->stats->commit_waits++;
+  start= my_micro_time();
+  old_msg= thd->enter_cond(&commit_cond, &lock,
+                           "Waiting for preceding transactions to commit");
+  while (committed_seq + 1 < g->seq && g->seq < abort_seq && !thd->killed)
+    pthread_cond_wait(&commit_cond, &lock);
+  thd->exit_cond(old_msg);
+  w->stats->commit_wait_usecs+= my_micro_time() - start;
+  pthread_mutex_lock(&lock);
+  /* A killed worker fails in apply_group() */
+  return g->seq < abort_seq;
+}
+
+
+/*
+  Publish the positions of a committed transaction in the relay log info
+  of the SQL thread and let the next transaction commit.
+*/
+void Rpl_parallel::commit_group(RPL_PARALLEL_WORKER *w, RPL_PARALLEL_GROUP *g)
+{
+  Relay_log_info *wrli= w->rli;
+
+  pthread_mutex_lock(&rli->data_lock);
+  strmake(rli->group_relay_log_name, wrli->group_relay_log_name,
+          sizeof(rli->group_relay_log_name) - 1);
+  rli->notify_group_relay_log_name_update();
+  rli->group_relay_log_pos= wrli->group_relay_log_pos;
+  strmake(rli->group_master_log_name, wrli->group_master_log_name,
+          sizeof(rli->group_master_log_name) - 1);
+  rli->group_master_log_pos= wrli->group_master_log_pos;
+  rli->future_group_master_log_pos= wrli->future_group_master_log_pos;
+  if (wrli->last_master_timestamp)
+  {
+    rli->last_master_timestamp= wrli->last_master_timestamp;
+    rli->update_peak_lag(wrli->last_master_timestamp);
+  }
+  flush_relay_log_info(rli);
+  pthread_cond_broadcast(&rli->data_cond);
+  pthread_mutex_unlock(&rli->data_lock);
+
+  pthread_mutex_lock(&lock);
+  committed_seq= g->seq;
+  w->stats->trx++;
+  pthread_cond_broadcast(&commit_cond);
+  pthread_mutex_unlock(&lock);
+}
+
+
+/*
+  Stop the SQL thread with the error of a worker.  Transactions after the
+  failed one are rolled back.
+*/
+void Rpl_parallel::report_error(RPL_PARALLEL_WORKER *w, RPL_PARALLEL_GROUP *g)
+{
+  const Slave_reporting_capability::Error &err= w->rli->last_error();
+  uint err_code= err.number;
+  const char *msg= err.message;
+  char buf[22];
+
+  if (!err_code && w->thd->is_error())
+  {
+    err_code= w->thd->main_da.sql_errno();
+    msg= w->thd->main_da.message();
+  }
+  if (!rli->abort_slave && !abort_loop)
+    rli->report(ERROR_LEVEL, err_code,
+                "Slave worker %u failed applying the transaction at relay "
+                "log '%s' position %s: %s", w->id, g->relay_log_name,
+                llstr(g->relay_log_pos, buf),
+                err_code ? msg : "unknown error");
+
+  pthread_mutex_lock(&lock);
+  error= TRUE;
+  set_abort(g->seq);
+  pthread_cond_broadcast(&coordinator_cond);
+  pthread_mutex_unlock(&lock);
+}
+
+
+void Rpl_parallel::free_group(RPL_PARALLEL_GROUP *g)
+{
+  RPL_PARALLEL_EVENT *e, *next;
+  for (e= g->events; e; e= next)
+  {
+    next= e->next;
+    delete e->ev;
+    my_free(e, MYF(0));
+  }
+  my_free(g, MYF(0));
+}
+
+
+/*
+  Start the workers for the SQL thread if slave_parallel_workers is set.
+
+  Returns TRUE on failure.
+*/
+bool rpl_parallel_start(Relay_log_info *rli)
+{
+  uint n= (uint) min(slave_parallel_workers, SLAVE_PARALLEL_MAX_WORKERS);
+  if (n && !(rli->parallel= Rpl_parallel::start(rli, n)))
+  {
+    rli->report(ERROR_LEVEL, ER_SLAVE_FATAL_ERROR,
+                "Failed to start the slave worker threads");
+    return TRUE;
+  }
+  return FALSE;
+}
+
+
+void rpl_parallel_stop(Relay_log_info *rli)
+{
+  if (rli->parallel)
+  {
+    rli->parallel->stop();
+    rli->parallel= NULL;
+  }
+}
+
+
+int fill_slave_parallel_workers(THD *thd, TABLE_LIST *tables, COND *cond)
+{
+  TABLE *table= tables->table;
+  time_t now= my_time(0);
+  long clock_diff= active_mi ? active_mi->clock_diff_with_master : 0;
+  uint i;
+  DBUG_ENTER("fill_slave_parallel_workers");
+
+  for (i= 0; i < rpl_parallel_worker_count; i++)
+  {
+    RPL_PARALLEL_WORKER_STATS *stats= &rpl_parallel_worker_stats[i];
+    time_t oldest_when= stats->oldest_when;
+    longlong lag= 0;
+    uint f= 0;
+
+    if (oldest_when)
+      lag= max((longlong) (now - oldest_when) - clock_diff, 0);
+
+    restore_record(table, s->default_values);
+    table->field[f++]->store(i, TRUE);
+    table->field[f++]->store(stats->thread_id, TRUE);
+    table->field[f++]->store(stats->queued_trx, TRUE);
+    table->field[f++]->store(stats->queued_events, TRUE);
+    table->field[f++]->store(lag, TRUE);
+    table->field[f++]->store(stats->trx, TRUE);
+    table->field[f++]->store(stats->events, TRUE);
+    table->field[f++]->store(stats->retries, TRUE);
+    table->field[f++]->store(stats->commit_waits, TRUE);
+    table->field[f++]->store(stats->commit_wait_usecs, TRUE);
+    table->field[f++]->store(stats->queue_full_waits, TRUE);
+    if (schema_table_store_record(thd, table))
+      DBUG_RETURN(1);
+  }
+  DBUG_RETURN(0);
+}
+
+#endif /* HAVE_REPLICATION */
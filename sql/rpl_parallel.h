@@ -0,0 +1,202 @@
+#ifndef RPL_PARALLEL_H
+#define RPL_PARALLEL_H
+
+#ifdef HAVE_REPLICATION
+
+/*
+  Parallel apply of the relay log (slave_parallel_workers > 0)
+
+  The slave SQL thread becomes a coordinator.  It reads the relay log as
+  before and hands each row based transaction, BEGIN ... XID or COMMIT,
+  to one of slave_parallel_workers worker threads.  The worker is picked
+  by hashing the database of the first Table_map event, so transactions
+  on one database are applied in relay log order by one worker while
+  transactions on other databases run on other workers.
+
+  Each transaction gets a sequence number.  A worker waits for all
+  transactions with a lower number to commit before it applies the event
+  that ends its own.  Commits, and so the relay log positions stored in
+  relay-log.info and by rpl_transaction_enabled in the InnoDB system
+  header, always advance in relay log order and describe a prefix of the
+  relay log.
+
+  Everything else is applied by the coordinator itself once the workers
+  have committed all transactions handed out so far: statement based
+  transactions, DDL, Rotate and Format_description events and so on.  A
+  worker starts on a transaction when the coordinator has queued all of
+  it, or slave_parallel_queue_size events of it.  If the transaction
+  turns out not to be parallel safe (a Table_map for a database of
+  another worker, a statement event, a relay log switch) before that,
+  the coordinator takes it back and applies it itself.  Otherwise the
+  worker rolls it back and the coordinator re-reads it from its start,
+  as is done when a transaction is retried after a temporary error.
+
+  A worker retries a transaction on a temporary error up to
+  slave_transaction_retries times.  If a worker fails, transactions after
+  it are rolled back, those before it commit, and the SQL thread stops
+  with the error of the worker.  STOP SLAVE lets the workers finish the
+  transactions they have completely received.
+
+  INFORMATION_SCHEMA.SLAVE_PARALLEL_WORKERS has per worker queue, lag
+  and apply counters.
+*/
+
+#define SLAVE_PARALLEL_MAX_WORKERS 64
+
+class Log_event;
+class Relay_log_info;
+class Format_description_log_event;
+struct st_rpl_parallel_worker;
+
+/* An event of a transaction handed to a worker */
+typedef struct st_rpl_parallel_event
+{
+  Log_event *ev;
+  /* Relay log position after the event, it starts at the previous end */
+  my_off_t end_pos;
+  /* XID or COMMIT/ROLLBACK event that ends the transaction */
+  bool is_end;
+  struct st_rpl_parallel_event *next;
+} RPL_PARALLEL_EVENT;
+
+/* A transaction handed to a worker */
+typedef struct st_rpl_parallel_group
+{
+  ulonglong seq;
+  struct st_rpl_parallel_worker *worker;
+  /* Relay log name and position of the BEGIN event */
+  char relay_log_name[FN_REFLEN];
+  my_off_t relay_log_pos;
+  char master_log_name[FN_REFLEN];
+  my_off_t master_log_pos;
+  Format_description_log_event *description_event;
+  /* Master timestamp of the BEGIN event */
+  time_t when;
+  /* Events appended by the coordinator, protected by the pool lock */
+  RPL_PARALLEL_EVENT *events, **last_event;
+  uint n_events;
+  /* Events the worker has applied at least once */
+  uint n_applied;
+  /* The coordinator has appended the terminating event */
+  bool complete;
+  /* The worker has started to apply it */
+  bool started;
+  struct st_rpl_parallel_group *next;
+} RPL_PARALLEL_GROUP;
+
+/* Counters shown by INFORMATION_SCHEMA.SLAVE_PARALLEL_WORKERS */
+typedef struct st_rpl_parallel_worker_stats
+{
+  ulong thread_id;
+  ulong queued_trx;
+  ulong queued_events;
+  /* Master timestamp of the oldest queued transaction, 0 when idle */
+  time_t oldest_when;
+  ulonglong trx;
+  ulonglong events;
+  ulonglong retries;
+  ulonglong commit_waits;
+  ulonglong commit_wait_usecs;
+  ulonglong queue_full_waits;
+} RPL_PARALLEL_WORKER_STATS;
+
+typedef struct st_rpl_parallel_worker
+{
+  uint id;
+  class Rpl_parallel *pool;
+  THD *thd;
+  Relay_log_info *rli;
+  pthread_t thread;
+  /* Transactions queued for this worker, the first one is being applied */
+  RPL_PARALLEL_GROUP *queue, **queue_last;
+  /* Signalled when events are appended or the worker must exit */
+  pthread_cond_t cond;
+  bool running, exit;
+  RPL_PARALLEL_WORKER_STATS *stats;
+} RPL_PARALLEL_WORKER;
+
+
+class Rpl_parallel
+{
+public:
+  static Rpl_parallel *start(Relay_log_info *rli, uint n_workers);
+  void stop();
+
+  int schedule(Log_event *ev);
+  void run_worker(RPL_PARALLEL_WORKER *w);
+  void worker_ended(RPL_PARALLEL_WORKER *w);
+
+private:
+  Rpl_parallel(Relay_log_info *rli_arg);
+  ~Rpl_parallel();
+
+  /* Coordinator side */
+  RPL_PARALLEL_WORKER *pick_worker(Log_event *ev);
+  RPL_PARALLEL_GROUP *new_group(RPL_PARALLEL_WORKER *w);
+  bool append(RPL_PARALLEL_GROUP *g, Log_event *ev, my_off_t end_pos,
+              bool is_end);
+  int apply_here(Log_event *ev, my_off_t pos, my_off_t end_pos);
+  int apply_held_begin();
+  int abandon_group();
+  bool coordinator_wait(bool (Rpl_parallel::*done)(), const char *msg);
+  bool workers_idle();
+  bool queue_has_room();
+
+  /* Worker side */
+  int apply_group(RPL_PARALLEL_WORKER *w, RPL_PARALLEL_GROUP *g);
+  bool wait_for_turn(RPL_PARALLEL_WORKER *w, RPL_PARALLEL_GROUP *g);
+  void commit_group(RPL_PARALLEL_WORKER *w, RPL_PARALLEL_GROUP *g);
+  void report_error(RPL_PARALLEL_WORKER *w, RPL_PARALLEL_GROUP *g);
+  void set_abort(ulonglong seq);
+  void free_group(RPL_PARALLEL_GROUP *g);
+
+  Relay_log_info *rli;
+  RPL_PARALLEL_WORKER *workers;
+  uint n_workers;
+
+  /*
+    Protects the worker queues, the events of queued transactions and
+    the sequence numbers below.
+  */
+  pthread_mutex_t lock;
+  /* Signalled when a transaction commits or is rolled back */
+  pthread_cond_t commit_cond;
+  /* Signalled when the coordinator may have something to do */
+  pthread_cond_t coordinator_cond;
+
+  /* Sequence number of the last transaction handed out */
+  ulonglong last_seq;
+  /* All transactions up to this one have committed */
+  ulonglong committed_seq;
+  /* Transactions from this one on are rolled back */
+  ulonglong abort_seq;
+  /* A worker failed, the SQL thread must stop */
+  bool error;
+
+  /*
+    Transaction being read by the coordinator, if handed out.  Its worker
+    frees it when it is rolled back, so it may only be used with the pool
+    lock held and abort_seq unset.
+  */
+  RPL_PARALLEL_GROUP *cur_group;
+  /* Worker the coordinator waits for to make room in its queue */
+  RPL_PARALLEL_WORKER *full_worker;
+  /* BEGIN of the transaction being read, until its first Table_map */
+  Log_event *held_begin;
+  my_off_t held_begin_pos, held_begin_end_pos;
+  /*
+    Set after a partly applied transaction was rolled back, so that the
+    coordinator applies it itself when it reads it again.
+  */
+  bool force_serial;
+};
+
+extern RPL_PARALLEL_WORKER_STATS
+  rpl_parallel_worker_stats[SLAVE_PARALLEL_MAX_WORKERS];
+extern uint rpl_parallel_worker_count;
+
+bool rpl_parallel_start(Relay_log_info *rli);
+void rpl_parallel_stop(Relay_log_info *rli);
+
+#endif /* HAVE_REPLICATION */
+#endif /* RPL_PARALLEL_H */
@@ -45,7 +45,7 @@ Relay_log_info::Relay_log_info()
    slave_skip_counter(0),
    abort_pos_wait(0), slave_run_id(0), sql_thd(0),
    inited(0), abort_slave(0), slave_running(0), until_condition(UNTIL_NONE),
-   until_log_pos(0), retried_trans(0),
+   until_log_pos(0), retried_trans(0), parallel(0),
    tables_to_lock(0), tables_to_lock_count(0),
    last_event_start_time(0), m_flags(0)
 {
@@ -26,6 +26,7 @@
 
 struct RPL_TABLE_LIST;
 class Master_info;
+class Rpl_parallel;
 
 /****************************************************************************
 
@@ -284,6 +285,9 @@ public:
   */
   ulong trans_retries, retried_trans;
 
+  /* Worker threads of the SQL thread when slave_parallel_workers is set */
+  Rpl_parallel *parallel;
+
   /*
     If the end of the hot relay log is made of master's events ignored by the
     slave I/O thread, these two keep track of the coords (in the master's
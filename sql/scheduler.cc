@@ -86,3 +86,760 @@ void one_thread_per_connection_scheduler(scheduler_functions* func)
   func->end_thread= one_thread_per_connection_end;
 }
 #endif /* EMBEDDED_LIBRARY */
+
+
+#if HAVE_POOL_OF_THREADS == 1
+
+/*
+  Pool of threads, for --thread-handling=pool-of-threads
+
+  Connections are spread over thread_pool_size thread groups by their
+  thread id. Each group has an epoll set with the sockets of its idle
+  connections and a number of worker threads. One worker at a time is
+  the listener of the group: it waits on the epoll set and puts the
+  connections that got a request into the queue of the group. Workers
+  take a connection from the queue, execute one command for it and put
+  its socket back into the epoll set. The epoll registration is one-shot
+  so a connection is never handled by two workers at once.
+
+  Connections that are inside a transaction or hold LOCK TABLES are queued
+  in a separate queue that is served first, as finishing them releases
+  locks other connections may be waiting for.
+
+  A group lets at most thread_pool_oversubscribe + 1 workers execute
+  commands at the same time. Workers that block on IO or locks count as
+  active too, so a timer thread checks the groups every
+  thread_pool_stall_limit milliseconds: a group with queued connections
+  and no connection taken from its queue since the last check is stalled
+  and may wake or create workers beyond that limit, up to
+  thread_pool_max_threads. The timer thread also ends connections that
+  are idle for longer than their wait_timeout, which the sockets in the
+  epoll set can't detect on their own.
+
+  Workers waiting for work for longer than thread_pool_idle_timeout
+  seconds exit, except the last one of a group.
+*/
+
+#include <sys/epoll.h>
+
+/* thd_scheduler::state */
+enum tp_connection_state
+{
+  TP_CONNECTION_WAITING,                        /* Socket in the epoll set */
+  TP_CONNECTION_QUEUED,                         /* In a queue of the group */
+  TP_CONNECTION_RUNNING                         /* Handled by a worker */
+};
+
+/* Max number of events the listener takes from the epoll set at once */
+#define TP_MAX_EVENTS 16
+
+struct Connection_queue
+{
+  THD *first, *last;
+};
+
+struct Thread_group
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;                 /* Idle workers and tp_end() wait */
+  int pollfd;                          /* epoll set of waiting connections */
+  int wakeup_pipe[2];                  /* Interrupts the listener */
+  Connection_queue high_prio_queue;    /* Inside a transaction */
+  Connection_queue queue;
+  uint thread_count;                   /* Workers of the group */
+  uint idle_count;                     /* Workers waiting on cond */
+  uint active_count;                   /* Workers handling a connection */
+  ulong dequeue_count;                 /* Connections taken from the queues */
+  ulong last_dequeue_count;            /* dequeue_count at the last check */
+  bool listener;                       /* A worker waits on pollfd */
+  bool stalled;
+  bool shutdown;
+};
+
+static Thread_group *thread_groups;
+static uint thread_group_count;
+
+static pthread_mutex_t LOCK_tp_timer;
+static pthread_cond_t COND_tp_timer;
+static bool tp_timer_running, tp_timer_shutdown;
+
+
+thd_scheduler::thd_scheduler()
+  :group(0), next(0), thread_var(0), abs_wait_timeout(0),
+   state(TP_CONNECTION_RUNNING), logged_in(FALSE), in_poll_set(FALSE)
+{}
+
+
+static void queue_push(Connection_queue *queue, THD *thd)
+{
+  thd->scheduler.next= 0;
+  if (queue->last)
+    queue->last->scheduler.next= thd;
+  else
+    queue->first= thd;
+  queue->last= thd;
+}
+
+
+static THD *queue_pop(Connection_queue *queue)
+{
+  THD *thd;
+  if ((thd= queue->first))
+  {
+    if (!(queue->first= thd->scheduler.next))
+      queue->last= 0;
+    thd->scheduler.next= 0;
+  }
+  return thd;
+}
+
+
+static inline bool tp_queues_empty(Thread_group *group)
+{
+  return !group->high_prio_queue.first && !group->queue.first;
+}
+
+
+/*
+  Queue a connection that has a request to handle
+
+  NOTES
+    Called with group->mutex locked
+*/
+
+static void tp_enqueue(Thread_group *group, THD *thd)
+{
+  thd->scheduler.state= TP_CONNECTION_QUEUED;
+  if ((thd->server_status & SERVER_STATUS_IN_TRANS) || thd->locked_tables)
+    queue_push(&group->high_prio_queue, thd);
+  else
+    queue_push(&group->queue, thd);
+}
+
+
+static void tp_wake_listener(Thread_group *group)
+{
+  char c= 0;
+  if (write(group->wakeup_pipe[1], &c, 1) < 0)
+  {
+    /* The pipe is full, so the listener is woken up anyway */
+  }
+}
+
+
+pthread_handler_t tp_worker(void *arg);
+
+static bool tp_create_worker(Thread_group *group)
+{
+  pthread_t thread;
+  int error;
+  if ((error= pthread_create(&thread, &connection_attrib, tp_worker,
+                             (void*) group)))
+  {
+    sql_print_error("Can't create thread pool worker (errno= %d)", error);
+    return 1;
+  }
+  group->thread_count++;
+  return 0;
+}
+
+
+/*
+  Get a worker to handle the queued connections of a group
+
+  NOTES
+    Called with group->mutex locked
+*/
+
+static void tp_wake_or_create_worker(Thread_group *group)
+{
+  if (group->idle_count)
+    pthread_cond_signal(&group->cond);
+  else if ((group->active_count <= thread_pool_oversubscribe ||
+            group->stalled) &&
+           group->thread_count < thread_pool_max_threads &&
+           !tp_create_worker(group))
+    return;
+  else if (group->listener)
+    tp_wake_listener(group);
+}
+
+
+/*
+  Wait for requests on the idle connections of a group
+
+  NOTES
+    Called with group->mutex locked, which is released during the wait.
+*/
+
+static void tp_listen(Thread_group *group)
+{
+  struct epoll_event events[TP_MAX_EVENTS];
+  int count;
+
+  group->listener= TRUE;
+  pthread_mutex_unlock(&group->mutex);
+  count= epoll_wait(group->pollfd, events, TP_MAX_EVENTS, -1);
+  pthread_mutex_lock(&group->mutex);
+  group->listener= FALSE;
+
+  for (int i= 0; i < count; i++)
+  {
+    THD *thd= (THD*) events[i].data.ptr;
+    if (!thd)
+    {
+      char buff[TP_MAX_EVENTS];
+      while (read(group->wakeup_pipe[0], buff, sizeof(buff)) > 0)
+      {}
+      continue;
+    }
+    tp_enqueue(group, thd);
+  }
+}
+
+
+/*
+  Get the next connection to handle for a worker
+
+  RETURN
+    0    The worker should exit
+    #    Connection to handle
+*/
+
+static THD *tp_get_connection(Thread_group *group)
+{
+  THD *thd;
+  struct timespec abstime;
+  int error;
+
+  pthread_mutex_lock(&group->mutex);
+  for (;;)
+  {
+    if (group->shutdown)
+      break;
+    if (group->active_count <= thread_pool_oversubscribe || group->stalled)
+    {
+      if ((thd= queue_pop(&group->high_prio_queue)) ||
+          (thd= queue_pop(&group->queue)))
+      {
+        thd->scheduler.state= TP_CONNECTION_RUNNING;
+        group->active_count++;
+        group->dequeue_count++;
+        /*
+          Let another worker take the rest of the queue, or take over the
+          epoll set if this one was the listener
+        */
+        if (!tp_queues_empty(group) || !group->listener)
+          tp_wake_or_create_worker(group);
+        pthread_mutex_unlock(&group->mutex);
+        return thd;
+      }
+    }
+    if (!group->listener)
+    {
+      tp_listen(group);
+      continue;
+    }
+
+    group->idle_count++;
+    set_timespec(abstime, thread_pool_idle_timeout);
+    error= pthread_cond_timedwait(&group->cond, &group->mutex, &abstime);
+    group->idle_count--;
+    if ((error == ETIMEDOUT || error == ETIME) && group->thread_count > 1 &&
+        tp_queues_empty(group))
+      break;
+  }
+  group->thread_count--;
+  pthread_cond_broadcast(&group->cond);
+  pthread_mutex_unlock(&group->mutex);
+  return 0;
+}
+
+
+/*
+  Put the socket of a connection back into the epoll set of its group
+
+  RETURN
+    0    ok
+    1    error or killed, the connection should be ended
+*/
+
+static bool tp_wait_for_request(THD *thd)
+{
+  Thread_group *group= thd->scheduler.group;
+  struct epoll_event event;
+  bool error= 0;
+
+  thd->scheduler.abs_wait_timeout= (my_micro_time() +
+                                    (ulonglong) thd->variables.net_wait_timeout *
+                                    1000000);
+  event.events= EPOLLIN | EPOLLONESHOT;
+  event.data.ptr= thd;
+  /* Shown like a thread that waits in my_net_read() in the processlist */
+  thd->net.reading_or_writing= 1;
+
+  pthread_mutex_lock(&group->mutex);
+  /* A KILL after the last check found the connection running */
+  if (thd->killed == THD::KILL_CONNECTION ||
+      epoll_ctl(group->pollfd,
+                thd->scheduler.in_poll_set ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+                vio_fd(thd->net.vio), &event))
+    error= 1;
+  else
+  {
+    thd->scheduler.in_poll_set= TRUE;
+    thd->scheduler.state= TP_CONNECTION_WAITING;
+  }
+  pthread_mutex_unlock(&group->mutex);
+  return error;
+}
+
+
+static bool tp_has_buffered_request(THD *thd)
+{
+  NET *net= &thd->net;
+  Vio *vio= net->vio;
+
+  if (net->compress && net->remain_in_buf)
+    return TRUE;
+  if (vio->read_pos < vio->read_end)
+    return TRUE;
+#ifdef HAVE_OPENSSL
+  if (vio->type == VIO_TYPE_SSL && SSL_pending((SSL*) vio->ssl_arg))
+    return TRUE;
+#endif
+  return FALSE;
+}
+
+
+/*
+  Attach a connection to the current worker thread
+
+  NOTES
+    Each connection has its own mysys thread variables, created by the
+    first worker that handles it, so that the state kept there (like the
+    session debug settings and the id used by thr_lock) follows the
+    connection from worker to worker.
+
+  RETURN
+    0    ok
+    1    error, the connection uses the variables of the worker and
+         should be ended
+*/
+
+static bool tp_attach(THD *thd, st_my_thread_var *worker_var)
+{
+  st_my_thread_var *thread_var= thd->scheduler.thread_var;
+
+  set_mysys_var(thread_var);
+  if (thread_var)
+    thread_var->pthread_self= pthread_self();
+  else if (my_thread_init())
+    goto err;
+  if (thd->store_globals())
+    goto err;
+  thd->scheduler.thread_var= thd->mysys_var;
+  return 0;
+
+err:
+  set_mysys_var(worker_var);
+  thd->store_globals();
+  return 1;
+}
+
+
+/* Detach a connection from the worker thread until its next request */
+
+static void tp_detach(THD *thd, st_my_thread_var *worker_var)
+{
+  pthread_mutex_lock(&thd->LOCK_thd_data);
+  thd->mysys_var= 0;
+  pthread_mutex_unlock(&thd->LOCK_thd_data);
+  thd->restore_globals();
+  set_mysys_var(worker_var);
+}
+
+
+static void tp_end_connection(THD *thd, st_my_thread_var *worker_var)
+{
+  Thread_group *group= thd->scheduler.group;
+  bool own_thread_var= thd->mysys_var != worker_var;
+
+  if (thd->scheduler.in_poll_set)
+  {
+    pthread_mutex_lock(&group->mutex);
+    if (thd->net.vio)
+      epoll_ctl(group->pollfd, EPOLL_CTL_DEL, vio_fd(thd->net.vio), 0);
+    thd->scheduler.in_poll_set= FALSE;
+    pthread_mutex_unlock(&group->mutex);
+  }
+  if (thd->scheduler.logged_in)
+    end_connection(thd);
+  close_connection(thd, 0, 1);
+  unlink_thd(thd);
+  pthread_mutex_unlock(&LOCK_thread_count);
+  pthread_cond_broadcast(&COND_thread_count);
+  my_pthread_setspecific_ptr(THR_THD, 0);
+  my_pthread_setspecific_ptr(THR_MALLOC, 0);
+  if (own_thread_var)
+    my_thread_end();
+  set_mysys_var(worker_var);
+}
+
+
+/*
+  Handle one request of a connection in a worker thread
+
+  The first request of a connection is the login, later ones are
+  commands.
+*/
+
+static void tp_handle_connection(THD *thd, st_my_thread_var *worker_var)
+{
+  NET *net= &thd->net;
+  bool end= FALSE;
+
+  if (tp_attach(thd, worker_var) || thd->killed == THD::KILL_CONNECTION)
+    end= TRUE;
+  else if (!thd->scheduler.logged_in)
+  {
+    lex_start(thd);
+    if (login_connection(thd))
+      end= TRUE;
+    else
+    {
+      thd->scheduler.logged_in= TRUE;
+      prepare_new_connection_state(thd);
+    }
+  }
+  else
+  {
+    do
+      end= do_command(thd);
+    while (!end && !net->error && net->vio &&
+           thd->killed != THD::KILL_CONNECTION &&
+           tp_has_buffered_request(thd));
+  }
+
+  if (end || net->error || !net->vio ||
+      thd->killed == THD::KILL_CONNECTION)
+  {
+    tp_end_connection(thd, worker_var);
+    return;
+  }
+
+  tp_detach(thd, worker_var);
+  if (tp_wait_for_request(thd))
+  {
+    tp_attach(thd, worker_var);
+    tp_end_connection(thd, worker_var);
+  }
+}
+
+
+pthread_handler_t tp_worker(void *arg)
+{
+  Thread_group *group= (Thread_group*) arg;
+  st_my_thread_var *worker_var;
+  THD *thd;
+
+  if (init_new_connection_handler_thread())
+  {
+    pthread_mutex_lock(&group->mutex);
+    group->thread_count--;
+    pthread_cond_broadcast(&group->cond);
+    pthread_mutex_unlock(&group->mutex);
+    return 0;
+  }
+  worker_var= my_thread_var;
+
+  while ((thd= tp_get_connection(group)))
+  {
+    thd->thread_stack= (char*) &thd;
+    tp_handle_connection(thd, worker_var);
+    pthread_mutex_lock(&group->mutex);
+    group->active_count--;
+    pthread_mutex_unlock(&group->mutex);
+  }
+
+  my_thread_end();
+  return 0;
+}
+
+
+/*
+  Check that a group makes progress
+
+  NOTES
+    A group whose workers are all blocked has connections in its queue, or
+    no listener for its epoll set, and took nothing from its queue since
+    the last check. Waking or creating a worker also gets the group a new
+    listener.
+*/
+
+static void tp_check_stall(Thread_group *group)
+{
+  pthread_mutex_lock(&group->mutex);
+  if ((!tp_queues_empty(group) || !group->listener) &&
+      group->dequeue_count == group->last_dequeue_count)
+  {
+    group->stalled= TRUE;
+    tp_wake_or_create_worker(group);
+  }
+  else
+    group->stalled= FALSE;
+  group->last_dequeue_count= group->dequeue_count;
+  pthread_mutex_unlock(&group->mutex);
+}
+
+
+/* End connections that are idle for longer than their wait_timeout */
+
+static void tp_timeout_idle_connections()
+{
+  ulonglong now= my_micro_time();
+  THD *thd;
+
+  pthread_mutex_lock(&LOCK_thread_count);
+  I_List_iterator<THD> it(threads);
+  while ((thd= it++))
+  {
+    if (thd->scheduler.group &&
+        thd->scheduler.state == TP_CONNECTION_WAITING &&
+        thd->scheduler.abs_wait_timeout < now)
+    {
+      pthread_mutex_lock(&thd->LOCK_thd_data);
+      thd->awake(THD::KILL_CONNECTION);
+      pthread_mutex_unlock(&thd->LOCK_thd_data);
+    }
+  }
+  pthread_mutex_unlock(&LOCK_thread_count);
+}
+
+
+pthread_handler_t tp_timer(void *arg __attribute__((unused)))
+{
+  struct timespec abstime;
+  ulonglong next_timeout_check= 0;
+
+  my_thread_init();
+  pthread_mutex_lock(&LOCK_tp_timer);
+  while (!tp_timer_shutdown)
+  {
+    set_timespec_nsec(abstime, thread_pool_stall_limit * 1000000ULL);
+    pthread_cond_timedwait(&COND_tp_timer, &LOCK_tp_timer, &abstime);
+    if (tp_timer_shutdown)
+      break;
+    pthread_mutex_unlock(&LOCK_tp_timer);
+
+    for (uint i= 0; i < thread_group_count; i++)
+      tp_check_stall(thread_groups + i);
+    if (my_micro_time() >= next_timeout_check)
+    {
+      tp_timeout_idle_connections();
+      next_timeout_check= my_micro_time() + 1000000;
+    }
+
+    pthread_mutex_lock(&LOCK_tp_timer);
+  }
+  tp_timer_running= FALSE;
+  pthread_cond_signal(&COND_tp_timer);
+  pthread_mutex_unlock(&LOCK_tp_timer);
+  my_thread_end();
+  return 0;
+}
+
+
+static void tp_end_group(Thread_group *group)
+{
+  if (group->pollfd >= 0)
+    close(group->pollfd);
+  if (group->wakeup_pipe[0] >= 0)
+    close(group->wakeup_pipe[0]);
+  if (group->wakeup_pipe[1] >= 0)
+    close(group->wakeup_pipe[1]);
+  pthread_mutex_destroy(&group->mutex);
+  pthread_cond_destroy(&group->cond);
+}
+
+
+static bool tp_init_group(Thread_group *group)
+{
+  struct epoll_event event;
+
+  bzero((char*) group, sizeof(*group));
+  pthread_mutex_init(&group->mutex, MY_MUTEX_INIT_FAST);
+  pthread_cond_init(&group->cond, NULL);
+  group->wakeup_pipe[0]= group->wakeup_pipe[1]= -1;
+  if ((group->pollfd= epoll_create(1024)) < 0 ||
+      pipe(group->wakeup_pipe) ||
+      fcntl(group->wakeup_pipe[0], F_SETFL, O_NONBLOCK) ||
+      fcntl(group->wakeup_pipe[1], F_SETFL, O_NONBLOCK))
+    return 1;
+  event.events= EPOLLIN;
+  event.data.ptr= 0;
+  return epoll_ctl(group->pollfd, EPOLL_CTL_ADD, group->wakeup_pipe[0],
+                   &event) != 0;
+}
+
+
+static void tp_end(void)
+{
+  DBUG_ENTER("tp_end");
+  if (!thread_groups)
+    DBUG_VOID_RETURN;
+
+  pthread_mutex_lock(&LOCK_tp_timer);
+  tp_timer_shutdown= TRUE;
+  pthread_cond_signal(&COND_tp_timer);
+  while (tp_timer_running)
+    pthread_cond_wait(&COND_tp_timer, &LOCK_tp_timer);
+  pthread_mutex_unlock(&LOCK_tp_timer);
+
+  for (uint i= 0; i < thread_group_count; i++)
+  {
+    Thread_group *group= thread_groups + i;
+    pthread_mutex_lock(&group->mutex);
+    group->shutdown= TRUE;
+    pthread_cond_broadcast(&group->cond);
+    if (group->listener)
+      tp_wake_listener(group);
+    while (group->thread_count)
+      pthread_cond_wait(&group->cond, &group->mutex);
+    pthread_mutex_unlock(&group->mutex);
+    tp_end_group(group);
+  }
+  my_free((uchar*) thread_groups, MYF(0));
+  thread_groups= 0;
+  thread_group_count= 0;
+  pthread_mutex_destroy(&LOCK_tp_timer);
+  pthread_cond_destroy(&COND_tp_timer);
+  DBUG_VOID_RETURN;
+}
+
+
+static bool tp_init(void)
+{
+  pthread_t thread;
+  int error;
+  DBUG_ENTER("tp_init");
+
+  if (!(thread_groups= (Thread_group*) my_malloc(sizeof(Thread_group) *
+                                                 thread_pool_size,
+                                                 MYF(MY_WME))))
+    DBUG_RETURN(1);
+  for (thread_group_count= 0; thread_group_count < thread_pool_size;
+       thread_group_count++)
+  {
+    if (tp_init_group(thread_groups + thread_group_count))
+    {
+      sql_print_error("Can't initialize thread pool group (errno= %d)",
+                      errno);
+      tp_end_group(thread_groups + thread_group_count);
+      goto err;
+    }
+  }
+
+  pthread_mutex_init(&LOCK_tp_timer, MY_MUTEX_INIT_FAST);
+  pthread_cond_init(&COND_tp_timer, NULL);
+  tp_timer_running= TRUE;
+  tp_timer_shutdown= FALSE;
+  if ((error= pthread_create(&thread, &connection_attrib, tp_timer, 0)))
+  {
+    sql_print_error("Can't create thread pool timer (errno= %d)", error);
+    tp_timer_running= FALSE;
+    goto err_timer;
+  }
+  DBUG_RETURN(0);
+
+err_timer:
+  pthread_mutex_destroy(&LOCK_tp_timer);
+  pthread_cond_destroy(&COND_tp_timer);
+err:
+  while (thread_group_count)
+    tp_end_group(thread_groups + --thread_group_count);
+  my_free((uchar*) thread_groups, MYF(0));
+  thread_groups= 0;
+  DBUG_RETURN(1);
+}
+
+
+/*
+  Add a new connection to the pool
+
+  NOTES
+    Called with LOCK_thread_count locked, which is released here.
+    The login is done by a worker like any other request.
+*/
+
+static void tp_add_connection(THD *thd)
+{
+  Thread_group *group= thread_groups + thd->thread_id % thread_group_count;
+
+  threads.append(thd);
+  thd->thr_create_utime= thd->start_utime= my_micro_time();
+  thd->scheduler.group= group;
+  pthread_mutex_unlock(&LOCK_thread_count);
+
+  pthread_mutex_lock(&group->mutex);
+  tp_enqueue(group, thd);
+  tp_wake_or_create_worker(group);
+  pthread_mutex_unlock(&group->mutex);
+}
+
+
+/*
+  Make sure a killed connection gets handled so it can end
+
+  NOTES
+    Called with thd->LOCK_thd_data locked. A connection that is handled
+    by a worker notices the kill itself. For an idle one, shutting down
+    the reading side of its socket makes it show up in the epoll set; it
+    is not queued from here as the listener may hold an event for it that
+    it didn't look at yet.
+*/
+
+static void tp_post_kill_notification(THD *thd)
+{
+  Thread_group *group= thd->scheduler.group;
+  if (!group)
+    return;
+
+  pthread_mutex_lock(&group->mutex);
+  if (thd->scheduler.state == TP_CONNECTION_WAITING && thd->net.vio)
+    shutdown(vio_fd(thd->net.vio), SHUT_RD);
+  pthread_mutex_unlock(&group->mutex);
+}
+
+
+/* Number of workers of the pool, for the Threadpool_* status variables */
+
+uint pool_of_threads_thread_count(bool only_idle)
+{
+  uint count= 0;
+  for (uint i= 0; i < thread_group_count; i++)
+  {
+    Thread_group *group= thread_groups + i;
+    pthread_mutex_lock(&group->mutex);
+    count+= only_idle ? group->idle_count : group->thread_count;
+    pthread_mutex_unlock(&group->mutex);
+  }
+  return count;
+}
+
+
+/*
+  Initialize scheduler for --thread-handling=pool-of-threads
+*/
+
+void pool_of_threads_scheduler(scheduler_functions* func)
+{
+  func->max_threads= thread_pool_size * thread_pool_max_threads;
+  func->init= tp_init;
+  func->init_new_connection_thread= init_new_connection_handler_thread;
+  func->add_connection= tp_add_connection;
+  func->post_kill_notification= tp_post_kill_notification;
+  func->end= tp_end;
+}
+
+#endif /* HAVE_POOL_OF_THREADS == 1 */
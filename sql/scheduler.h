@@ -53,8 +53,37 @@ enum pool_command_op
   NOT_IN_USE_OP= 0, NORMAL_OP= 1, CONNECT_OP, KILL_OP, DIE_OP
 };
 
+#if defined(HAVE_SYS_EPOLL_H) && !defined(EMBEDDED_LIBRARY)
+
+#define HAVE_POOL_OF_THREADS 1
+
+struct Thread_group;
+
+/* Per connection state of the pool of threads, see scheduler.cc */
+
+class thd_scheduler
+{
+public:
+  Thread_group *group;                  /* 0 if not handled by the pool */
+  THD *next;                            /* Next in the queue of the group */
+  st_my_thread_var *thread_var;         /* mysys variables of the connection */
+  ulonglong abs_wait_timeout;           /* When an idle connection ends */
+  uint state;
+  bool logged_in;                       /* Authentication is done */
+  bool in_poll_set;                     /* Socket is in the epoll set */
+
+  thd_scheduler();
+};
+
+void pool_of_threads_scheduler(scheduler_functions* func);
+uint pool_of_threads_thread_count(bool only_idle);
+
+#else
+
 #define HAVE_POOL_OF_THREADS 0                  /* For easyer tests */
 #define pool_of_threads_scheduler(A) one_thread_per_connection_scheduler(A)
 
 class thd_scheduler
 {};
+
+#endif
@@ -134,6 +134,7 @@ static void fix_net_retry_count(THD *thd, enum_var_type type);
 static void fix_max_join_size(THD *thd, enum_var_type type);
 #ifdef HAVE_QUERY_CACHE
 static void fix_query_cache_size(THD *thd, enum_var_type type);
+static void fix_query_cache_limit(THD *thd, enum_var_type type);
 static int check_query_cache_type(THD *thd, set_var *var);
 static void fix_query_cache_min_res_unit(THD *thd, enum_var_type type);
 static void fix_query_cache_skip_leading_comment(THD *thd, enum_var_type type);
@@ -161,6 +162,10 @@ static void sys_default_slow_log_path(THD *thd, enum_var_type type);
 static uchar *get_myisam_mmap_size(THD *thd);
 static int check_max_allowed_packet(THD *thd,  set_var *var);
 static int check_net_buffer_length(THD *thd,  set_var *var);
+static int  sys_check_admission_control_db_weights(THD *thd, set_var *var);
+static bool sys_update_admission_control_db_weights(THD *thd, set_var *var);
+static void sys_default_admission_control_db_weights(THD *thd,
+                                                     enum_var_type type);
 
 /*
   Variable definition list
@@ -614,7 +619,13 @@ static sys_var_bool_ptr sys_query_cache_skip_leading_comment(&vars,
 				 &query_cache_skip_leading_comment,
                                  fix_query_cache_skip_leading_comment);
 static sys_var_long_ptr	sys_query_cache_limit(&vars, "query_cache_limit",
-					      &query_cache.query_cache_limit);
+					      &query_cache.query_cache_limit,
+					      fix_query_cache_limit);
+static sys_var_const    sys_query_cache_partitions(&vars,
+                                                   "query_cache_partitions",
+                                                   OPT_GLOBAL, SHOW_LONG,
+                                                   (uchar*)
+                                                   &query_cache_partitions);
 static sys_var_long_ptr        sys_query_cache_min_res_unit(&vars, "query_cache_min_res_unit",
 						     &query_cache_min_res_unit,
 						     fix_query_cache_min_res_unit);
@@ -641,6 +652,8 @@ static sys_var_long_ptr	sys_slow_launch_time(&vars, "slow_launch_time",
 					     &slow_launch_time);
 static sys_var_thd_ulong	sys_sort_buffer(&vars, "sort_buffer_size",
 					&SV::sortbuff_size);
+static sys_var_thd_ulong	sys_sort_threads(&vars, "sort_threads",
+					 &SV::sort_threads);
 
 static sys_var_bool_ptr sys_rpl_transaction_enabled(&vars, "rpl_transaction_enabled",
                                                     &rpl_transaction_enabled);
@@ -695,8 +708,15 @@ static sys_var_long_ptr	sys_table_def_size(&vars, "table_definition_cache",
                                            &table_def_size);
 static sys_var_long_ptr	sys_table_cache_size(&vars, "table_open_cache",
 					     &table_cache_size);
+static sys_var_const    sys_table_cache_instances(&vars,
+                                                  "table_open_cache_instances",
+                                                  OPT_GLOBAL, SHOW_LONG,
+                                                  (uchar*)
+                                                  &table_cache_instances);
 static sys_var_long_ptr	sys_table_lock_wait_timeout(&vars, "table_lock_wait_timeout",
                                                     &table_lock_wait_timeout);
+static sys_var_bool_ptr	sys_table_lock_fast_path(&vars, "table_lock_fast_path",
+                                                 &table_lock_fast_path);
 
 #if defined(ENABLED_DEBUG_SYNC)
 /* Debug Sync Facility. Implemented in debug_sync.cc. */
@@ -706,8 +726,21 @@ static sys_var_debug_sync sys_debug_sync(&vars, "debug_sync");
 static sys_var_long_ptr	sys_thread_cache_size(&vars, "thread_cache_size",
 					      &thread_cache_size);
 #if HAVE_POOL_OF_THREADS == 1
-sys_var_long_ptr	sys_thread_pool_size(&vars, "thread_pool_size",
-					      &thread_pool_size);
+static sys_var_long_ptr	sys_thread_pool_idle_timeout(&vars,
+                                                     "thread_pool_idle_timeout",
+                                                     &thread_pool_idle_timeout);
+static sys_var_long_ptr	sys_thread_pool_max_threads(&vars,
+                                                    "thread_pool_max_threads",
+                                                    &thread_pool_max_threads);
+static sys_var_long_ptr	sys_thread_pool_oversubscribe(&vars,
+                                                      "thread_pool_oversubscribe",
+                                                      &thread_pool_oversubscribe);
+static sys_var_const    sys_thread_pool_size(&vars, "thread_pool_size",
+                                             OPT_GLOBAL, SHOW_LONG,
+                                             (uchar*) &thread_pool_size);
+static sys_var_long_ptr	sys_thread_pool_stall_limit(&vars,
+                                                    "thread_pool_stall_limit",
+                                                    &thread_pool_stall_limit);
 #endif
 static sys_var_thd_enum	sys_tx_isolation(&vars, "tx_isolation",
 					 &SV::tx_isolation,
@@ -1050,6 +1083,22 @@ sys_admission_control_diskio(&vars, "admission_control_diskio",
 static sys_var_bool_ptr
 sys_admission_control_wait_reentry(&vars, "admission_control_wait_reentry",
                                    &admission_control_wait_reentry);
+static sys_var_long_ptr
+sys_admission_control_db_max_running(&vars, "admission_control_db_max_running",
+                                     &admission_control_db_max_running);
+static sys_var_long_ptr
+sys_admission_control_db_max_queued(&vars, "admission_control_db_max_queued",
+                                    &admission_control_db_max_queued);
+static sys_var_long_ptr
+sys_admission_control_db_total_running(&vars,
+                                       "admission_control_db_total_running",
+                                       &admission_control_db_total_running);
+static sys_var_str
+sys_admission_control_db_weights(&vars, "admission_control_db_weights",
+                                 sys_check_admission_control_db_weights,
+                                 sys_update_admission_control_db_weights,
+                                 sys_default_admission_control_db_weights,
+                                 admission_control_db_weights);
 static sys_var_bool_ptr
 sys_allow_hint_to_missing_index(&vars, "allow_hint_to_missing_index",
                                 &allow_hint_to_missing_index);
@@ -1140,6 +1189,37 @@ static void sys_default_init_slave(THD* thd, enum_var_type type)
   update_sys_var_str(&sys_init_slave, &LOCK_sys_init_slave, 0);
 }
 
+static int sys_check_admission_control_db_weights(THD *thd, set_var *var)
+{
+  char buff[STRING_BUFFER_USUAL_SIZE];
+  String str(buff, sizeof(buff), system_charset_info), *res;
+
+  if (!(res= var->value->val_str(&str)) ||
+      admission_pools_check_weights(res->c_ptr_safe()))
+    return -1;
+  return 0;
+}
+
+static bool sys_update_admission_control_db_weights(THD *thd, set_var *var)
+{
+  char buff[STRING_BUFFER_USUAL_SIZE];
+  String str(buff, sizeof(buff), system_charset_info), *res;
+
+  if (!(res= var->value->val_str(&str)))
+    return 1;
+  strmake(admission_control_db_weights, res->c_ptr_safe(),
+          sizeof(admission_control_db_weights) - 1);
+  admission_pools_set_weights(admission_control_db_weights);
+  return 0;
+}
+
+static void sys_default_admission_control_db_weights(THD *thd,
+                                                     enum_var_type type)
+{
+  admission_control_db_weights[0]= 0;
+  admission_pools_set_weights(admission_control_db_weights);
+}
+
 static int sys_check_ftb_syntax(THD *thd,  set_var *var)
 {
   if (thd->security_ctx->master_access & SUPER_ACL)
@@ -1381,6 +1461,11 @@ static int check_query_cache_type(THD *thd, set_var *var)
   return 0;
 }
 
+static void fix_query_cache_limit(THD *thd, enum_var_type type)
+{
+  query_cache.result_size_limit(query_cache.query_cache_limit);
+}
+
 static void fix_query_cache_min_res_unit(THD *thd, enum_var_type type)
 {
   query_cache_min_res_unit= 
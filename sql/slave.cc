@@ -36,6 +36,7 @@
 #include "sql_repl.h"
 #include "rpl_filter.h"
 #include "repl_failsafe.h"
+#include "rpl_parallel.h"
 #include <thr_alarm.h>
 #include <my_dir.h>
 #include <sql_common.h>
@@ -97,7 +98,6 @@ is written to the relay log by the IO thread to signal the shutdown.
 
 #define FLAGSTR(V,F) ((V)&(F)?#F" ":"")
 
-#define MAX_SLAVE_RETRY_PAUSE 5
 bool use_slave_mask = 0;
 MY_BITMAP slave_error_mask;
 char slave_skip_error_names[SHOW_VAR_FUNC_BUFF_SIZE];
@@ -209,14 +209,12 @@ failed read"
 };
  
 
-typedef enum { SLAVE_THD_IO, SLAVE_THD_SQL} SLAVE_THD_TYPE;
 
 static int process_io_rotate(Master_info* mi, Rotate_log_event* rev);
 static int process_io_create_file(Master_info* mi, Create_file_log_event* cev);
 static bool wait_for_relay_log_space(Relay_log_info* rli);
 static inline bool io_slave_killed(THD* thd,Master_info* mi);
 static inline bool sql_slave_killed(THD* thd,Relay_log_info* rli);
-static int init_slave_thread(THD* thd, SLAVE_THD_TYPE thd_type);
 static void print_slave_skip_errors(void);
 static int safe_connect(THD* thd, MYSQL* mysql, Master_info* mi);
 static int safe_reconnect(THD* thd, MYSQL* mysql, Master_info* mi,
@@ -1964,7 +1962,7 @@ void set_slave_thread_default_charset(THD* thd, Relay_log_info const *rli)
   init_slave_thread()
 */
 
-static int init_slave_thread(THD* thd, SLAVE_THD_TYPE thd_type)
+int init_slave_thread(THD* thd, SLAVE_THD_TYPE thd_type)
 {
   DBUG_ENTER("init_slave_thread");
 #if !defined(DBUG_OFF)
@@ -2191,7 +2189,7 @@ static ulong read_event(MYSQL* mysql, Master_info *mi, bool* suppress_warnings)
   that the error is temporary by pushing a warning with the error code
   ER_GET_TEMPORARY_ERRMSG, if the originating error is temporary.
 */
-static int has_temporary_error(THD *thd)
+int has_temporary_error(THD *thd)
 {
   DBUG_ENTER("has_temporary_error");
 
@@ -2523,6 +2521,9 @@ static int exec_relay_log_event(THD* thd, Relay_log_info* rli)
       delete ev;
       DBUG_RETURN(1);
     }
+    if (rli->parallel &&
+        (exec_res= rli->parallel->schedule(ev)) >= 0)
+      DBUG_RETURN(exec_res);
     exec_res= apply_event_and_update_pos(ev, thd, rli);
 
     /*
@@ -3311,6 +3312,9 @@ log '%s' at position %s and %s, relay log '%s' position: %s", RPL_LOG_NAME,
   }
   pthread_mutex_unlock(&rli->data_lock);
 
+  if (rpl_parallel_start(rli))
+    goto err;
+
   /* Read queries from the IO/THREAD until this thread is killed */
 
   while (!sql_slave_killed(thd,rli))
@@ -3405,11 +3409,14 @@ the slave SQL thread with \"SLAVE START\". We stopped at log \
   }
 
   /* Thread stopped. Print the current replication position to the log */
+  rpl_parallel_stop(rli);
   sql_print_information("Slave SQL thread exiting, replication stopped in log "
                         "'%s' at position %s",
                         RPL_LOG_NAME, llstr(rli->group_master_log_pos,llbuff));
 
  err:
+  /* Let the workers commit what they have received before the state is saved */
+  rpl_parallel_stop(rli);
 
 #ifdef HAVE_INNODB_BINLOG
   /*
@@ -35,6 +35,8 @@
 
 #define MAX_SLAVE_ERROR    2000
 
+#define MAX_SLAVE_RETRY_PAUSE 5
+
 
 // Forward declarations
 class Relay_log_info;
@@ -145,6 +147,7 @@ extern my_bool opt_respect_no_slave_exec;
 #define RPL_SKIP_FILTER_ON_SLAVE 1
 #define RPL_SKIP_FILTER_ON_MASTER 2
 
+typedef enum { SLAVE_THD_IO, SLAVE_THD_SQL} SLAVE_THD_TYPE;
 
 int init_slave();
 void init_slave_skip_errors(const char* arg);
@@ -205,6 +208,8 @@ void set_slave_thread_options(THD* thd);
 void set_slave_thread_default_charset(THD *thd, Relay_log_info const *rli);
 int rotate_relay_log(Master_info* mi);
 int apply_event_and_update_pos(Log_event* ev, THD* thd, Relay_log_info* rli);
+int init_slave_thread(THD* thd, SLAVE_THD_TYPE thd_type);
+int has_temporary_error(THD *thd);
 
 pthread_handler_t handle_slave_io(void *arg);
 pthread_handler_t handle_slave_sql(void *arg);
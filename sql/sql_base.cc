@@ -127,8 +127,61 @@ extern "C" uchar *table_cache_key(const uchar *record, size_t *length,
 }
 
 
+/*
+  Table cache instances
+
+  A thread that closes a table which is still current parks the TABLE in
+  the table cache instance of the thread instead of moving it to
+  unused_tables, and open_table() looks there first. Both only take the
+  mutex of the instance, so reopening the tables of a short statement does
+  not touch LOCK_open.
+
+  A parked table stays in open_cache with TABLE::in_use set to
+  TABLE_CACHE_PARKED, so code running under LOCK_open sees it as used by
+  somebody. Tables are only parked while table->s->version and
+  thd->version are equal to refresh_version, and these only change under
+  LOCK_open. Code that makes tables old under LOCK_open and then waits for
+  them to be closed calls table_cache_unpark() first, which closes the old
+  parked tables and returns the others to unused_tables. The lock order is
+  LOCK_open, then the instance mutex.
+
+  The instance mutex also protects THD::open_tables of the threads that use
+  the instance against remove_table_from_cache() and
+  mysql_wait_completed_table(), which walk the list of another thread.
+*/
+
+typedef struct st_table_cache_instance
+{
+  pthread_mutex_t lock;
+  HASH cache;                                   /* Parked tables */
+} TABLE_CACHE_INSTANCE;
+
+static TABLE_CACHE_INSTANCE *table_cache_instance;
+static uint table_cache_instance_count;
+
+
+static inline TABLE_CACHE_INSTANCE *table_cache_instance_of(THD *thd)
+{
+  return table_cache_instance + thd->thread_id % table_cache_instance_count;
+}
+
+
 bool table_cache_init(void)
 {
+  table_cache_instance_count= (uint) table_cache_instances;
+  if (!(table_cache_instance= (TABLE_CACHE_INSTANCE*)
+        my_malloc(sizeof(TABLE_CACHE_INSTANCE) * table_cache_instance_count,
+                  MYF(MY_WME | MY_ZEROFILL))))
+    return TRUE;
+  for (uint i= 0; i < table_cache_instance_count; i++)
+  {
+    TABLE_CACHE_INSTANCE *instance= table_cache_instance + i;
+    pthread_mutex_init(&instance->lock, MY_MUTEX_INIT_FAST);
+    if (hash_init(&instance->cache, &my_charset_bin,
+                  table_cache_size / table_cache_instance_count + 16,
+                  0, 0, table_cache_key, 0, 0))
+      return TRUE;
+  }
   return hash_init(&open_cache, &my_charset_bin, table_cache_size+16,
 		   0, 0, table_cache_key,
 		   (hash_free_key) free_cache_entry, 0) != 0;
@@ -143,9 +196,204 @@ void table_cache_free(void)
     if (!open_cache.records)			// Safety first
       hash_free(&open_cache);
   }
+  if (table_cache_instance)
+  {
+    for (uint i= 0; i < table_cache_instance_count; i++)
+    {
+      hash_free(&table_cache_instance[i].cache);
+      pthread_mutex_destroy(&table_cache_instance[i].lock);
+    }
+    my_free((uchar*) table_cache_instance, MYF(0));
+    table_cache_instance= 0;
+  }
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Move a table to the end of unused_tables
+
+  NOTE
+    We need to have a lock on LOCK_open when calling this
+*/
+
+static void link_unused(TABLE *table)
+{
+  table->in_use=0;
+  if (unused_tables)
+  {
+    table->next=unused_tables;			/* Link in last */
+    table->prev=unused_tables->prev;
+    unused_tables->prev=table;
+    table->prev->next=table;
+  }
+  else
+    unused_tables=table->next=table->prev=table;
+}
+
+
+/*
+  Take tables out of the table cache instances
+
+  SYNOPSIS
+    table_cache_unpark()
+    key			Cache key of the table, or NULL for all tables
+    key_length		Length of key
+
+  NOTES
+    Parked tables of an old version are closed, the others are moved to
+    unused_tables. Tables that are old when this is called can't be parked
+    again, so after this the callers can wait for them in open_cache.
+
+    We need to have a lock on LOCK_open when calling this
+*/
+
+static void table_cache_unpark(const char *key, uint key_length)
+{
+  bool found_old_table= 0;
+  DBUG_ENTER("table_cache_unpark");
+  safe_mutex_assert_owner(&LOCK_open);
+
+  for (uint i= 0; i < table_cache_instance_count; i++)
+  {
+    TABLE_CACHE_INSTANCE *instance= table_cache_instance + i;
+    TABLE *table;
+    pthread_mutex_lock(&instance->lock);
+    while (instance->cache.records)
+    {
+      if (key)
+      {
+        if (!(table= (TABLE*) hash_search(&instance->cache, (uchar*) key,
+                                          key_length)))
+          break;
+      }
+      else
+        table= (TABLE*) hash_element(&instance->cache, 0);
+      VOID(hash_delete(&instance->cache, (uchar*) table));
+      DBUG_PRINT("tcache", ("unparked table: '%s'.'%s' 0x%lx",
+                            table->s->db.str, table->s->table_name.str,
+                            (long) table));
+      link_unused(table);
+      if (table->needs_reopen_or_name_lock())
+      {
+        VOID(hash_delete(&open_cache, (uchar*) table));
+        found_old_table= 1;
+      }
+    }
+    pthread_mutex_unlock(&instance->lock);
+  }
+  if (found_old_table)
+    broadcast_refresh();
   DBUG_VOID_RETURN;
 }
 
+
+/*
+  Mark a table as old and take its parked instances out of the table cache
+  instances, so that no thread can park or reuse it any more
+
+  NOTES
+    We need to have a lock on LOCK_open when calling this
+*/
+
+static void table_cache_retire(const char *key, uint key_length)
+{
+  TABLE_SHARE *share;
+  if ((share= (TABLE_SHARE*) hash_search(&table_def_cache, (uchar*) key,
+                                         key_length)))
+    share->version= 0;
+  table_cache_unpark(key, key_length);
+}
+
+
+/*
+  Park the tables of a thread in its table cache instance
+
+  SYNOPSIS
+    table_cache_park()
+    thd			Thread context
+
+  NOTES
+    Called without LOCK_open. Tables that can't be parked are left in
+    thd->open_tables for close_thread_table().
+
+  RETURN
+    TRUE   All tables were parked
+    FALSE  Some tables are still open
+*/
+
+static bool table_cache_park(THD *thd)
+{
+  TABLE_CACHE_INSTANCE *instance= table_cache_instance_of(thd);
+  TABLE **prev= &thd->open_tables, *table;
+  ulong max_records= table_cache_size / table_cache_instance_count;
+
+  pthread_mutex_lock(&instance->lock);
+  while ((table= *prev))
+  {
+    DBUG_ASSERT(table->key_read == 0);
+    DBUG_ASSERT(!table->file || table->file->inited == handler::NONE);
+    if (thd->version != refresh_version ||
+        table->needs_reopen_or_name_lock() || !table->db_stat ||
+        table->child_l || table->parent ||
+        instance->cache.records >= max_records)
+    {
+      prev= &table->next;
+      continue;
+    }
+    free_field_buffers_larger_than(table,MAX_TDC_BLOB_SIZE);
+    table->file->ha_reset();
+    if (my_hash_insert(&instance->cache, (uchar*) table))
+    {
+      prev= &table->next;
+      continue;
+    }
+    DBUG_PRINT("tcache", ("parked table: '%s'.'%s' 0x%lx", table->s->db.str,
+                          table->s->table_name.str, (long) table));
+    *prev= table->next;
+    table->in_use= TABLE_CACHE_PARKED;
+  }
+  pthread_mutex_unlock(&instance->lock);
+  return !thd->open_tables;
+}
+
+
+/*
+  Reuse a table parked in the table cache instance of the thread
+
+  NOTES
+    Called without LOCK_open, with the same precondition as the search
+    in open_cache in open_table().
+
+  RETURN
+    0  No current table was parked, use open_cache
+    #  Table, linked into thd->open_tables
+*/
+
+static TABLE *table_cache_reuse(THD *thd, const char *key, uint key_length)
+{
+  TABLE_CACHE_INSTANCE *instance= table_cache_instance_of(thd);
+  TABLE *table;
+
+  pthread_mutex_lock(&instance->lock);
+  if (!thd->open_tables)
+    thd->version= refresh_version;
+  if (thd->version == refresh_version &&
+      (table= (TABLE*) hash_search(&instance->cache, (uchar*) key,
+                                   key_length)) &&
+      !table->needs_reopen_or_name_lock())
+  {
+    VOID(hash_delete(&instance->cache, (uchar*) table));
+    table->in_use= thd;
+    table->next= thd->open_tables;
+    thd->open_tables= table;
+  }
+  else
+    table= 0;
+  pthread_mutex_unlock(&instance->lock);
+  return table;
+}
+
 uint cached_open_tables(void)
 {
   return open_cache.records;
@@ -743,7 +991,7 @@ OPEN_TABLE_LIST *list_open_tables(THD *thd, const char *db, const char *wild)
       if (!strcmp(table->table, share->table_name.str) &&
 	  !strcmp(table->db,    share->db.str))
       {
-	if (entry->in_use)
+	if (entry->in_use && entry->in_use != TABLE_CACHE_PARKED)
 	  table->in_use++;
 	if (entry->locked_by_name)
 	  table->locked++;
@@ -762,7 +1010,8 @@ OPEN_TABLE_LIST *list_open_tables(THD *thd, const char *db, const char *wild)
 	   strmov(((*start_list)->db= (char*) ((*start_list)+1)),
 		  share->db.str)+1,
 	   share->table_name.str);
-    (*start_list)->in_use= entry->in_use ? 1 : 0;
+    (*start_list)->in_use= (entry->in_use &&
+                            entry->in_use != TABLE_CACHE_PARKED) ? 1 : 0;
     (*start_list)->locked= entry->locked_by_name ? 1 : 0;
     start_list= &(*start_list)->next;
     *start_list=0;
@@ -871,6 +1120,7 @@ static bool int_close_cached_tables(THD *thd, TABLE_LIST *tables, bool have_lock
     /* No need to close the open tables if we just set the readonly state */
     if (!set_readonly_mode)
       refresh_version++;				// Force close of open tables
+    table_cache_unpark(NULL, 0);
     while (unused_tables)
     {
 #ifdef EXTRA_DEBUG
@@ -936,12 +1186,16 @@ static bool int_close_cached_tables(THD *thd, TABLE_LIST *tables, bool have_lock
           So we set their versions as 'refresh_version - 1', which marks
           them for the 'needs_reopen_or_table_lock()'
          */
+        THD *in_use= table->in_use;
         if (set_readonly_mode && !table->file->has_transactions())
           table->s->version= 0;
-        if (table->in_use &&
+        if (in_use && in_use != TABLE_CACHE_PARKED &&
             (!set_readonly_mode || !table->file->has_transactions()))
-          table->in_use->some_tables_deleted= 1;
+          in_use->some_tables_deleted= 1;
       }
+      /* Tables that were parked meanwhile and made old above */
+      if (set_readonly_mode)
+        table_cache_unpark(NULL, 0);
     }
   }
   else
@@ -1233,6 +1487,13 @@ static void close_open_tables(THD *thd, uint keys_dirtied)
   */
   update_table_stats(thd, thd->open_tables, true, keys_dirtied);
 
+  /* Keep the current tables in the table cache instance of the thread */
+  if (table_cache_park(thd))
+  {
+    thd->some_tables_deleted= 0;
+    return;
+  }
+
   VOID(pthread_mutex_lock(&LOCK_open));
 
   DBUG_PRINT("info", ("thd->open_tables: 0x%lx", (long) thd->open_tables));
@@ -1461,16 +1722,7 @@ bool close_thread_table(THD *thd, TABLE **table_ptr, bool update_stats)
     free_field_buffers_larger_than(table,MAX_TDC_BLOB_SIZE);
     
     table->file->ha_reset();
-    table->in_use=0;
-    if (unused_tables)
-    {
-      table->next=unused_tables;		/* Link in last */
-      table->prev=unused_tables->prev;
-      unused_tables->prev=table;
-      table->prev->next=table;
-    }
-    else
-      unused_tables=table->next=table->prev=table;
+    link_unused(table);
   }
   DBUG_RETURN(found_old_table);
 }
@@ -2781,8 +3033,21 @@ TABLE *open_table(THD *thd, TABLE_LIST *table_list, MEM_ROOT *mem_root,
     We perform all of the above under LOCK_open which currently protects
     the open cache (also known as table cache) and table definitions stored
     on disk.
+    A table that this thread closed earlier may still be parked in its
+    table cache instance, which is checked first without LOCK_open.
   */
 
+  if (refresh && !thd->handler_tables &&
+      (table= table_cache_reuse(thd, key, key_length)))
+  {
+    DBUG_PRINT("tcache", ("reused table: '%s'.'%s' 0x%lx", table->s->db.str,
+                          table->s->table_name.str, (long) table));
+    thd->status_var.open_table_seconds+= my_fast_timer_diff_now(&timer,
+                                                                NULL);
+    table->reginfo.lock_type=TL_READ;		/* Assume read */
+    goto reset;
+  }
+
   VOID(pthread_mutex_lock(&LOCK_open));
 
   /*
@@ -2815,6 +3080,7 @@ TABLE *open_table(THD *thd, TABLE_LIST *table_list, MEM_ROOT *mem_root,
   if (thd->handler_tables)
     mysql_ha_flush(thd);
 
+retry:
   /*
     Actually try to find the table in the open_cache.
     The cache may contain several "TABLE" instances for the same
@@ -2865,6 +3131,13 @@ TABLE *open_table(THD *thd, TABLE_LIST *table_list, MEM_ROOT *mem_root,
         continue;
       }
 
+      /* Close old tables parked in table cache instances and look again */
+      if (table->in_use == TABLE_CACHE_PARKED)
+      {
+        table_cache_unpark(key, key_length);
+        goto retry;
+      }
+
       /* Avoid self-deadlocks by detecting self-dependencies. */
       if (table->open_placeholder && table->in_use == thd)
       {
@@ -3721,6 +3994,7 @@ bool table_is_used(TABLE *table, bool wait_for_name_lock)
     uint key_length= table->s->table_cache_key.length;
 
     DBUG_PRINT("loop", ("table_name: %s", table->alias));
+    table_cache_unpark(key, key_length);
     HASH_SEARCH_STATE state;
     for (TABLE *search= (TABLE*) hash_first(&open_cache, (uchar*) key,
                                              key_length, &state);
@@ -8680,6 +8954,7 @@ void remove_db_from_cache(const char *db)
 	relink_unused(table);
     }
   }
+  table_cache_unpark(NULL, 0);
   while (unused_tables && !unused_tables->s->version)
     VOID(hash_delete(&open_cache,(uchar*) unused_tables));
 }
@@ -8734,6 +9009,13 @@ bool remove_table_from_cache(THD *thd, const char *db, const char *table_name,
     HASH_SEARCH_STATE state;
     result= signalled= 0;
 
+    if ((flags & RTFC_CLEAR_MEMORY_CACHE) &&
+        (table= (TABLE*) hash_search(&open_cache, (uchar*) key, key_length)))
+    {
+      table->file->flush_memory_cache();
+      flags &= ~RTFC_CLEAR_MEMORY_CACHE; /* Only clear cache once */
+    }
+    table_cache_retire(key, key_length);
     for (table= (TABLE*) hash_first(&open_cache, (uchar*) key, key_length,
                                     &state);
          table;
@@ -8745,11 +9027,6 @@ bool remove_table_from_cache(THD *thd, const char *db, const char *table_name,
                             table->s->table_name.str, (long) table));
 
       table->s->version=0L;		/* Free when thread is ready */
-      if (flags & RTFC_CLEAR_MEMORY_CACHE)
-      {
-        table->file->flush_memory_cache();
-        flags &= ~RTFC_CLEAR_MEMORY_CACHE; /* Only clear cache once */
-      }
       if (!(in_use=table->in_use))
       {
         DBUG_PRINT("info",("Table was not in use"));
@@ -8790,9 +9067,12 @@ bool remove_table_from_cache(THD *thd, const char *db, const char *table_name,
           Note that we need to hold LOCK_open while going through the
           list. So that the other thread cannot change it. The other
           thread must also hold LOCK_open whenever changing the
-          open_tables list. Aborting the MERGE lock after a child was
-          closed and before the parent is closed would be fatal.
+          open_tables list, or the mutex of its table cache instance
+          when parking or reusing tables. Aborting the MERGE lock after
+          a child was closed and before the parent is closed would be
+          fatal.
         */
+        pthread_mutex_lock(&table_cache_instance_of(in_use)->lock);
         for (TABLE *thd_table= in_use->open_tables;
 	     thd_table ;
 	     thd_table= thd_table->next)
@@ -8801,6 +9081,7 @@ bool remove_table_from_cache(THD *thd, const char *db, const char *table_name,
 	  if (thd_table->db_stat && !thd_table->parent)	// If table is open
 	    signalled|= mysql_lock_abort_for_thread(thd, thd_table);
         }
+        pthread_mutex_unlock(&table_cache_instance_of(in_use)->lock);
       }
       else
       {
@@ -9079,6 +9360,7 @@ void mysql_wait_completed_table(ALTER_PARTITION_PARAM_TYPE *lpt, TABLE *my_table
 
   key_length=(uint) (strmov(strmov(key,lpt->db)+1,lpt->table_name)-key)+1;
   VOID(pthread_mutex_lock(&LOCK_open));
+  table_cache_retire(key, key_length);
   HASH_SEARCH_STATE state;
   for (table= (TABLE*) hash_first(&open_cache,(uchar*) key,key_length,
                                   &state) ;
@@ -9114,9 +9396,12 @@ void mysql_wait_completed_table(ALTER_PARTITION_PARAM_TYPE *lpt, TABLE *my_table
         Note that we need to hold LOCK_open while going through the
         list. So that the other thread cannot change it. The other
         thread must also hold LOCK_open whenever changing the
-        open_tables list. Aborting the MERGE lock after a child was
-        closed and before the parent is closed would be fatal.
+        open_tables list, or the mutex of its table cache instance
+        when parking or reusing tables. Aborting the MERGE lock after
+        a child was closed and before the parent is closed would be
+        fatal.
       */
+      pthread_mutex_lock(&table_cache_instance_of(in_use)->lock);
       for (TABLE *thd_table= in_use->open_tables;
            thd_table ;
            thd_table= thd_table->next)
@@ -9125,6 +9410,7 @@ void mysql_wait_completed_table(ALTER_PARTITION_PARAM_TYPE *lpt, TABLE *my_table
         if (thd_table->db_stat && !thd_table->parent) // If table is open
           mysql_lock_abort_for_thread(lpt->thd, thd_table);
       }
+      pthread_mutex_unlock(&table_cache_instance_of(in_use)->lock);
     }
   }
   /*
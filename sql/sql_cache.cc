@@ -287,10 +287,10 @@ functions:
        - Called from net_real_write to append a result set to a cached query
          if (and only if) this query has a registered result set writer
          (thd->net.query_cache_query).
- 4. Query_cache::invalidate
+ 4. Partitioned_query_cache::invalidate
        - Called from various places to invalidate query cache based on data-
          base, table and myisam file name. During an on going invalidation
-         the query cache is temporarily disabled.
+         the partition being invalidated is temporarily disabled.
  5. Query_cache::flush
        - Used when a RESET QUERY CACHE is issued. This clears the entire
          cache block by block.
@@ -303,6 +303,17 @@ functions:
          able memory to the 'bottom' of the memory.
 
 
+8. Partitions
+The server uses the query cache through Partitioned_query_cache
+(query_cache), which splits it into query_cache_partitions Query_cache
+objects. A statement is looked up and stored in the partition chosen by a
+hash of its text; result packets follow it there through
+thd->query_cache_partition. Every partition has its own memory share, query
+and table hashes and structure_guard_mutex, and is invalidated on its own.
+Lookups and stores don't wait for a partition locked by another thread;
+the statement is executed without the cache instead (Qcache_lock_bypasses).
+
+
 TODO list:
 
   - Delayed till after-parsing qache answer (for column rights processing)
@@ -423,16 +434,17 @@ TYPELIB query_cache_type_typelib=
   effect by another thread. This enables a quick path in execution to skip waits
   when the outcome is known.
 
-  @param use_timeout TRUE if the lock can abort because of a timeout.
+  @param no_wait TRUE if the lock attempt should fail instead of waiting
+                 for another thread to unlock the cache.
 
-  @note use_timeout is optional and default value is FALSE.
+  @note no_wait is optional and default value is FALSE.
 
   @return
    @retval FALSE An exclusive lock was taken
    @retval TRUE The locking attempt failed
 */
 
-bool Query_cache::try_lock(bool use_timeout)
+bool Query_cache::try_lock(bool no_wait)
 {
   bool interrupt= FALSE;
   DBUG_ENTER("Query_cache::try_lock");
@@ -463,25 +475,17 @@ bool Query_cache::try_lock(bool use_timeout)
     {
       DBUG_ASSERT(m_cache_lock_status == Query_cache::LOCKED);
       /*
-        To prevent send_result_to_client() and query_cache_insert() from
-        blocking execution for too long a timeout is put on the lock.
+        To prevent send_result_to_client() and store_query() from
+        blocking execution behind an invalidation or another lookup,
+        they bypass a busy cache and run the statement instead.
       */
-      if (use_timeout)
-      {
-        struct timespec waittime;
-        set_timespec_nsec(waittime,(ulong)(50000000L));  /* Wait for 50 msec */
-        int res= pthread_cond_timedwait(&COND_cache_status_changed,
-                                        &structure_guard_mutex,&waittime);
-        if (res == ETIMEDOUT)
-        {
-          interrupt= TRUE;
-          break;
-        }
-      }
-      else
+      if (no_wait)
       {
-        pthread_cond_wait(&COND_cache_status_changed, &structure_guard_mutex);
+        lock_bypasses++;
+        interrupt= TRUE;
+        break;
       }
+      pthread_cond_wait(&COND_cache_status_changed, &structure_guard_mutex);
     }
   }
   pthread_mutex_unlock(&structure_guard_mutex);
@@ -865,7 +869,8 @@ void query_cache_insert(NET *net, const char *packet, ulong length)
   DBUG_EXECUTE_IF("wait_in_query_cache_insert",
                   debug_wait_for_kill("wait_in_query_cache_insert"); );
 
-  if (query_cache.try_lock())
+  Query_cache *qc= current_thd->query_cache_partition;
+  if (qc->try_lock())
     DBUG_VOID_RETURN;
 
   Query_cache_block *query_block= (Query_cache_block*)net->query_cache_query;
@@ -875,7 +880,7 @@ void query_cache_insert(NET *net, const char *packet, ulong length)
       We lost the writer and the currently processed query has been
       invalidated; there is nothing left to do.
     */
-    query_cache.unlock();
+    qc->unlock();
     DBUG_VOID_RETURN;
   }
 
@@ -883,7 +888,7 @@ void query_cache_insert(NET *net, const char *packet, ulong length)
   Query_cache_query *header= query_block->query();
   Query_cache_block *result= header->result();
 
-  DUMP(&query_cache);
+  DUMP(qc);
   DBUG_PRINT("qcache", ("insert packet %lu bytes long",length));
 
   /*
@@ -891,24 +896,24 @@ void query_cache_insert(NET *net, const char *packet, ulong length)
     still need structure_guard_mutex to free the query, and therefore unlock
     it later in this function.
   */
-  if (!query_cache.append_result_data(&result, length, (uchar*) packet,
-                                      query_block))
+  if (!qc->append_result_data(&result, length, (uchar*) packet,
+                              query_block))
   {
     DBUG_PRINT("warning", ("Can't append data"));
     header->result(result);
     DBUG_PRINT("qcache", ("free query 0x%lx", (ulong) query_block));
     // The following call will remove the lock on query_block
-    query_cache.free_query(query_block);
-    query_cache.refused++;
+    qc->free_query(query_block);
+    qc->refused++;
     // append_result_data no success => we need unlock
-    query_cache.unlock();
+    qc->unlock();
     DBUG_VOID_RETURN;
   }
 
   header->result(result);
   header->last_pkt_nr= net->pkt_nr;
   BLOCK_UNLOCK_WR(query_block);
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(0););
+  DBUG_EXECUTE("check_querycache",qc->check_integrity(0););
 
   DBUG_VOID_RETURN;
 }
@@ -923,7 +928,8 @@ void query_cache_abort(NET *net)
   if (query_cache.is_disabled() || net->query_cache_query == 0)
     DBUG_VOID_RETURN;
 
-  if (query_cache.try_lock())
+  Query_cache *qc= thd->query_cache_partition;
+  if (qc->try_lock())
     DBUG_VOID_RETURN;
 
   /*
@@ -935,15 +941,15 @@ void query_cache_abort(NET *net)
   if (query_block)
   {
     thd_proc_info(thd, "storing result in query cache");
-    DUMP(&query_cache);
+    DUMP(qc);
     BLOCK_LOCK_WR(query_block);
     // The following call will remove the lock on query_block
-    query_cache.free_query(query_block);
+    qc->free_query(query_block);
     net->query_cache_query= 0;
-    DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+    DBUG_EXECUTE("check_querycache",qc->check_integrity(1););
   }
 
-  query_cache.unlock();
+  qc->unlock();
   DBUG_VOID_RETURN;
 }
 
@@ -971,7 +977,8 @@ void query_cache_end_of_result(THD *thd)
                      emb_count_querycache_size(thd));
 #endif
 
-  if (query_cache.try_lock())
+  Query_cache *qc= thd->query_cache_partition;
+  if (qc->try_lock())
     DBUG_VOID_RETURN;
 
   query_block= ((Query_cache_block*) thd->net.query_cache_query);
@@ -983,7 +990,7 @@ void query_cache_end_of_result(THD *thd)
       block, the writer should be dropped.
     */
     thd_proc_info(thd, "storing result in query cache");
-    DUMP(&query_cache);
+    DUMP(qc);
     BLOCK_LOCK_WR(query_block);
     Query_cache_query *header= query_block->query();
     Query_cache_block *last_result_block;
@@ -1000,15 +1007,15 @@ void query_cache_end_of_result(THD *thd)
         and removed from QC.
       */
       DBUG_ASSERT(0);
-      query_cache.free_query(query_block);
-      query_cache.unlock();
+      qc->free_query(query_block);
+      qc->unlock();
       DBUG_VOID_RETURN;
     }
     last_result_block= header->result()->prev;
     allign_size= ALIGN_SIZE(last_result_block->used);
-    len= max(query_cache.min_allocation_unit, allign_size);
-    if (last_result_block->length >= query_cache.min_allocation_unit + len)
-      query_cache.split_block(last_result_block,len);
+    len= max(qc->min_allocation_unit, allign_size);
+    if (last_result_block->length >= qc->min_allocation_unit + len)
+      qc->split_block(last_result_block,len);
 
     header->found_rows(current_thd->limit_found_rows);
     header->result()->type= Query_cache_block::RESULT;
@@ -1017,10 +1024,10 @@ void query_cache_end_of_result(THD *thd)
     header->writer(0);
     thd->net.query_cache_query= 0;
     BLOCK_UNLOCK_WR(query_block);
-    DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+    DBUG_EXECUTE("check_querycache",qc->check_integrity(1););
 
   }
-  query_cache.unlock();
+  qc->unlock();
   DBUG_VOID_RETURN;
 }
 
@@ -1043,6 +1050,367 @@ void mysql_query_cache_invalidate4(THD *thd,
 }
 
 
+/*****************************************************************************
+   Partitioned_query_cache methods
+*****************************************************************************/
+
+Partitioned_query_cache::Partitioned_query_cache()
+  :query_cache_size(0), query_cache_limit(ULONG_MAX),
+   partition_count(1), enable_skip_leading_comment(0)
+{}
+
+
+/**
+  Find the partition a statement is cached in.
+
+  The partition is chosen by a hash of the statement text with the
+  leading comment skipped, the text the query hash of a partition is
+  keyed on, so store_query() and send_result_to_client() agree on it.
+*/
+
+Query_cache *Partitioned_query_cache::partition_for(char *sql, uint length)
+{
+  ulong nr1= 1, nr2= 4;
+  if (partition_count == 1)
+    return partitions;
+  if (enable_skip_leading_comment)
+    sql= Query_cache::skip_leading_comment(sql, &length);
+  my_charset_bin.coll->hash_sort(&my_charset_bin, (uchar*) sql, length,
+                                 &nr1, &nr2);
+  return partitions + nr1 % partition_count;
+}
+
+
+void Partitioned_query_cache::init()
+{
+  DBUG_ENTER("Partitioned_query_cache::init");
+  partition_count= (uint) query_cache_partitions;
+  for (uint i= 0; i < partition_count; i++)
+    partitions[i].init();
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Give every partition an equal share of the cache memory.
+
+  @return The memory used by all partitions, 0 if disabled
+*/
+
+ulong Partitioned_query_cache::resize(ulong query_cache_size_arg)
+{
+  ulong new_query_cache_size= 0, size= 0;
+  DBUG_ENTER("Partitioned_query_cache::resize");
+  for (uint i= 0; i < partition_count; i++)
+  {
+    new_query_cache_size+= partitions[i].resize(query_cache_size_arg /
+                                                partition_count);
+    size+= partitions[i].query_cache_size;
+  }
+  query_cache_size= size;
+  DBUG_RETURN(new_query_cache_size);
+}
+
+
+/*
+  The options below are set before init() is called, so they are
+  applied to all partitions that may be used.
+*/
+
+void Partitioned_query_cache::result_size_limit(ulong limit)
+{
+  query_cache_limit= limit;
+  for (uint i= 0; i < QUERY_CACHE_MAX_PARTITIONS; i++)
+    partitions[i].result_size_limit(limit);
+}
+
+
+ulong Partitioned_query_cache::set_min_res_unit(ulong size)
+{
+  for (uint i= 0; i < QUERY_CACHE_MAX_PARTITIONS; i++)
+    partitions[i].set_min_res_unit(size);
+  return partitions[0].min_result_data_size;
+}
+
+
+void Partitioned_query_cache::set_skip_leading_comment(my_bool enable)
+{
+  enable_skip_leading_comment= enable;
+  for (uint i= 0; i < QUERY_CACHE_MAX_PARTITIONS; i++)
+    partitions[i].set_skip_leading_comment(enable);
+}
+
+
+void Partitioned_query_cache::store_query(THD *thd, TABLE_LIST *tables_used)
+{
+  /* See the comment in Query_cache::store_query() */
+  if (thd->locked_tables || query_cache_size == 0)
+    return;
+  Query_cache *qc= partition_for(thd->query(), thd->query_length());
+  /* Result packets are stored by query_cache_insert() in this partition */
+  thd->query_cache_partition= qc;
+  qc->store_query(thd, tables_used);
+}
+
+
+int
+Partitioned_query_cache::send_result_to_client(THD *thd, char *sql,
+                                               uint query_length)
+{
+  if (is_disabled() || query_cache_size == 0)
+    return 0;
+  return partition_for(sql, query_length)->send_result_to_client(thd, sql,
+                                                                 query_length);
+}
+
+
+/*
+  Remove all cached queries that uses any of the tables in the list
+*/
+
+void Partitioned_query_cache::invalidate(THD *thd, TABLE_LIST *tables_used,
+                                         my_bool using_transactions)
+{
+  DBUG_ENTER("Partitioned_query_cache::invalidate (table list)");
+  if (is_disabled())
+    DBUG_VOID_RETURN;
+
+  using_transactions= using_transactions &&
+    (thd->options & (OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN));
+  for (; tables_used; tables_used= tables_used->next_local)
+  {
+    DBUG_ASSERT(!using_transactions || tables_used->table!=0);
+    if (tables_used->derived)
+      continue;
+    if (using_transactions &&
+        (tables_used->table->file->table_cache_type() ==
+        HA_CACHE_TBL_TRANSACT))
+      /*
+        tables_used->table can't be 0 in transaction.
+        Only 'drop' invalidate not opened table, but 'drop'
+        force transaction finish.
+      */
+      thd->add_changed_table(tables_used->table);
+    else
+      invalidate_table(thd, tables_used);
+  }
+
+  DBUG_EXECUTE_IF("wait_after_query_cache_invalidate",
+                  debug_wait_for_kill("wait_after_query_cache_invalidate"););
+
+  DBUG_VOID_RETURN;
+}
+
+void Partitioned_query_cache::invalidate(CHANGED_TABLE_LIST *tables_used)
+{
+  DBUG_ENTER("Partitioned_query_cache::invalidate (changed table list)");
+  if (is_disabled())
+    DBUG_VOID_RETURN;
+  THD *thd= current_thd;
+  for (; tables_used; tables_used= tables_used->next)
+  {
+    thd_proc_info(thd, "invalidating query cache entries (table list)");
+    invalidate_table(thd, (uchar*) tables_used->key, tables_used->key_length);
+    DBUG_PRINT("qcache", ("db: %s  table: %s", tables_used->key,
+                          tables_used->key+
+                          strlen(tables_used->key)+1));
+  }
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Invalidate locked for write
+
+  SYNOPSIS
+    Partitioned_query_cache::invalidate_locked_for_write()
+    tables_used - table list
+
+  NOTE
+    can be used only for opened tables
+*/
+void
+Partitioned_query_cache::invalidate_locked_for_write(TABLE_LIST *tables_used)
+{
+  DBUG_ENTER("Partitioned_query_cache::invalidate_locked_for_write");
+  if (is_disabled())
+    DBUG_VOID_RETURN;
+  THD *thd= current_thd;
+  for (; tables_used; tables_used= tables_used->next_local)
+  {
+    thd_proc_info(thd, "invalidating query cache entries (table)");
+    if (tables_used->lock_type >= TL_WRITE_ALLOW_WRITE &&
+        tables_used->table)
+    {
+      invalidate_table(thd, tables_used->table);
+    }
+  }
+  DBUG_VOID_RETURN;
+}
+
+/*
+  Remove all cached queries that uses the given table
+*/
+
+void Partitioned_query_cache::invalidate(THD *thd, TABLE *table,
+                                         my_bool using_transactions)
+{
+  DBUG_ENTER("Partitioned_query_cache::invalidate (table)");
+  if (is_disabled())
+    DBUG_VOID_RETURN;
+  
+  using_transactions= using_transactions &&
+    (thd->options & (OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN));
+  if (using_transactions && 
+      (table->file->table_cache_type() == HA_CACHE_TBL_TRANSACT))
+    thd->add_changed_table(table);
+  else
+    invalidate_table(thd, table);
+
+
+  DBUG_VOID_RETURN;
+}
+
+void Partitioned_query_cache::invalidate(THD *thd, const char *key,
+                                         uint32  key_length,
+                                         my_bool using_transactions)
+{
+  DBUG_ENTER("Partitioned_query_cache::invalidate (key)");
+  if (is_disabled())
+    DBUG_VOID_RETURN;
+
+  using_transactions= using_transactions &&
+    (thd->options & (OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN));
+  if (using_transactions) // used for innodb => has_transactions() is TRUE
+    thd->add_changed_table(key, key_length);
+  else
+    invalidate_table(thd, (uchar*)key, key_length);
+
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+   Remove all cached queries that uses the given database.
+*/
+
+void Partitioned_query_cache::invalidate(char *db)
+{
+  DBUG_ENTER("Partitioned_query_cache::invalidate (db)");
+  if (is_disabled())
+    DBUG_VOID_RETURN;
+  for (uint i= 0; i < partition_count; i++)
+    partitions[i].invalidate(db);
+  DBUG_VOID_RETURN;
+}
+
+
+void
+Partitioned_query_cache::invalidate_by_MyISAM_filename(const char *filename)
+{
+  DBUG_ENTER("Partitioned_query_cache::invalidate_by_MyISAM_filename");
+  if (is_disabled())
+    DBUG_VOID_RETURN;
+
+  /* Calculate the key outside the lock to make the lock shorter */
+  char key[MAX_DBKEY_LENGTH];
+  uint32 db_length;
+  uint key_length= Query_cache::filename_2_table_key(key, filename, &db_length);
+  THD *thd= current_thd;
+  invalidate_table(thd,(uchar *)key, key_length);
+  DBUG_VOID_RETURN;
+}
+
+/*
+  Invalidate the first table in the table_list
+*/
+
+void Partitioned_query_cache::invalidate_table(THD *thd,
+                                               TABLE_LIST *table_list)
+{
+  if (table_list->table != 0)
+    invalidate_table(thd, table_list->table);	// Table is open
+  else
+  {
+    char key[MAX_DBKEY_LENGTH];
+    uint key_length;
+
+    key_length=(uint) (strmov(strmov(key,table_list->db)+1,
+			      table_list->table_name) -key)+ 1;
+
+    // We don't store temporary tables => no key_length+=4 ...
+    invalidate_table(thd, (uchar *)key, key_length);
+  }
+}
+
+void Partitioned_query_cache::invalidate_table(THD *thd, TABLE *table)
+{
+  invalidate_table(thd, (uchar*) table->s->table_cache_key.str,
+                   table->s->table_cache_key.length);
+}
+
+/**
+  Invalidate a table in every partition.
+
+  Each partition is locked on its own while its queries using the table
+  are freed; lookups in the other partitions go on meanwhile.
+*/
+
+void Partitioned_query_cache::invalidate_table(THD *thd, uchar *key,
+                                               uint32 key_length)
+{
+  DBUG_EXECUTE_IF("wait_in_query_cache_invalidate1",
+                   debug_wait_for_kill("wait_in_query_cache_invalidate1"); );
+
+  for (uint i= 0; i < partition_count; i++)
+    partitions[i].invalidate_table(thd, key, key_length);
+}
+
+
+  /* Remove all queries from cache */
+
+void Partitioned_query_cache::flush()
+{
+  for (uint i= 0; i < partition_count; i++)
+    partitions[i].flush();
+}
+
+
+void Partitioned_query_cache::pack(ulong join_limit, uint iteration_limit)
+{
+  for (uint i= 0; i < partition_count; i++)
+    partitions[i].pack(join_limit, iteration_limit);
+}
+
+
+void Partitioned_query_cache::destroy()
+{
+  for (uint i= 0; i < partition_count; i++)
+    partitions[i].destroy();
+  query_cache_size= 0;
+}
+
+
+ulong Partitioned_query_cache::sum_status(ulong Query_cache::*counter)
+{
+  ulong sum= 0;
+  for (uint i= 0; i < partition_count; i++)
+    sum+= partitions[i].*counter;
+  return sum;
+}
+
+
+void Partitioned_query_cache::reset_status()
+{
+  for (uint i= 0; i < partition_count; i++)
+  {
+    Query_cache *qc= partitions + i;
+    qc->hits= qc->inserts= qc->refused= qc->lowmem_prunes= 0;
+    qc->lock_bypasses= 0;
+  }
+}
+
+
 /*****************************************************************************
    Query_cache methods
 *****************************************************************************/
@@ -1055,7 +1423,7 @@ Query_cache::Query_cache(ulong query_cache_limit_arg,
   :query_cache_size(0),
    query_cache_limit(query_cache_limit_arg),
    queries_in_cache(0), hits(0), inserts(0), refused(0),
-   total_blocks(0), lowmem_prunes(0),
+   total_blocks(0), lowmem_prunes(0), lock_bypasses(0),
    m_query_cache_is_disabled(FALSE),
    min_allocation_unit(ALIGN_SIZE(min_allocation_unit_arg)),
    min_result_data_size(ALIGN_SIZE(min_result_data_size_arg)),
@@ -1224,11 +1592,8 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
       finish. We choose not to wait for them and skip caching statements
       instead.
 
-      In case the wait time can't be determined there is an upper limit which
-      causes try_lock() to abort with a time out.
-
-      The 'TRUE' parameter indicate that the lock is allowed to timeout
-
+      The 'TRUE' parameter makes try_lock() fail instead of waiting when
+      another thread holds the lock of this partition.
     */
     if (try_lock(TRUE))
       DBUG_VOID_RETURN;
@@ -1508,10 +1873,9 @@ Query_cache::send_result_to_client(THD *thd, char *sql, uint query_length)
 
   /*
     Try to obtain an exclusive lock on the query cache. If the cache is
-    disabled or if a full cache flush is in progress, the attempt to
-    get the lock is aborted.
-
-    The 'TRUE' parameter indicate that the lock is allowed to timeout
+    disabled, if a full cache flush is in progress or if another thread
+    holds the lock of this partition, the attempt to get the lock is
+    aborted and the statement is executed.
   */
   if (try_lock(TRUE))
     goto err;
@@ -1764,130 +2128,6 @@ err:
 }
 
 
-/*
-  Remove all cached queries that uses any of the tables in the list
-*/
-
-void Query_cache::invalidate(THD *thd, TABLE_LIST *tables_used,
-			     my_bool using_transactions)
-{
-  DBUG_ENTER("Query_cache::invalidate (table list)");
-  if (is_disabled())
-    DBUG_VOID_RETURN;
-
-  using_transactions= using_transactions &&
-    (thd->options & (OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN));
-  for (; tables_used; tables_used= tables_used->next_local)
-  {
-    DBUG_ASSERT(!using_transactions || tables_used->table!=0);
-    if (tables_used->derived)
-      continue;
-    if (using_transactions &&
-        (tables_used->table->file->table_cache_type() ==
-        HA_CACHE_TBL_TRANSACT))
-      /*
-        tables_used->table can't be 0 in transaction.
-        Only 'drop' invalidate not opened table, but 'drop'
-        force transaction finish.
-      */
-      thd->add_changed_table(tables_used->table);
-    else
-      invalidate_table(thd, tables_used);
-  }
-
-  DBUG_EXECUTE_IF("wait_after_query_cache_invalidate",
-                  debug_wait_for_kill("wait_after_query_cache_invalidate"););
-
-  DBUG_VOID_RETURN;
-}
-
-void Query_cache::invalidate(CHANGED_TABLE_LIST *tables_used)
-{
-  DBUG_ENTER("Query_cache::invalidate (changed table list)");
-  if (is_disabled())
-    DBUG_VOID_RETURN;
-  THD *thd= current_thd;
-  for (; tables_used; tables_used= tables_used->next)
-  {
-    thd_proc_info(thd, "invalidating query cache entries (table list)");
-    invalidate_table(thd, (uchar*) tables_used->key, tables_used->key_length);
-    DBUG_PRINT("qcache", ("db: %s  table: %s", tables_used->key,
-                          tables_used->key+
-                          strlen(tables_used->key)+1));
-  }
-  DBUG_VOID_RETURN;
-}
-
-
-/*
-  Invalidate locked for write
-
-  SYNOPSIS
-    Query_cache::invalidate_locked_for_write()
-    tables_used - table list
-
-  NOTE
-    can be used only for opened tables
-*/
-void Query_cache::invalidate_locked_for_write(TABLE_LIST *tables_used)
-{
-  DBUG_ENTER("Query_cache::invalidate_locked_for_write");
-  if (is_disabled())
-    DBUG_VOID_RETURN;
-  THD *thd= current_thd;
-  for (; tables_used; tables_used= tables_used->next_local)
-  {
-    thd_proc_info(thd, "invalidating query cache entries (table)");
-    if (tables_used->lock_type >= TL_WRITE_ALLOW_WRITE &&
-        tables_used->table)
-    {
-      invalidate_table(thd, tables_used->table);
-    }
-  }
-  DBUG_VOID_RETURN;
-}
-
-/*
-  Remove all cached queries that uses the given table
-*/
-
-void Query_cache::invalidate(THD *thd, TABLE *table, 
-			     my_bool using_transactions)
-{
-  DBUG_ENTER("Query_cache::invalidate (table)");
-  if (is_disabled())
-    DBUG_VOID_RETURN;
-  
-  using_transactions= using_transactions &&
-    (thd->options & (OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN));
-  if (using_transactions && 
-      (table->file->table_cache_type() == HA_CACHE_TBL_TRANSACT))
-    thd->add_changed_table(table);
-  else
-    invalidate_table(thd, table);
-
-
-  DBUG_VOID_RETURN;
-}
-
-void Query_cache::invalidate(THD *thd, const char *key, uint32  key_length,
-			     my_bool using_transactions)
-{
-  DBUG_ENTER("Query_cache::invalidate (key)");
-  if (is_disabled())
-    DBUG_VOID_RETURN;
-
-  using_transactions= using_transactions &&
-    (thd->options & (OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN));
-  if (using_transactions) // used for innodb => has_transactions() is TRUE
-    thd->add_changed_table(key, key_length);
-  else
-    invalidate_table(thd, (uchar*)key, key_length);
-
-  DBUG_VOID_RETURN;
-}
-
-
 /**
    Remove all cached queries that uses the given database.
 */
@@ -1965,21 +2205,6 @@ void Query_cache::invalidate(char *db)
 }
 
 
-void Query_cache::invalidate_by_MyISAM_filename(const char *filename)
-{
-  DBUG_ENTER("Query_cache::invalidate_by_MyISAM_filename");
-  if (is_disabled())
-    DBUG_VOID_RETURN;
-
-  /* Calculate the key outside the lock to make the lock shorter */
-  char key[MAX_DBKEY_LENGTH];
-  uint32 db_length;
-  uint key_length= filename_2_table_key(key, filename, &db_length);
-  THD *thd= current_thd;
-  invalidate_table(thd,(uchar *)key, key_length);
-  DBUG_VOID_RETURN;
-}
-
   /* Remove all queries from cache */
 
 void Query_cache::flush()
@@ -1998,7 +2223,7 @@ void Query_cache::flush()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   unlock();
   DBUG_VOID_RETURN;
 }
@@ -2084,7 +2309,7 @@ void Query_cache::init()
     be used.
   */
   if (global_system_variables.query_cache_type == 0)
-    query_cache.disable_query_cache();
+    disable_query_cache();
   DBUG_VOID_RETURN;
 }
 
@@ -2742,38 +2967,8 @@ my_bool Query_cache::allocate_data_chain(Query_cache_block **result_block,
   Tables management
 *****************************************************************************/
 
-/*
-  Invalidate the first table in the table_list
-*/
-
-void Query_cache::invalidate_table(THD *thd, TABLE_LIST *table_list)
-{
-  if (table_list->table != 0)
-    invalidate_table(thd, table_list->table);	// Table is open
-  else
-  {
-    char key[MAX_DBKEY_LENGTH];
-    uint key_length;
-
-    key_length=(uint) (strmov(strmov(key,table_list->db)+1,
-			      table_list->table_name) -key)+ 1;
-
-    // We don't store temporary tables => no key_length+=4 ...
-    invalidate_table(thd, (uchar *)key, key_length);
-  }
-}
-
-void Query_cache::invalidate_table(THD *thd, TABLE *table)
-{
-  invalidate_table(thd, (uchar*) table->s->table_cache_key.str,
-                   table->s->table_cache_key.length);
-}
-
 void Query_cache::invalidate_table(THD *thd, uchar * key, uint32  key_length)
 {
-  DBUG_EXECUTE_IF("wait_in_query_cache_invalidate1",
-                   debug_wait_for_kill("wait_in_query_cache_invalidate1"); );
-
   /*
     Lock the query cache and queue all invalidation attempts to avoid
     the risk of a race between invalidation, cache inserts and flushes.
@@ -3782,7 +3977,7 @@ void Query_cache::pack_cache()
 {
   DBUG_ENTER("Query_cache::pack_cache");
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
 
   uchar *border = 0;
   Query_cache_block *before = 0;
@@ -3814,7 +4009,7 @@ void Query_cache::pack_cache()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   DBUG_VOID_RETURN;
 }
 
@@ -4196,6 +4391,22 @@ my_bool in_blocks(Query_cache_block * point) { return 0; }
 #else
 
 
+void Partitioned_query_cache::wreck(uint line, const char *message)
+{
+  for (uint i= 0; i < partition_count; i++)
+    partitions[i].wreck(line, message);
+}
+
+
+my_bool Partitioned_query_cache::check_integrity(bool not_locked)
+{
+  my_bool result= 0;
+  for (uint i= 0; i < partition_count; i++)
+    result|= partitions[i].check_integrity(not_locked);
+  return result;
+}
+
+
 /*
   Debug method which switch query cache off but left content for
   investigation.
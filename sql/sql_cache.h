@@ -59,6 +59,9 @@
 #define QUERY_CACHE_PACK_ITERATION		2
 #define QUERY_CACHE_PACK_LIMIT			(512*1024L)
 
+/* upper limit of query_cache_partitions */
+#define QUERY_CACHE_MAX_PARTITIONS		64
+
 #define TABLE_COUNTER_TYPE uint
 
 struct Query_cache_block;
@@ -271,7 +274,7 @@ public:
   ulong query_cache_size, query_cache_limit;
   /* statistics */
   ulong free_memory, queries_in_cache, hits, inserts, refused,
-    free_memory_blocks, total_blocks, lowmem_prunes;
+    free_memory_blocks, total_blocks, lowmem_prunes, lock_bypasses;
 
 
 private:
@@ -342,10 +345,7 @@ protected:
 			      ulong data_len,
 			      Query_cache_block *query_block,
 			      my_bool first_block);
-  void invalidate_table(THD *thd, TABLE_LIST *table);
-  void invalidate_table(THD *thd, TABLE *table);
   void invalidate_table(THD *thd, uchar *key, uint32  key_length);
-  void invalidate_table(THD *thd, Query_cache_block *table_block);
   void invalidate_query_block_list(THD *thd, 
                                    Query_cache_block_table *list_root);
 
@@ -454,27 +454,16 @@ protected:
   */
   int send_result_to_client(THD *thd, char *query, uint query_length);
 
-  /* Remove all queries that uses any of the listed following tables */
-  void invalidate(THD* thd, TABLE_LIST *tables_used,
-		  my_bool using_transactions);
-  void invalidate(CHANGED_TABLE_LIST *tables_used);
-  void invalidate_locked_for_write(TABLE_LIST *tables_used);
-  void invalidate(THD* thd, TABLE *table, my_bool using_transactions);
-  void invalidate(THD *thd, const char *key, uint32  key_length,
-		  my_bool using_transactions);
-
   /* Remove all queries that uses any of the tables in following database */
   void invalidate(char *db);
 
-  /* Remove all queries that uses any of the listed following table */
-  void invalidate_by_MyISAM_filename(const char *filename);
-
   void flush();
   void pack(ulong join_limit = QUERY_CACHE_PACK_LIMIT,
 	    uint iteration_limit = QUERY_CACHE_PACK_ITERATION);
 
   void destroy();
 
+  friend class Partitioned_query_cache;
   friend void query_cache_init_query(NET *net);
   friend void query_cache_insert(NET *net, const char *packet, ulong length);
   friend void query_cache_end_of_result(THD *thd);
@@ -498,13 +487,88 @@ protected:
 			const char *name);
   my_bool in_blocks(Query_cache_block * point);
 
-  bool try_lock(bool use_timeout= FALSE);
+  bool try_lock(bool no_wait= FALSE);
   void lock(void);
   void lock_and_suspend(void);
   void unlock(void);
 };
 
-extern Query_cache query_cache;
+
+/**
+  The query cache as seen by the rest of the server.
+
+  Statements are spread over up to QUERY_CACHE_MAX_PARTITIONS
+  independent Query_cache partitions by a hash of their text. Each
+  partition has its own memory, query and table hashes and lock, so a
+  lookup or a store only serializes with statements that hash to the
+  same partition. Invalidating a table visits the partitions one at a
+  time; there is no lock covering the whole cache.
+*/
+
+class Partitioned_query_cache
+{
+public:
+  /* Info; query_cache_size is the sum of the partition sizes */
+  ulong query_cache_size, query_cache_limit;
+
+private:
+  Query_cache partitions[QUERY_CACHE_MAX_PARTITIONS];
+  uint partition_count;
+  my_bool enable_skip_leading_comment;
+
+  Query_cache *partition_for(char *sql, uint length);
+  void invalidate_table(THD *thd, TABLE_LIST *table_list);
+  void invalidate_table(THD *thd, TABLE *table);
+  void invalidate_table(THD *thd, uchar *key, uint32 key_length);
+
+public:
+  Partitioned_query_cache();
+
+  bool is_disabled(void) { return partitions[0].is_disabled(); }
+
+  /* initialize the query_cache_partitions partitions */
+  void init();
+  /* resize query cache (return real query size, 0 if disabled) */
+  ulong resize(ulong query_cache_size);
+  void result_size_limit(ulong limit);
+  ulong set_min_res_unit(ulong size);
+  void set_skip_leading_comment(my_bool enable);
+
+  void store_query(THD *thd, TABLE_LIST *used_tables);
+  int send_result_to_client(THD *thd, char *query, uint query_length);
+
+  /* Remove all queries that uses any of the listed following tables */
+  void invalidate(THD* thd, TABLE_LIST *tables_used,
+		  my_bool using_transactions);
+  void invalidate(CHANGED_TABLE_LIST *tables_used);
+  void invalidate_locked_for_write(TABLE_LIST *tables_used);
+  void invalidate(THD* thd, TABLE *table, my_bool using_transactions);
+  void invalidate(THD *thd, const char *key, uint32  key_length,
+		  my_bool using_transactions);
+
+  /* Remove all queries that uses any of the tables in following database */
+  void invalidate(char *db);
+
+  /* Remove all queries that uses any of the listed following table */
+  void invalidate_by_MyISAM_filename(const char *filename);
+
+  void flush();
+  void pack(ulong join_limit = QUERY_CACHE_PACK_LIMIT,
+	    uint iteration_limit = QUERY_CACHE_PACK_ITERATION);
+
+  void destroy();
+
+  /* Sum of a statistics counter over all partitions */
+  ulong sum_status(ulong Query_cache::*counter);
+  /* Reset the statistics counters cleared by FLUSH STATUS */
+  void reset_status();
+
+  /* Only used when debugging, see Query_cache */
+  void wreck(uint line, const char *message);
+  my_bool check_integrity(bool not_locked);
+};
+
+extern Partitioned_query_cache query_cache;
 extern TYPELIB query_cache_type_typelib;
 void query_cache_init_query(NET *net);
 void query_cache_insert(NET *net, const char *packet, ulong length);
@@ -644,9 +644,10 @@ Diagnostics_area::disable_status()
 THD::THD()
    :Statement(&main_lex, &main_mem_root, CONVENTIONAL_EXECUTION,
               /* statement id */ 0),
-   Open_tables_state(refresh_version), rli_fake(0),
+   Open_tables_state(refresh_version), rli_fake(0), rli_slave(0),
    lock_id(&main_lock_id),
    uses_admission_control(QUERY_NOT_SCHEDULED),
+   ac_pool(NULL), ac_pool_running(FALSE), ac_pool_admitted(FALSE),
    user_time(0), in_sub_stmt(0),
    sql_log_bin_toplevel(false),
    binlog_table_maps(0), binlog_flags(0UL),
@@ -729,6 +730,7 @@ THD::THD()
   client_capabilities= 0;                       // minimalistic client
 #ifdef HAVE_QUERY_CACHE
   query_cache_init_query(&net);                 // If error on boot
+  query_cache_partition= 0;
 #endif
   ull=0;
   system_thread= NON_SYSTEM_THREAD;
@@ -55,6 +55,25 @@
 
 int admission_control_enter(THD* thd, my_bool wait);
 void admission_control_exit(THD* thd);
+
+/*
+ * Per-database admission control pools.  When
+ * admission_control_db_max_running is non-zero, each command subject to
+ * admission control is also charged to the pool of its current database
+ * (pools are indexed like DB_STATISTICS; commands without a database
+ * share pool 0).  A pool runs at most admission_control_db_max_running
+ * times its weight queries and queues at most
+ * admission_control_db_max_queued times its weight more; further queries
+ * fail.  Within a pool, queries are admitted in arrival order.  When
+ * admission_control_db_total_running is reached across all pools, a freed
+ * slot goes to the pool furthest below its weighted share, the longest
+ * waiting query breaking ties.
+ */
+void init_admission_pools();
+void free_admission_pools();
+void reset_admission_pools();
+bool admission_pools_check_weights(const char *weights);
+void admission_pools_set_weights(const char *weights);
 int admission_control_diskio_enter(THD* thd, bool diskio_used_for_exit);
 bool admission_control_diskio_exit(THD* thd);
 
@@ -146,6 +165,7 @@ class sp_rcontext;
 class sp_cache;
 class Parser_state;
 class Rows_log_event;
+class Query_cache;
 
 enum enum_enable_or_disable { LEAVE_AS_IS, ENABLE, DISABLE };
 enum enum_ha_read_modes { RFIRST, RNEXT, RPREV, RLAST, RKEY, RNEXT_SAME };
@@ -404,6 +424,7 @@ struct system_variables
   ulong read_rnd_buff_size;
   ulong div_precincrement;
   ulong sortbuff_size;
+  ulong sort_threads;
   ulong thread_handling;
   ulong tx_isolation;
   ulong completion_type;
@@ -526,9 +547,13 @@ typedef struct system_status_var
   ulong select_scan_count;
   ulong long_query_count;
   ulong filesort_merge_passes;
+  ulong filesort_pq_sorts;      /* LIMIT sorts done in a priority queue */
   ulong filesort_range_count;
   ulong filesort_rows;
   ulong filesort_scan_count;
+  ulong hash_group_spills;      /* GROUP BY partitions written to disk */
+  ulong plan_cache_hits;        /* Join orders reused, see choose_plan() */
+  ulong plan_cache_misses;
   /* Prepared statements and binary protocol */
   ulong com_stmt_prepare;
   ulong com_stmt_reprepare;
@@ -1380,6 +1405,8 @@ class THD :public Statement,
 public:
   /* Used to execute base64 coded binlog events in MySQL server */
   Relay_log_info* rli_fake;
+  /* Relay log info of a parallel slave worker, see rpl_parallel.h */
+  Relay_log_info* rli_slave;
 
   /*
     Constant for THD::where initialization in the beginning of every query.
@@ -1409,6 +1436,10 @@ public:
   struct st_mysql_stmt *current_stmt;
 #endif
   NET	  net;				// client connection descriptor
+#ifdef HAVE_QUERY_CACHE
+  /* Query cache partition net.query_cache_query belongs to */
+  Query_cache *query_cache_partition;
+#endif
   MEM_ROOT warn_root;			// For warnings and errors
   Protocol *protocol;			// Current protocol
   Protocol_text   protocol_text;	// Normal protocol
@@ -1439,6 +1470,15 @@ public:
   */
   enum_admission_control uses_admission_control;
 
+  /**
+    Per-database admission control pool the current command is charged to,
+    or NULL. ac_pool_running is set while this thread holds a slot in it,
+    ac_pool_admitted once the command got its first slot.
+  */
+  struct st_admission_pool *ac_pool;
+  bool ac_pool_running;
+  bool ac_pool_admitted;
+
   /* all prepared statements and cursors of this connection */
   Statement_map stmt_map;
   /*
@@ -3011,6 +3051,25 @@ public:
   bool send_data(List<Item> &items);
 };
 
+/*
+  Materialized IN subselect interface class: stores the distinct non-NULL
+  values of the subquery in a temporary table with a unique index
+*/
+class select_materialize_subselect :public select_subselect
+{
+  TMP_TABLE_PARAM tmp_table_param;
+public:
+  TABLE *table;
+  bool has_rows;                        /* the subquery returned a row */
+  bool has_null;                        /* ... whose value was NULL */
+  select_materialize_subselect(Item_subselect *item_arg)
+    :select_subselect(item_arg), table(0), has_rows(0), has_null(0)
+  {}
+  bool create_result_table(THD *thd, List<Item> *column_types);
+  bool send_data(List<Item> &items);
+  void cleanup();
+};
+
 /* Structs used when sorting */
 
 typedef struct st_sort_field {
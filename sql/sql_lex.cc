@@ -1623,6 +1623,7 @@ void st_select_lex::init_query()
   first_execution= 1;
   first_natural_join_processing= 1;
   first_cond_optimization= 1;
+  join_order_cache= 0;
   parsing_place= NO_MATTER;
   exclude_from_table_unique_test= no_wrap_view_item= FALSE;
   nest_level= 0;
@@ -1656,6 +1657,7 @@ void st_select_lex::init_select()
   offset_limit= 0;      /* denotes the default offset = 0 */
   with_sum_func= 0;
   is_correlated= 0;
+  sj_subselect= 0;
   cur_pos_in_select_list= UNDEF_POS;
   non_agg_fields.empty();
   cond_value= having_value= Item::COND_UNDEF;
@@ -2075,7 +2077,8 @@ void st_select_lex::print_limit(THD *thd,
        item->substype() == Item_subselect::IN_SUBS ||
        item->substype() == Item_subselect::ALL_SUBS))
   {
-    DBUG_ASSERT(!item->fixed ||
+    /* A materialized IN subquery reads all rows, it has no LIMIT 1 */
+    DBUG_ASSERT(!item->fixed || !select_limit ||
                 (select_limit->val_int() == LL(1) && offset_limit == 0));
     return;
   }
@@ -670,6 +670,16 @@ public:
   bool subquery_in_having;
   /* TRUE <=> this SELECT is correlated w.r.t. some ancestor select */
   bool is_correlated;
+  /*
+    IN subquery of the WHERE clause that JOIN::prepare merges into this
+    select as a semi-join (see Item_in_subselect::is_semijoin_candidate)
+  */
+  Item_in_subselect *sj_subselect;
+  /*
+    Join order kept between executions of a prepared statement or a
+    stored routine (see choose_plan())
+  */
+  struct st_join_order_cache *join_order_cache;
   /*
     This variable is required to ensure proper work of subqueries and
     stored procedures. Generally, one should use the states of
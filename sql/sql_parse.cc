@@ -1110,6 +1110,12 @@ bool dispatch_command(enum enum_server_command command, THD *thd,
     */
     if (admission_control_enter(thd, TRUE))
     {
+      if (thd->is_error())
+      {
+        /* Rejected by a full database pool, keep the connection */
+        net_end_statement(thd);
+        return FALSE;
+      }
       my_message(ER_ADMISSION_CONTROL_TIMEOUT, ER(ER_ADMISSION_CONTROL_TIMEOUT),
                  MYF(0));
       return TRUE;
@@ -7830,6 +7836,7 @@ bool reload_acl_and_cache(THD *thd, ulong options, TABLE_LIST *tables,
     reset_global_table_stats();
     reset_global_user_stats();
     reset_global_db_stats();
+    reset_admission_pools();
   }
 
  if (*write_to_binlog != -1)
@@ -8742,6 +8749,486 @@ bool parse_sql(THD *thd,
   return mysql_parse_status || thd->is_fatal_error;
 }
 
+/*
+  Per-database admission control pools, see sql_class.h. Pools are indexed
+  like global_db_stats_array; pool 0 is shared by commands without a
+  current database and by databases beyond MAX_DB_STATS_ENTRIES. All pool
+  state is protected by LOCK_admission_pools.
+*/
+
+#define ADMISSION_POOL_MAX_WEIGHT 100
+#define ADMISSION_POOL_WAIT_BUCKETS 6
+
+typedef struct st_admission_waiter
+{
+  pthread_cond_t cond;
+  struct st_admission_waiter *next;
+  ulonglong ticket;                     /* Arrival order across all pools */
+  bool granted;                         /* Set when handed a slot */
+} ADMISSION_WAITER;
+
+typedef struct st_admission_pool
+{
+  uint weight;
+  uint running;
+  uint queued;
+  ADMISSION_WAITER *head, *tail;        /* FIFO of waiting queries */
+
+  /* Reset by FLUSH STATISTICS */
+  ulonglong queries;                    /* Commands admitted */
+  ulonglong waits;                      /* Times a query was queued */
+  ulonglong rejected;                   /* Commands failed on max queued */
+  ulonglong aborted;                    /* Killed or closed while queued */
+  ulonglong wait_usecs;
+  /* Waits under 1ms, 10ms, 100ms, 1s, 10s and longer */
+  ulonglong wait_buckets[ADMISSION_POOL_WAIT_BUCKETS];
+} ADMISSION_POOL;
+
+static ADMISSION_POOL admission_pools[MAX_DB_STATS_ENTRIES + 1];
+static pthread_mutex_t LOCK_admission_pools;
+static bool admission_pools_inited= FALSE;
+static uint admission_pools_running= 0;
+static uint admission_pools_waiting= 0;
+static ulonglong admission_pools_ticket= 0;
+
+static inline uint admission_pool_max_running(ADMISSION_POOL *pool)
+{
+  /* Drain the queues when per-database admission control is disabled */
+  if (!admission_control_db_max_running)
+    return UINT_MAX;
+  return (uint) admission_control_db_max_running * pool->weight;
+}
+
+static inline bool admission_pools_full()
+{
+  return admission_control_db_max_running &&
+         admission_control_db_total_running &&
+         admission_pools_running >= admission_control_db_total_running;
+}
+
+static inline void admission_pool_admitted(THD *thd, ADMISSION_POOL *pool)
+{
+  thd->ac_pool_running= TRUE;
+  if (!thd->ac_pool_admitted)
+  {
+    thd->ac_pool_admitted= TRUE;
+    pool->queries++;
+  }
+}
+
+/**
+  Hand free slots to waiting queries. The pool with the lowest
+  running/weight ratio that is below its own limit goes first, the query
+  that has waited longest breaking ties.
+*/
+
+static void admission_pools_dispatch()
+{
+  safe_mutex_assert_owner(&LOCK_admission_pools);
+
+  while (admission_pools_waiting && !admission_pools_full())
+  {
+    ADMISSION_POOL *best= NULL;
+    uint i;
+
+    for (i= 0; i <= num_db_stats_entries; i++)
+    {
+      ADMISSION_POOL *pool= &admission_pools[i];
+      if (!pool->head || pool->running >= admission_pool_max_running(pool))
+        continue;
+      if (!best ||
+          pool->running * best->weight < best->running * pool->weight ||
+          (pool->running * best->weight == best->running * pool->weight &&
+           pool->head->ticket < best->head->ticket))
+        best= pool;
+    }
+    if (!best)
+      break;
+
+    ADMISSION_WAITER *waiter= best->head;
+    if (!(best->head= waiter->next))
+      best->tail= NULL;
+    best->queued--;
+    admission_pools_waiting--;
+    best->running++;
+    admission_pools_running++;
+    waiter->granted= TRUE;
+    pthread_cond_signal(&waiter->cond);
+  }
+}
+
+static void admission_pool_unlink(ADMISSION_POOL *pool,
+                                  ADMISSION_WAITER *waiter)
+{
+  ADMISSION_WAITER **prev= &pool->head, *last= NULL;
+
+  while (*prev != waiter)
+  {
+    last= *prev;
+    prev= &(*prev)->next;
+  }
+  *prev= waiter->next;
+  if (pool->tail == waiter)
+    pool->tail= last;
+  pool->queued--;
+  admission_pools_waiting--;
+}
+
+static const char *admission_pool_db(ADMISSION_POOL *pool)
+{
+  uint index= (uint) (pool - admission_pools);
+  return index ? global_db_stats_array[index].db : "";
+}
+
+static ADMISSION_POOL *admission_pool_for_db(const char *db)
+{
+  return &admission_pools[db ? get_db_stats_index(db) : 0];
+}
+
+/**
+  Take a slot in the pool of the current command.
+
+  When wait is FALSE the slot is taken immediately, possibly above the
+  limits. Otherwise the query waits its turn in the pool, unless this is
+  the first entry of the command and the queue is full.
+
+  @return 1 when the command was rejected, killed or the client went away
+*/
+
+static int admission_pool_enter(THD *thd, my_bool wait)
+{
+  ADMISSION_POOL *pool= thd->ac_pool;
+  ADMISSION_WAITER waiter;
+  ulonglong start, wait_usecs;
+  long use_nsec;
+  const char *old_msg;
+  uint bucket;
+  int res= 0;
+
+  DBUG_ENTER("admission_pool_enter");
+
+  pthread_mutex_lock(&LOCK_admission_pools);
+
+  if (!wait ||
+      (!pool->head && !admission_pools_full() &&
+       pool->running < admission_pool_max_running(pool)))
+  {
+    pool->running++;
+    admission_pools_running++;
+    admission_pool_admitted(thd, pool);
+    pthread_mutex_unlock(&LOCK_admission_pools);
+    DBUG_RETURN(0);
+  }
+
+  if (!thd->ac_pool_admitted && admission_control_db_max_queued &&
+      pool->queued >= admission_control_db_max_queued * pool->weight)
+  {
+    pool->rejected++;
+    pthread_mutex_unlock(&LOCK_admission_pools);
+    my_error(ER_DB_ADMISSION_CONTROL_QUEUE_FULL, MYF(0),
+             admission_pool_db(pool));
+    DBUG_RETURN(1);
+  }
+
+  pthread_cond_init(&waiter.cond, NULL);
+  waiter.next= NULL;
+  waiter.ticket= ++admission_pools_ticket;
+  waiter.granted= FALSE;
+  if (pool->tail)
+    pool->tail->next= &waiter;
+  else
+    pool->head= &waiter;
+  pool->tail= &waiter;
+  pool->queued++;
+  admission_pools_waiting++;
+  pool->waits++;
+
+  old_msg= thd->proc_info;
+  thd->proc_info= "wait for database admission pool";
+  pthread_mutex_unlock(&LOCK_admission_pools);
+  DEBUG_SYNC(thd, "admission_pool_waiting");
+  pthread_mutex_lock(&LOCK_admission_pools);
+
+  /* Wake up periodically to see if the query was killed */
+  use_nsec= (long) max(check_client_interval_msecs * 1000000.0,
+                       100.0 * 1000000.0);
+  start= my_micro_time();
+
+  while (!waiter.granted)
+  {
+    struct timespec abstime;
+    bool gone;
+
+    set_timespec_nsec(abstime, use_nsec);
+    pthread_cond_timedwait(&waiter.cond, &LOCK_admission_pools, &abstime);
+    if (waiter.granted)
+      break;
+
+    /* The limits may have been raised */
+    admission_pools_dispatch();
+    if (waiter.granted)
+      break;
+
+    /* Don't do this while holding LOCK_admission_pools */
+    pthread_mutex_unlock(&LOCK_admission_pools);
+    gone= thd->killed || !thd->is_connected();
+    pthread_mutex_lock(&LOCK_admission_pools);
+
+    if (gone && !waiter.granted)
+    {
+      admission_pool_unlink(pool, &waiter);
+      pool->aborted++;
+      res= 1;
+      break;
+    }
+  }
+
+  if (waiter.granted)
+  {
+    /* admission_pools_dispatch() has counted the slot */
+    admission_pool_admitted(thd, pool);
+
+    wait_usecs= my_micro_time() - start;
+    pool->wait_usecs+= wait_usecs;
+    for (bucket= 0; bucket < ADMISSION_POOL_WAIT_BUCKETS - 1 &&
+                    wait_usecs >= 1000; bucket++)
+      wait_usecs/= 10;
+    pool->wait_buckets[bucket]++;
+  }
+
+  pthread_mutex_unlock(&LOCK_admission_pools);
+  pthread_cond_destroy(&waiter.cond);
+  thd->proc_info= old_msg;
+  DBUG_RETURN(res);
+}
+
+static void admission_pool_exit(THD *thd)
+{
+  ADMISSION_POOL *pool= thd->ac_pool;
+
+  pthread_mutex_lock(&LOCK_admission_pools);
+  DBUG_ASSERT(pool->running > 0);
+  pool->running--;
+  admission_pools_running--;
+  thd->ac_pool_running= FALSE;
+  admission_pools_dispatch();
+  pthread_mutex_unlock(&LOCK_admission_pools);
+}
+
+typedef struct st_admission_weight
+{
+  char db[NAME_LEN + 1];
+  uint weight;
+} ADMISSION_WEIGHT;
+
+/**
+  Parse a comma separated list of db:weight pairs.
+
+  @return TRUE on a syntax error, a bad weight or too many databases
+*/
+
+static bool admission_pools_parse_weights(const char *str,
+                                          ADMISSION_WEIGHT *weights,
+                                          uint *count)
+{
+  const char *p= str;
+
+  *count= 0;
+  if (!*p)
+    return FALSE;
+
+  while (1)
+  {
+    const char *name= p, *colon;
+    char *end;
+    ulong weight;
+
+    if (!(colon= strchr(p, ':')) || colon == name ||
+        colon - name > NAME_LEN || memchr(name, ',', colon - name))
+      return TRUE;
+    if (!my_isdigit(system_charset_info, colon[1]))
+      return TRUE;
+    weight= strtoul(colon + 1, &end, 10);
+    if (weight < 1 || weight > ADMISSION_POOL_MAX_WEIGHT ||
+        (*end && *end != ','))
+      return TRUE;
+    if (*count == MAX_DB_STATS_ENTRIES)
+      return TRUE;
+    if (weights)
+    {
+      strmake(weights[*count].db, name, colon - name);
+      weights[*count].weight= (uint) weight;
+    }
+    (*count)++;
+    if (!*end)
+      return FALSE;
+    p= end + 1;
+  }
+}
+
+bool admission_pools_check_weights(const char *str)
+{
+  uint count;
+  return strlen(str) >= ADMISSION_CONTROL_DB_WEIGHTS_LEN ||
+         admission_pools_parse_weights(str, NULL, &count);
+}
+
+/**
+  Apply admission_control_db_weights. Listed databases are entered in the
+  db_stats index so that their pools exist before their first query.
+*/
+
+void admission_pools_set_weights(const char *str)
+{
+  ADMISSION_WEIGHT *weights;
+  uchar *index;
+  uint count, i;
+
+  if (!(weights= (ADMISSION_WEIGHT*)
+        my_malloc(MAX_DB_STATS_ENTRIES * (sizeof(ADMISSION_WEIGHT) + 1),
+                  MYF(MY_WME))))
+    return;
+  index= (uchar*) (weights + MAX_DB_STATS_ENTRIES);
+
+  if (admission_pools_parse_weights(str, weights, &count))
+    count= 0;
+  for (i= 0; i < count; i++)
+    index[i]= get_db_stats_index(weights[i].db);
+
+  pthread_mutex_lock(&LOCK_admission_pools);
+  for (i= 0; i <= MAX_DB_STATS_ENTRIES; i++)
+    admission_pools[i].weight= 1;
+  for (i= 0; i < count; i++)
+  {
+    if (index[i])
+      admission_pools[index[i]].weight= weights[i].weight;
+  }
+  admission_pools_dispatch();
+  pthread_mutex_unlock(&LOCK_admission_pools);
+
+  my_free(weights, MYF(0));
+}
+
+void init_admission_pools()
+{
+  pthread_mutex_init(&LOCK_admission_pools, MY_MUTEX_INIT_FAST);
+  bzero(admission_pools, sizeof(admission_pools));
+  admission_pools_inited= TRUE;
+  admission_pools_set_weights(admission_control_db_weights);
+}
+
+void free_admission_pools()
+{
+  if (!admission_pools_inited)
+    return;
+  admission_pools_inited= FALSE;
+  pthread_mutex_destroy(&LOCK_admission_pools);
+}
+
+void reset_admission_pools()
+{
+  pthread_mutex_lock(&LOCK_admission_pools);
+  for (uint i= 0; i <= MAX_DB_STATS_ENTRIES; i++)
+  {
+    ADMISSION_POOL *pool= &admission_pools[i];
+    pool->queries= pool->waits= pool->rejected= pool->aborted= 0;
+    pool->wait_usecs= 0;
+    bzero(pool->wait_buckets, sizeof(pool->wait_buckets));
+  }
+  pthread_mutex_unlock(&LOCK_admission_pools);
+}
+
+int fill_admission_pools(THD *thd, TABLE_LIST *tables, COND *cond)
+{
+  TABLE *table= tables->table;
+  ADMISSION_POOL *pools;
+  uint count, i, j;
+  DBUG_ENTER("fill_admission_pools");
+
+  if (!(pools= (ADMISSION_POOL*) thd->alloc(sizeof(admission_pools))))
+    DBUG_RETURN(1);
+
+  pthread_mutex_lock(&LOCK_admission_pools);
+  count= num_db_stats_entries + 1;
+  memcpy(pools, admission_pools, count * sizeof(ADMISSION_POOL));
+  pthread_mutex_unlock(&LOCK_admission_pools);
+
+  for (i= 0; i < count; i++)
+  {
+    ADMISSION_POOL *pool= &pools[i];
+    uint f= 0;
+
+    /* Only show pools that were used or configured */
+    if (!pool->queries && !pool->running && !pool->queued &&
+        !pool->rejected && !pool->aborted && pool->weight == 1)
+      continue;
+
+    restore_record(table, s->default_values);
+    if (i)
+    {
+      table->field[f]->set_notnull();
+      table->field[f]->store(global_db_stats_array[i].db,
+                             strlen(global_db_stats_array[i].db),
+                             system_charset_info);
+    }
+    f++;
+    table->field[f++]->store(pool->weight, TRUE);
+    table->field[f++]->store((ulonglong) admission_control_db_max_running *
+                             pool->weight, TRUE);
+    table->field[f++]->store((ulonglong) admission_control_db_max_queued *
+                             pool->weight, TRUE);
+    table->field[f++]->store(pool->running, TRUE);
+    table->field[f++]->store(pool->queued, TRUE);
+    table->field[f++]->store(pool->queries, TRUE);
+    table->field[f++]->store(pool->waits, TRUE);
+    table->field[f++]->store(pool->rejected, TRUE);
+    table->field[f++]->store(pool->aborted, TRUE);
+    table->field[f++]->store(pool->wait_usecs, TRUE);
+    for (j= 0; j < ADMISSION_POOL_WAIT_BUCKETS; j++)
+      table->field[f++]->store(pool->wait_buckets[j], TRUE);
+
+    if (schema_table_store_record(thd, table))
+      DBUG_RETURN(1);
+  }
+  DBUG_RETURN(0);
+}
+
+ST_FIELD_INFO admission_pools_fields_info[]=
+{
+  {"DB", NAME_LEN, MYSQL_TYPE_STRING, 0, MY_I_S_MAYBE_NULL, 0,
+   SKIP_OPEN_TABLE},
+  {"WEIGHT", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"MAX_RUNNING", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"MAX_QUEUED", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"RUNNING", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"QUEUED", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"QUERIES", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"WAITS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"REJECTED", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"ABORTED", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"WAIT_USECS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"WAITS_UNDER_1MS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"WAITS_UNDER_10MS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"WAITS_UNDER_100MS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"WAITS_UNDER_1S", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"WAITS_UNDER_10S", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"WAITS_OVER_10S", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE}
+};
+
 /* TODO(mcallaghan/chip): count time here blocked per-user */
 
 /* TODO(mcallaghan/chip): Should we allow bursting above the user's
@@ -8796,6 +9283,10 @@ AdmissionControlBarrier::AdmissionControlBarrier(THD* thd) : thd_(thd), entered_
     thd->uses_admission_control =
         (admission_control && uc->user_resources.max_concurrent_queries)
         ? QUERY_SCHEDULED : QUERY_COUNTED;
+
+    DBUG_ASSERT(!thd->ac_pool_running);
+    if (admission_control_db_max_running)
+      thd->ac_pool= admission_pool_for_db(thd->db);
   }
 }
 
@@ -8803,7 +9294,13 @@ AdmissionControlBarrier::~AdmissionControlBarrier() {
   if (entered_)
     admission_control_exit(thd_);
 
+  /* Re-entry may have taken a pool slot when entry was skipped */
+  if (thd_->ac_pool_running)
+    admission_pool_exit(thd_);
+
   thd_->uses_admission_control= QUERY_NOT_SCHEDULED;
+  thd_->ac_pool= NULL;
+  thd_->ac_pool_admitted= FALSE;
 }
 
 void AdmissionControlBarrier::Entered() { entered_= TRUE; }
@@ -8829,7 +9326,7 @@ void AdmissionControlBarrier::Entered() { entered_= TRUE; }
       @retval 0 otherwise
  */
 
-int admission_control_enter(THD* thd, my_bool wait)
+static int admission_control_user_enter(THD* thd, my_bool wait)
 {
   USER_CONN *uc = thd->user_connect;
   double check_nsec;
@@ -8983,7 +9480,7 @@ int admission_control_enter(THD* thd, my_bool wait)
   }
 }
 
-void admission_control_exit(THD* thd)
+static void admission_control_user_exit(THD* thd)
 {
   USER_CONN *uc= thd->user_connect;
 
@@ -9047,6 +9544,35 @@ void admission_control_exit(THD* thd)
   DBUG_VOID_RETURN;
 }
 
+/**
+  Enter the per-user limit and then the pool of the current database.
+  See admission_control_user_enter for the meaning of wait.
+*/
+
+int admission_control_enter(THD* thd, my_bool wait)
+{
+  if (admission_control_user_enter(thd, wait))
+    return 1;
+
+  if (thd->ac_pool && !thd->ac_pool_running &&
+      thd->uses_admission_control != QUERY_NOT_SCHEDULED &&
+      admission_pool_enter(thd, wait))
+  {
+    /* This guarantees that admission_control_exit does nothing */
+    admission_control_user_exit(thd);
+    thd->uses_admission_control= QUERY_NOT_SCHEDULED;
+    return 1;
+  }
+  return 0;
+}
+
+void admission_control_exit(THD* thd)
+{
+  admission_control_user_exit(thd);
+  if (thd->ac_pool_running)
+    admission_pool_exit(thd);
+}
+
 int admission_control_diskio_enter(THD* thd, bool diskio_used_for_exit)
 {
   if (diskio_used_for_exit) {
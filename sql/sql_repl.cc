@@ -2207,6 +2207,10 @@ static sys_var_const    sys_slave_skip_errors(&vars, "slave_skip_errors",
                                               (uchar*) slave_skip_error_names);
 static sys_var_long_ptr	sys_slave_trans_retries(&vars, "slave_transaction_retries",
 						&slave_trans_retries);
+static sys_var_long_ptr	sys_slave_parallel_workers(&vars, "slave_parallel_workers",
+						   &slave_parallel_workers);
+static sys_var_long_ptr	sys_slave_parallel_queue_size(&vars, "slave_parallel_queue_size",
+						      &slave_parallel_queue_size);
 static sys_var_sync_binlog_period sys_sync_binlog_period(&vars, "sync_binlog", &sync_binlog_period);
 static sys_var_long_ptr sys_group_commit_timeout_usecs(&vars, "group_commit_timeout_usecs", &group_commit_timeout_usecs);
 static sys_var_long_ptr sys_group_commit_min_size(&vars, "group_commit_min_size", &group_commit_min_size);
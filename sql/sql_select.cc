@@ -70,6 +70,8 @@ static void best_access_path(JOIN *join, JOIN_TAB *s, THD *thd,
                              table_map remaining_tables, uint idx,
                              double record_count, double read_time);
 static void optimize_straight_join(JOIN *join, table_map join_tables);
+static bool get_cached_join_order(JOIN *join, table_map join_tables);
+static void cache_join_order(JOIN *join);
 static bool greedy_search(JOIN *join, table_map remaining_tables,
                              uint depth, uint prune_level);
 static bool best_extension_by_limited_search(JOIN *join,
@@ -84,6 +86,8 @@ static int join_tab_cmp_straight(const void* ptr1, const void* ptr2);
   TODO: 'find_best' is here only temporarily until 'greedy_search' is
   tested and approved.
 */
+static void advance_sj_state(JOIN *join, uint idx, double *record_count,
+                             double *read_time);
 static bool find_best(JOIN *join,table_map rest_tables,uint index,
 		      double record_count,double read_time);
 static uint cache_record_length(JOIN *join,uint index);
@@ -96,6 +100,7 @@ static store_key *get_store_key(THD *thd,
 static void make_outerjoin_info(JOIN *join);
 static bool make_join_select(JOIN *join,SQL_SELECT *select,COND *item);
 static void make_join_readinfo(JOIN *join, ulonglong options);
+static bool setup_semijoin_strategy(JOIN *join, bool describe);
 static bool only_eq_ref_tables(JOIN *join, ORDER *order, table_map tables);
 static void update_depend_map(JOIN *join);
 static void update_depend_map(JOIN *join, ORDER *order);
@@ -148,6 +153,11 @@ end_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 static enum_nested_loop_state
 end_unique_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 static enum_nested_loop_state
+end_hash_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
+static bool hash_group_usable(JOIN *join, TABLE *table);
+static bool hash_group_init(JOIN *join, TABLE *table);
+static void hash_group_free(HASH_GROUP *hg);
+static enum_nested_loop_state
 end_write_group(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 
 static int test_if_group_changed(List<Cached_item> &list);
@@ -165,6 +175,8 @@ static int test_if_quick_select(JOIN_TAB *tab);
 static int join_init_read_record(JOIN_TAB *tab);
 static int join_read_first(JOIN_TAB *tab);
 static int join_read_next(READ_RECORD *info);
+static int join_read_loosescan_first(JOIN_TAB *tab);
+static int join_read_loosescan_next(READ_RECORD *info);
 static int join_read_next_same(READ_RECORD *info);
 static int join_read_last(JOIN_TAB *tab);
 static int join_read_prev_same(READ_RECORD *info);
@@ -196,6 +208,10 @@ static int remove_dup_with_hash_index(THD *thd,TABLE *table,
 
 				      ulong key_length,Item *having);
 static int join_init_cache(THD *thd,JOIN_TAB *tables,uint table_count);
+static void join_init_hash_keys(THD *thd, JOIN *join, JOIN_TAB *tab);
+static void join_cache_hash_build(JOIN_TAB *tab, uint records);
+static uint join_cache_bka_build(JOIN_TAB *tab);
+static bool join_cache_hash_key(Field **fields, uint keys, ulong *hash);
 static ulong used_blob_length(CACHE_FIELD **ptr);
 static bool store_record_in_cache(JOIN_CACHE *cache);
 static void reset_cache_read(JOIN_CACHE *cache);
@@ -471,6 +487,123 @@ inline int setup_without_group(THD *thd, Item **ref_pointer_array,
   DBUG_RETURN(res);
 }
 
+
+/**
+  Merge the IN subquery found by Item_in_subselect::is_semijoin_candidate
+  into the select of the join.
+
+  The subquery tables become inner tables of a semi-join, and the IN
+  predicate is replaced by the WHERE clause of the subquery and an
+  equality of the left expression with the selected value. The join
+  yields an outer row combination once per matching subquery row; the
+  optimizer chooses how to pass it on only once (see advance_sj_state).
+
+  @param join   join of the outer select, prepared
+
+  @retval FALSE  OK
+  @retval TRUE   error
+*/
+
+static bool convert_subquery_to_semijoin(JOIN *join)
+{
+  THD *thd= join->thd;
+  SELECT_LEX *outer= join->select_lex;
+  Item_in_subselect *subselect= outer->sj_subselect;
+  Item_in_optimizer *optimizer= subselect->get_optimizer();
+  SELECT_LEX *child= subselect->get_select_lex();
+  Item *inner_item= child->item_list.head();
+  Item *left_expr= optimizer->arguments()[0];
+  Item *child_where= child->join->conds;
+  Item *eq, *cond;
+  Item_cond_and *and_cond;
+  TABLE_LIST *tl, **last_leaf;
+  table_map inner_tables= 0;
+  DBUG_ENTER("convert_subquery_to_semijoin");
+
+  outer->sj_subselect= 0;
+
+  /* Number the subquery tables after the outer ones */
+  for (last_leaf= &outer->leaf_tables; *last_leaf;
+       last_leaf= &(*last_leaf)->next_leaf) ;
+  *last_leaf= child->leaf_tables;
+  for (tl= child->leaf_tables; tl; tl= tl->next_leaf)
+  {
+    TABLE *table= tl->table;
+    table->tablenr= join->tables++;
+    table->map= (table_map) 1 << table->tablenr;
+    inner_tables|= table->map;
+    tl->select_lex= outer;
+    tl->sj_inner= TRUE;
+    tl->join_list= &outer->top_join_list;
+  }
+  outer->top_join_list.prepand(&child->top_join_list);
+
+  /* References of the subquery to the outer select become local */
+  if (child_where)
+  {
+    child_where->walk(&Item::remove_dependence_processor, 0, (uchar*) outer);
+    child_where->update_used_tables();
+  }
+  inner_item->walk(&Item::remove_dependence_processor, 0, (uchar*) outer);
+  inner_item->update_used_tables();
+
+  if (!(eq= new Item_func_eq(left_expr, inner_item)))
+    DBUG_RETURN(TRUE);
+  if (join->conds == optimizer)
+    join->conds= eq;
+  else
+  {
+    Item *item;
+    List_iterator<Item> li(*((Item_cond*) join->conds)->argument_list());
+    while ((item= li++) && item != optimizer) ;
+    DBUG_ASSERT(item);
+    li.replace(eq);
+  }
+  if (!(and_cond= new Item_cond_and()) || and_cond->add(join->conds) ||
+      (child_where && and_cond->add(child_where)))
+    DBUG_RETURN(TRUE);
+  cond= and_cond;
+  cond->top_level_item();
+  if (cond->fix_fields(thd, &cond))
+    DBUG_RETURN(TRUE);
+  join->conds= cond;
+  outer->cond_count+= child->cond_count + 2;
+  outer->between_count+= child->between_count;
+  set_if_bigger(outer->max_equal_elems, child->max_equal_elems);
+
+  join->sj_inner_tables= inner_tables;
+  join->sj_depends= (eq->used_tables() |
+                     (child_where ? child_where->used_tables() : 0)) &
+                    ~(inner_tables | PSEUDO_TABLE_BITS);
+  join->sj_corr_tables= (child_where ? child_where->used_tables() : 0) &
+                        ~(inner_tables | PSEUDO_TABLE_BITS);
+
+  /*
+    LooseScan reads the distinct values of a subquery column from an
+    index, which must be those the equality tells apart
+  */
+  if (inner_item->real_item()->type() == Item::FIELD_ITEM &&
+      left_expr->result_type() == inner_item->result_type() &&
+      ((inner_item->result_type() == INT_RESULT &&
+        left_expr->field_type() != MYSQL_TYPE_BIT &&
+        inner_item->field_type() != MYSQL_TYPE_BIT) ||
+       (inner_item->result_type() == STRING_RESULT &&
+        !left_expr->is_datetime() && !inner_item->is_datetime() &&
+        left_expr->collation.collation == inner_item->collation.collation)))
+    join->sj_inner_field= (Item_field*) inner_item->real_item();
+
+  /* The subquery is gone */
+  if (child->cleanup())
+    DBUG_RETURN(TRUE);
+  child->master_unit()->exclude_level();
+  if ((outer->options & SELECT_DESCRIBE) && outer->type &&
+      outer == &thd->lex->select_lex &&
+      !outer->first_inner_unit() && !outer->next_select())
+    outer->type= "SIMPLE";
+  DBUG_RETURN(FALSE);
+}
+
+
 /*****************************************************************************
   Check fields, find best join, do the select and output fields.
   mysql_select assumes that all tables are already opened
@@ -546,6 +679,9 @@ JOIN::prepare(Item ***rref_pointer_array,
 			  &hidden_group_fields))
     DBUG_RETURN(-1);				/* purecov: inspected */
 
+  if (select_lex->sj_subselect && convert_subquery_to_semijoin(this))
+    DBUG_RETURN(-1);
+
   ref_pointer_array= *rref_pointer_array;
   
   if (having)
@@ -1396,6 +1532,10 @@ JOIN::optimize()
 	      test(select_options & OPTION_BUFFER_RESULT))) ||
              (rollup.state != ROLLUP::STATE_NONE && select_distinct));
 
+  if (sj_inner_tables &&
+      setup_semijoin_strategy(this, test(select_options & SELECT_DESCRIBE)))
+    DBUG_RETURN(1);
+
   // No cache for MATCH
   make_join_readinfo(this,
 		     (select_options & (SELECT_DESCRIBE |
@@ -2428,6 +2568,10 @@ JOIN::destroy()
     free_tmp_table(thd, exec_tmp_table1);
   if (exec_tmp_table2)
     free_tmp_table(thd, exec_tmp_table2);
+  if (sj_tmp_table)
+    free_tmp_table(thd, sj_tmp_table);
+  if (sj_tmp_table_param)
+    sj_tmp_table_param->cleanup();
   delete select;
   delete_dynamic(&keyuse);
   delete procedure;
@@ -4838,9 +4982,19 @@ best_access_path(JOIN      *join,
 static bool
 choose_plan(JOIN *join, table_map join_tables)
 {
+  THD *thd= join->thd;
   uint search_depth= join->thd->variables.optimizer_search_depth;
   uint prune_level=  join->thd->variables.optimizer_prune_level;
   bool straight_join= test(join->select_options & SELECT_STRAIGHT_JOIN);
+  /*
+    The join order of a statement that is executed again is kept for the
+    next executions.
+  */
+  bool use_cache= (!straight_join &&
+                   !thd->stmt_arena->is_conventional() &&
+                   join->tables - join->const_tables > 1 &&
+                   (thd->variables.optimizer_switch &
+                    OPTIMIZER_SWITCH_PLAN_CACHE));
   DBUG_ENTER("choose_plan");
 
   join->cur_embedding_map= 0;
@@ -4861,6 +5015,10 @@ choose_plan(JOIN *join, table_map join_tables)
   {
     optimize_straight_join(join, join_tables);
   }
+  else if (use_cache && get_cached_join_order(join, join_tables))
+  {
+    status_var_increment(thd->status_var.plan_cache_hits);
+  }
   else
   {
     if (search_depth == MAX_TABLES+2)
@@ -4880,6 +5038,11 @@ choose_plan(JOIN *join, table_map join_tables)
       if (greedy_search(join, join_tables, search_depth, prune_level))
         DBUG_RETURN(TRUE);
     }
+    if (use_cache)
+    {
+      status_var_increment(thd->status_var.plan_cache_misses);
+      cache_join_order(join);
+    }
   }
 
   /* 
@@ -4894,6 +5057,100 @@ choose_plan(JOIN *join, table_map join_tables)
 }
 
 
+/* The JOIN_TAB of the table number 'tablenr' */
+
+static JOIN_TAB *join_tab_by_tablenr(JOIN *join, uint tablenr)
+{
+  for (JOIN_TAB *s= join->join_tab, *end= s + join->tables; s < end; s++)
+  {
+    if (s->table->tablenr == tablenr)
+      return s;
+  }
+  return 0;
+}
+
+
+/**
+  Take the join order of the last execution of the statement.
+
+  The order is still good if the same tables were found constant, which
+  depends on the parameters of the statement, and if the number of rows
+  that range analysis expects from each table is within a factor of two
+  of the estimate of the cached plan. The access method of each table
+  is chosen again by optimize_straight_join().
+
+  @param join         Join being optimized
+  @param join_tables  Tables to order
+
+  @retval
+    TRUE   The plan is in join->best_positions
+  @retval
+    FALSE  There is no cached order or it is stale
+*/
+
+static bool get_cached_join_order(JOIN *join, table_map join_tables)
+{
+  JOIN_ORDER_CACHE *cache= join->select_lex->join_order_cache;
+  JOIN_TAB *order[MAX_TABLES];
+  table_map found_tables;
+  uint idx;
+  DBUG_ENTER("get_cached_join_order");
+
+  if (!cache || cache->tables != join->tables ||
+      cache->const_tables != join->const_table_map)
+    DBUG_RETURN(FALSE);
+  found_tables= join->const_table_map;
+  for (idx= join->const_tables; idx < join->tables; idx++)
+  {
+    JOIN_TAB *s= join_tab_by_tablenr(join, cache->order[idx]);
+    ha_rows records= cache->records[idx];
+    if (!s || (s->dependent & ~found_tables) ||
+        s->found_records > records * 2 + 1 ||
+        records > s->found_records * 2 + 1)
+      DBUG_RETURN(FALSE);
+    order[idx]= s;
+    found_tables|= s->table->map;
+  }
+  for (idx= join->const_tables; idx < join->tables; idx++)
+    join->best_ref[idx]= order[idx];
+  optimize_straight_join(join, join_tables);
+  DBUG_RETURN(TRUE);
+}
+
+
+/**
+  Keep the join order found by the search for the next executions of the
+  statement, see get_cached_join_order().
+*/
+
+static void cache_join_order(JOIN *join)
+{
+  JOIN_ORDER_CACHE *cache= join->select_lex->join_order_cache;
+  uint idx;
+
+  if (!cache || cache->tables != join->tables)
+  {
+    /* Allocated once, in the memory of the statement */
+    MEM_ROOT *mem_root= join->thd->stmt_arena->mem_root;
+    if (!(cache= (JOIN_ORDER_CACHE*) alloc_root(mem_root, sizeof(*cache))) ||
+        !(cache->order= (uint*) alloc_root(mem_root,
+                                           sizeof(uint) * join->tables)) ||
+        !(cache->records= (ha_rows*) alloc_root(mem_root, sizeof(ha_rows) *
+                                                join->tables)))
+      return;
+    cache->tables= join->tables;
+    join->select_lex->join_order_cache= cache;
+  }
+  cache->const_tables= join->const_table_map;
+  for (idx= join->const_tables; idx < join->tables; idx++)
+  {
+    JOIN_TAB *s= join->best_positions[idx].table;
+    cache->order[idx]= s->table->tablenr;
+    cache->records[idx]= s->found_records;
+  }
+}
+
+
 /**
   Compare two JOIN_TAB objects based on the number of accessed records.
 
@@ -5007,6 +5264,131 @@ determine_search_depth(JOIN *join)
 }
 
 
+/*
+  Cost of writing an outer row combination to the duplicate weedout
+  table, relative to reading a row
+*/
+#define SJ_WEEDOUT_ROW_COST 0.05
+
+/**
+  Find an index LooseScan can read the subquery column of a semi-join
+  from: its first key part is the whole column and it is read in order.
+
+  @return number of the index, or MAX_KEY if there is none
+*/
+
+static uint get_loosescan_key(JOIN *join, JOIN_TAB *s)
+{
+  TABLE *table= s->table;
+  Field *field;
+  uint key, best= MAX_KEY;
+
+  if (!join->sj_inner_field ||
+      (field= join->sj_inner_field->field)->table != table)
+    return MAX_KEY;
+  for (key= 0; key < table->s->keys; key++)
+  {
+    KEY *keyinfo= table->key_info + key;
+    if (!table->keys_in_use_for_query.is_set(key) ||
+        keyinfo->key_part->field != field ||
+        (keyinfo->key_part->key_part_flag & HA_PART_KEY_SEG) ||
+        (keyinfo->flags & (HA_FULLTEXT | HA_SPATIAL)) ||
+        !(table->file->index_flags(key, 0, 1) & HA_READ_ORDER))
+      continue;
+    /* Prefer an index that covers the columns used */
+    if (best == MAX_KEY ||
+        (table->covering_keys.is_set(key) &&
+         !table->covering_keys.is_set(best)))
+      best= key;
+  }
+  return best;
+}
+
+
+/**
+  Choose the strategy that passes on each outer row combination of the
+  semi-join (see convert_subquery_to_semijoin) only once, when the table
+  at position idx is the last of its inner tables in the partial plan,
+  and account for it in the estimates of the plan.
+
+  - FirstMatch: the inner tables follow each other after all the outer
+    tables the semi-join condition uses; the join goes back to the outer
+    table before them at the first match.
+  - LooseScan: the only inner table comes after the outer tables the
+    subquery WHERE clause uses and is read in the order of an index on
+    the subquery column; only the first row of each key value is passed
+    on.
+  - Duplicate weedout: the rowids of the outer tables are written to a
+    temporary table with a unique key, and combinations found in it are
+    dropped. It always applies.
+
+  @param join          the join
+  @param idx           position of the table just added to the plan
+  @param record_count  in/out: rows of the partial plan
+  @param read_time     in/out: cost of the partial plan
+*/
+
+static void
+advance_sj_state(JOIN *join, uint idx, double *record_count,
+                 double *read_time)
+{
+  POSITION *pos= join->positions + idx;
+  table_map prefix= 0, outer_prefix= 0;
+  double inner_fanout= 1.0;
+  bool contiguous= TRUE;
+  uint first= idx, key, i;
+
+  pos->sj_strategy= SJ_OPT_NONE;
+  if (!(pos->table->table->map & join->sj_inner_tables))
+    return;
+  for (i= 0; i <= idx; i++)
+  {
+    table_map map= join->positions[i].table->table->map;
+    if ((map & join->sj_inner_tables) && i >= join->const_tables)
+    {
+      set_if_smaller(first, i);
+      inner_fanout*= join->positions[i].records_read;
+    }
+    else if (i > first)
+      contiguous= FALSE;
+    prefix|= map;
+    if (i < first)
+      outer_prefix|= map;
+  }
+  if ((prefix & join->sj_inner_tables) != join->sj_inner_tables)
+    return;                                     // More inner tables follow
+
+  if (contiguous && !(join->sj_depends & ~outer_prefix))
+  {
+    pos->sj_strategy= SJ_OPT_FIRST_MATCH;
+    if (inner_fanout > 1.0)
+      *record_count/= inner_fanout;
+  }
+  else if (first == idx && !pos->key && !pos->table->quick &&
+           !(join->sj_corr_tables & ~outer_prefix) &&
+           /* Sorting the first table would change its read order */
+           (idx > join->const_tables ||
+            !(join->order || join->group_list || join->select_distinct)) &&
+           (key= get_loosescan_key(join, pos->table)) != MAX_KEY)
+  {
+    KEY *keyinfo= pos->table->table->key_info + key;
+    double distinct= (double) pos->table->records;
+    if (keyinfo->rec_per_key && keyinfo->rec_per_key[0])
+      distinct/= keyinfo->rec_per_key[0];
+    set_if_smaller(distinct, inner_fanout);
+    pos->sj_strategy= SJ_OPT_LOOSE_SCAN;
+    pos->loosescan_key= key;
+    if (inner_fanout > 1.0)
+      *record_count*= distinct / inner_fanout;
+  }
+  else
+  {
+    pos->sj_strategy= SJ_OPT_DUPS_WEEDOUT;
+    *read_time+= *record_count * SJ_WEEDOUT_ROW_COST;
+  }
+}
+
+
 /**
   Select the best ways to access the tables in a query without reordering them.
 
@@ -5046,6 +5428,7 @@ optimize_straight_join(JOIN *join, table_map join_tables)
     /* compute the cost of the new plan extended with 's' */
     record_count*= join->positions[idx].records_read;
     read_time+=    join->positions[idx].read_time;
+    advance_sj_state(join, idx, &record_count, &read_time);
     join_tables&= ~(s->table->map);
     ++idx;
   }
@@ -5218,6 +5601,7 @@ greedy_search(JOIN      *join,
     /* compute the cost of the new plan extended with 'best_table' */
     record_count*= join->positions[idx].records_read;
     read_time+=    join->positions[idx].read_time;
+    advance_sj_state(join, idx, &record_count, &read_time);
 
     remaining_tables&= ~(best_table->table->map);
     --size_remain;
@@ -5391,6 +5775,7 @@ best_extension_by_limited_search(JOIN      *join,
       /* Compute the cost of extending the plan with 's' */
       current_record_count= record_count * join->positions[idx].records_read;
       current_read_time=    read_time + join->positions[idx].read_time;
+      advance_sj_state(join, idx, &current_record_count, &current_read_time);
 
       /* Expand only partial plans with lower cost than the best QEP so far */
       if ((current_read_time +
@@ -5540,6 +5925,7 @@ find_best(JOIN *join,table_map rest_tables,uint idx,double record_count,
       */
       double current_record_count=record_count*records;
       double current_read_time=read_time+best;
+      advance_sj_state(join, idx, &current_record_count, &current_read_time);
       if (best_record_count > current_record_count ||
 	  best_read_time > current_read_time ||
 	  (idx == join->const_tables && s->table == join->sort_by_table))
@@ -6046,6 +6432,10 @@ JOIN::make_simple_join(JOIN *parent, TABLE *temp_table)
   join_tab->first_unmatched= 0;
   join_tab->ref.key = -1;
   join_tab->not_used_in_distinct=0;
+  join_tab->sj_strategy= SJ_OPT_NONE;
+  join_tab->last_sj_inner_tab= 0;
+  join_tab->loosescan_buf= 0;
+  join_tab->check_weed_out= FALSE;
   join_tab->read_first_record= join_init_read_record;
   join_tab->join= this;
   join_tab->ref.key_parts= 0;
@@ -6789,6 +7179,27 @@ make_join_readinfo(JOIN *join, ulonglong options)
       }
       delete tab->quick;
       tab->quick=0;
+      /*
+        Batched key access: buffer the records of the previous tables like
+        for JT_ALL and look up their keys together.
+      */
+      tab->cache.hash_keys= 0;
+      tab->cache.bka_key_length= 0;
+      if (tab->type != JT_REF_OR_NULL &&
+          optimizer_flag(join->thd, OPTIMIZER_SWITCH_BATCHED_KEY_ACCESS) &&
+          i != join->const_tables && !(options & SELECT_NO_JOIN_CACHE) &&
+          !tab->first_inner && !ordered_set &&
+          !tab->last_sj_inner_tab && tab->sj_strategy != SJ_OPT_LOOSE_SCAN &&
+          join->join_tab[join->tables - 1].sj_strategy != SJ_OPT_DUPS_WEEDOUT)
+      {
+        tab->cache.bka_key_length= tab->ref.key_length;
+        if ((options & SELECT_DESCRIBE) ||
+            !join_init_cache(join->thd, join->join_tab + join->const_tables,
+                             i - join->const_tables))
+          tab[-1].next_select=sub_select_cache; /* Patch previous */
+        else
+          tab->cache.bka_key_length= 0;
+      }
       /* fall through */
     case JT_CONST:				// Only happens with left join
       if (table->covering_keys.is_set(tab->ref.key) &&
@@ -6800,9 +7211,15 @@ make_join_readinfo(JOIN *join, ulonglong options)
 	If previous table use cache
         If the incoming data set is already sorted don't use cache.
       */
+      tab->cache.hash_keys= 0;
+      tab->cache.bka_key_length= 0;
       if (i != join->const_tables && !(options & SELECT_NO_JOIN_CACHE) &&
-          tab->use_quick != 2 && !tab->first_inner && !ordered_set)
+          tab->use_quick != 2 && !tab->first_inner && !ordered_set &&
+          !tab->last_sj_inner_tab && tab->sj_strategy != SJ_OPT_LOOSE_SCAN &&
+          join->join_tab[join->tables - 1].sj_strategy != SJ_OPT_DUPS_WEEDOUT)
       {
+        if (optimizer_flag(join->thd, OPTIMIZER_SWITCH_JOIN_CACHE_HASH))
+          join_init_hash_keys(join->thd, join, tab);
 	if ((options & SELECT_DESCRIBE) ||
 	    !join_init_cache(join->thd,join->join_tab+join->const_tables,
 			     i-join->const_tables))
@@ -6886,12 +7303,140 @@ make_join_readinfo(JOIN *join, ulonglong options)
     case JT_MAYBE_REF:
       abort();					/* purecov: deadcode */
     }
+    if (tab->sj_strategy == SJ_OPT_LOOSE_SCAN)
+    {
+      /* Read the table in the order of the key, see advance_sj_state() */
+      if (tab->select)
+      {
+        delete tab->select->quick;
+        tab->select->quick= 0;
+      }
+      delete tab->quick;
+      tab->quick= 0;
+      tab->use_quick= 0;
+      tab->index= join->best_positions[i].loosescan_key;
+      tab->type= JT_NEXT;
+      tab->read_first_record= join_read_loosescan_first;
+      table->set_keyread(FALSE);
+    }
   }
   join->join_tab[join->tables-1].next_select=0; /* Set by do_select */
   DBUG_VOID_RETURN;
 }
 
 
+/**
+  Create the temporary table of duplicate weedout: its unique key is the
+  rowids of the outer tables of the semi-join.
+
+  @retval FALSE  OK
+  @retval TRUE   error
+*/
+
+static bool create_sj_weedout_table(JOIN *join)
+{
+  THD *thd= join->thd;
+  JOIN_TAB *tab, *end= join->join_tab + join->tables;
+  TABLE *first_table= 0;
+  TMP_TABLE_PARAM *param;
+  Field_string *field;
+  Item_field *ifield;
+  List<Item> fields;
+  ORDER group;
+  uint length= 0;
+  DBUG_ENTER("create_sj_weedout_table");
+
+  for (tab= join->join_tab + join->const_tables; tab < end; tab++)
+  {
+    TABLE *table= tab->table;
+    if (table->map & join->sj_inner_tables)
+      continue;
+    if (!first_table)
+      first_table= table;
+    table->prepare_for_position();
+    length+= table->file->ref_length;
+  }
+  DBUG_ASSERT(first_table);
+
+  if (!(field= new Field_string(length, 0, "rowids", &my_charset_bin)))
+    DBUG_RETURN(TRUE);
+  field->init(first_table);
+  field->can_alter_field_type= 0;
+  if (!(ifield= new Item_field((Field*) field)) || fields.push_back(ifield))
+    DBUG_RETURN(TRUE);
+  ifield->maybe_null= 0;
+
+  bzero((char*) &group, sizeof(group));
+  group.asc= 1;
+  group.item= (Item**) fields.head_ref();
+  if (!(param= new TMP_TABLE_PARAM))
+    DBUG_RETURN(TRUE);
+  param->init();
+  param->quick_group= 1;
+  param->field_count= 1;
+  param->group_parts= 1;
+  param->group_length= length;
+  join->sj_tmp_table_param= param;
+  if (!(join->sj_tmp_table= create_tmp_table(thd, param, fields,
+                                             &group, 0, 0,
+                                             TMP_TABLE_ALL_COLUMNS,
+                                             HA_POS_ERROR, (char *) "")))
+    DBUG_RETURN(TRUE);
+  end[-1].check_weed_out= TRUE;
+  DBUG_RETURN(FALSE);
+}
+
+
+/**
+  Set up the join tabs for the semi-join strategy the optimizer chose
+  (see advance_sj_state).
+
+  @param join      the join
+  @param describe  TRUE for EXPLAIN: nothing is executed
+
+  @retval FALSE  OK
+  @retval TRUE   error
+*/
+
+static bool setup_semijoin_strategy(JOIN *join, bool describe)
+{
+  JOIN_TAB *first= 0, *tab;
+  uint i;
+  DBUG_ENTER("setup_semijoin_strategy");
+
+  for (i= join->const_tables; i < join->tables; i++)
+  {
+    tab= join->join_tab + i;
+    if (!(tab->table->map & join->sj_inner_tables))
+      continue;
+    if (!first)
+      first= tab;
+    switch (join->best_positions[i].sj_strategy) {
+    case SJ_OPT_FIRST_MATCH:
+      for (JOIN_TAB *inner= first; inner <= tab; inner++)
+        inner->last_sj_inner_tab= tab;
+      tab->sj_strategy= SJ_OPT_FIRST_MATCH;
+      break;
+    case SJ_OPT_LOOSE_SCAN:
+    {
+      KEY *keyinfo= tab->table->key_info +
+                    join->best_positions[i].loosescan_key;
+      tab->sj_strategy= SJ_OPT_LOOSE_SCAN;
+      tab->loosescan_key_len= keyinfo->key_part->store_length;
+      if (!(tab->loosescan_buf=
+            (uchar*) join->thd->alloc(tab->loosescan_key_len)))
+        DBUG_RETURN(TRUE);
+      break;
+    }
+    case SJ_OPT_DUPS_WEEDOUT:
+      join->join_tab[join->tables - 1].sj_strategy= SJ_OPT_DUPS_WEEDOUT;
+      DBUG_RETURN(!describe && create_sj_weedout_table(join));
+    }
+  }
+  DBUG_RETURN(FALSE);
+}
+
+
 /**
   Give error if we some tables are done with a full join.
 
@@ -10006,6 +10551,7 @@ create_tmp_table(THD *thd,TMP_TABLE_PARAM *param,List<Item> &fields,
   ulong reclength, string_total_length;
   bool  using_unique_constraint= 0;
   bool  use_packed_rows= 0;
+  bool  blobs_need_myisam;
   bool  not_all_columns= !(select_options & TMP_TABLE_ALL_COLUMNS);
   char  *tmpname,path[FN_REFLEN];
   uchar	*pos, *group_buff, *bitmaps;
@@ -10315,9 +10861,23 @@ create_tmp_table(THD *thd,TMP_TABLE_PARAM *param,List<Item> &fields,
   *blob_field= 0;				// End marker
   share->fields= field_count;
 
+  /*
+    HEAP stores blobs in variable-length rows of internal tables, but it
+    can't index them: a blob in the group or distinct key needs MyISAM.
+    So do information schema tables, as CREATE TABLE ... LIKE copies
+    their engine.
+  */
+  blobs_need_myisam= blob_count && (distinct || param->schema_table);
+  for (ORDER *tmp= group ; tmp && blob_count && !blobs_need_myisam ;
+       tmp= tmp->next)
+  {
+    Field *field= (*tmp->item)->get_tmp_table_field();
+    blobs_need_myisam= field && (field->flags & BLOB_FLAG);
+  }
+
   /* If result table is small; use a heap */
   /* future: storage engine selection can be made dynamic? */
-  if (blob_count || using_unique_constraint ||
+  if (blobs_need_myisam || using_unique_constraint ||
       (select_options & (OPTION_BIG_TABLES | SELECT_SMALL_RESULT)) ==
       OPTION_BIG_TABLES || (select_options & TMP_TABLE_FORCE_MYISAM))
   {
@@ -11112,7 +11672,12 @@ Next_select_func setup_end_select_func(JOIN *join)
     if (table->group && tmp_tbl->sum_func_count && 
         !tmp_tbl->precomputed_group_by)
     {
-      if (table->s->keys)
+      if (join->hash_group && join->hash_group->inited)
+      {
+	DBUG_PRINT("info",("Using end_hash_update"));
+	end_select=end_hash_update;
+      }
+      else if (table->s->keys)
       {
 	DBUG_PRINT("info",("Using end_update"));
 	end_select=end_update;
@@ -11196,7 +11761,21 @@ do_select(JOIN *join,List<Item> *fields,TABLE *table,Procedure *procedure)
     empty_record(table);
     if (table->group && join->tmp_table_param.sum_func_count &&
         table->s->keys && !table->file->inited)
-      table->file->ha_index_init(0, 0);
+    {
+      if (!join->tmp_table_param.precomputed_group_by &&
+          hash_group_usable(join, table))
+      {
+        if (hash_group_init(join, table))
+          DBUG_RETURN(-1);
+      }
+      else
+      {
+        /* The indexes may have been disabled by a previous execution */
+        if (table->file->indexes_are_disabled())
+          table->file->ha_enable_indexes(HA_KEY_SWITCH_ALL);
+        table->file->ha_index_init(0, 0);
+      }
+    }
   }
   /* Set up select_end */
   Next_select_func end_select= setup_end_select_func(join);
@@ -11205,6 +11784,9 @@ do_select(JOIN *join,List<Item> *fields,TABLE *table,Procedure *procedure)
     join->join_tab[join->tables-1].next_select= end_select;
 
     join_tab=join->join_tab+join->const_tables;
+    /* Rows of a previous execution are not duplicates */
+    if (join->join_tab[join->tables-1].check_weed_out)
+      join->sj_tmp_table->file->ha_delete_all_rows();
   }
   join->send_records=0;
   if (join->tables == join->const_tables)
@@ -11246,6 +11828,8 @@ do_select(JOIN *join,List<Item> *fields,TABLE *table,Procedure *procedure)
   }
   if (error == NESTED_LOOP_NO_MORE_ROWS)
     error= NESTED_LOOP_OK;
+  if (join->hash_group)
+    hash_group_free(join->hash_group);
 
   if (table == NULL)					// If sending data to client
     /*
@@ -11477,6 +12061,8 @@ sub_select(JOIN *join,JOIN_TAB *join_tab,bool end_of_records)
       /* Set first_unmatched for the last inner table of this group */
       join_tab->last_inner->first_unmatched= join_tab;
     }
+    if (join_tab->last_sj_inner_tab)
+      join_tab->last_sj_inner_tab->sj_matched= FALSE;
     join->thd->row_count= 0;
 
     error= (*join_tab->read_first_record)(join_tab);
@@ -11499,6 +12085,49 @@ sub_select(JOIN *join,JOIN_TAB *join_tab,bool end_of_records)
 }
 
 
+/**
+  Check if the outer row combination of a semi-join was passed on
+  before, by writing the rowids of the outer tables to the duplicate
+  weedout table.
+
+  @retval 0   the combination is new
+  @retval 1   duplicate
+  @retval -1  error
+*/
+
+static int check_sj_weedout(JOIN *join)
+{
+  TABLE *sj_table= join->sj_tmp_table;
+  JOIN_TAB *tab, *end= join->join_tab + join->tables;
+  uchar *ptr= sj_table->field[0]->ptr;
+  ha_rows records;
+  int error;
+
+  for (tab= join->join_tab + join->const_tables; tab < end; tab++)
+  {
+    TABLE *table= tab->table;
+    if (table->map & join->sj_inner_tables)
+      continue;
+    table->file->position(table->record[0]);
+    memcpy(ptr, table->file->ref, table->file->ref_length);
+    ptr+= table->file->ref_length;
+  }
+  if (!(error= sj_table->file->ha_write_row(sj_table->record[0])))
+    return 0;
+  if (error == HA_ERR_FOUND_DUPP_KEY || error == HA_ERR_FOUND_DUPP_UNIQUE)
+    return 1;
+
+  /* The table is full: the conversion writes the row unless it is known */
+  sj_table->file->info(HA_STATUS_VARIABLE);
+  records= sj_table->file->stats.records;
+  if (create_myisam_from_heap(join->thd, sj_table, join->sj_tmp_table_param,
+                              error, 1))
+    return -1;
+  sj_table->file->info(HA_STATUS_VARIABLE);
+  return sj_table->file->stats.records == records;
+}
+
+
 /**
   Process one record of the nested loop join.
 
@@ -11605,12 +12234,36 @@ evaluate_join_record(JOIN *join, JOIN_TAB *join_tab,
     if (found)
     {
       enum enum_nested_loop_state rc;
+      if (join_tab->check_weed_out)
+      {
+        int dup= check_sj_weedout(join);
+        if (dup < 0)
+          return NESTED_LOOP_ERROR;
+        if (dup)
+          return NESTED_LOOP_OK;
+      }
+      if (join_tab->loosescan_buf)
+      {
+        /* Skip the other rows with this key value, see join_read_loosescan_next */
+        key_copy(join_tab->loosescan_buf, join_tab->table->record[0],
+                 join_tab->table->key_info + join_tab->index,
+                 join_tab->loosescan_key_len);
+        join_tab->loosescan_match= TRUE;
+      }
       /* A match from join_tab is found for the current partial join. */
       rc= (*join_tab->next_select)(join, join_tab+1, 0);
       if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
         return rc;
       if (join->return_tab < join_tab)
         return NESTED_LOOP_OK;
+      if (join_tab->last_sj_inner_tab)
+      {
+        /* FirstMatch: one match of the semi-join inner tables is enough */
+        if (join_tab->last_sj_inner_tab == join_tab)
+          join_tab->sj_matched= TRUE;
+        if (join_tab->last_sj_inner_tab->sj_matched)
+          return NESTED_LOOP_NO_MORE_ROWS;
+      }
       /*
         Test if this was a SELECT DISTINCT query on a table that
         was not in the field list;  In this case we can abort if
@@ -11703,18 +12356,121 @@ evaluate_null_complemented_join_record(JOIN *join, JOIN_TAB *join_tab)
 }
 
 
+/**
+  Join the cached record at the current cache read position with the
+  current record of join_tab and pass the result to the next table.
+
+  @return rc if the joined record does not satisfy the condition,
+          otherwise the state returned by the next table
+*/
+
+static enum_nested_loop_state
+join_cached_record(JOIN *join, JOIN_TAB *join_tab, enum_nested_loop_state rc)
+{
+  bool skip_record= FALSE;
+  SQL_SELECT *select=join_tab->select;
+
+  read_cached_record(join_tab);
+  if (select && select->skip_record(join->thd, &skip_record))
+    return NESTED_LOOP_ERROR;
+  if (skip_record)
+    return rc;
+  return (join_tab->next_select)(join,join_tab+1,0);
+}
+
+
+/**
+  Join the records of a batched key access join cache with the rows of
+  join_tab, which are read with one multi-range read of their keys.
+*/
+
+static enum_nested_loop_state
+flush_bka_records(JOIN *join, JOIN_TAB *join_tab)
+{
+  enum_nested_loop_state rc= NESTED_LOOP_OK;
+  int error;
+  JOIN_CACHE *cache= &join_tab->cache;
+  TABLE *table= join_tab->table;
+  KEY_MULTI_RANGE *range;
+  HANDLER_BUFFER buffer;
+  uint ranges;
+
+  if (!(ranges= join_cache_bka_build(join_tab)))
+  {
+    reset_cache_write(cache);                   // No key can match
+    return NESTED_LOOP_OK;
+  }
+  if (!table->file->inited)
+    table->file->ha_index_init(join_tab->ref.key, join_tab->sorted);
+  bzero((char*) &buffer, sizeof(buffer));
+
+  for (JOIN_TAB *tmp=join->join_tab; tmp != join_tab ; tmp++)
+  {
+    tmp->status=tmp->table->status;
+    tmp->table->status=0;
+  }
+
+  error= table->file->read_multi_range_first(&range, cache->bka_ranges,
+                                             ranges, FALSE, &buffer);
+  while (!error)
+  {
+    /* The records with the key of the range */
+    uint *order= cache->bka_order +
+                 cache->bka_range_start[range - cache->bka_ranges];
+    uint *end= cache->bka_order +
+               cache->bka_range_start[range - cache->bka_ranges + 1];
+    if (join->thd->killed)
+    {
+      join->thd->send_kill_message();
+      rc= NESTED_LOOP_KILLED;
+      break;
+    }
+    for (; order < end && rc == NESTED_LOOP_OK; order++)
+    {
+      cache->record_nr= *order;
+      cache->pos= cache->rec_pos[*order];
+      rc= join_cached_record(join, join_tab, rc);
+    }
+    if (rc != NESTED_LOOP_OK)
+      break;
+    error= table->file->read_multi_range_next(&range);
+  }
+
+  reset_cache_write(cache);
+  if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
+    return rc;
+  if (error && error != HA_ERR_END_OF_FILE && error != HA_ERR_KEY_NOT_FOUND)
+  {
+    report_error(table, error);
+    return NESTED_LOOP_ERROR;
+  }
+  for (JOIN_TAB *tmp2=join->join_tab; tmp2 != join_tab ; tmp2++)
+    tmp2->table->status=tmp2->status;
+  return NESTED_LOOP_OK;
+}
+
+
 static enum_nested_loop_state
 flush_cached_records(JOIN *join,JOIN_TAB *join_tab,bool skip_last)
 {
   enum_nested_loop_state rc= NESTED_LOOP_OK;
   int error;
   READ_RECORD *info;
+  JOIN_CACHE *cache= &join_tab->cache;
+  uint records;
+  uchar *last_pos= 0;
 
   join_tab->table->null_row= 0;
-  if (!join_tab->cache.records)
+  if (!cache->records)
     return NESTED_LOOP_OK;                      /* Nothing to do */
+  if (cache->bka_key_length)
+  {
+    DBUG_ASSERT(!skip_last);                    // Only used for quick selects
+    return flush_bka_records(join, join_tab);
+  }
   if (skip_last)
-    (void) store_record_in_cache(&join_tab->cache); // Must save this for later
+    (void) store_record_in_cache(cache);        // Must save this for later
+  records= cache->records - (skip_last ? 1 : 0);
   if (join_tab->use_quick == 2)
   {
     if (join_tab->select->quick)
@@ -11723,10 +12479,15 @@ flush_cached_records(JOIN *join,JOIN_TAB *join_tab,bool skip_last)
       join_tab->select->quick=0;
     }
   }
+  if (cache->hash_keys)
+  {
+    join_cache_hash_build(join_tab, records);
+    last_pos= cache->pos;
+  }
  /* read through all records */
   if ((error=join_init_read_record(join_tab)))
   {
-    reset_cache_write(&join_tab->cache);
+    reset_cache_write(cache);
     return error < 0 ? NESTED_LOOP_NO_MORE_ROWS: NESTED_LOOP_ERROR;
   }
 
@@ -11744,36 +12505,49 @@ flush_cached_records(JOIN *join,JOIN_TAB *join_tab,bool skip_last)
       join->thd->send_kill_message();
       return NESTED_LOOP_KILLED; // Aborted by user /* purecov: inspected */
     }
-    SQL_SELECT *select=join_tab->select;
     if (rc == NESTED_LOOP_OK)
     {
       bool skip_record= FALSE;
-      if (join_tab->cache.select &&
-          join_tab->cache.select->skip_record(join->thd, &skip_record))
+      if (cache->select &&
+          cache->select->skip_record(join->thd, &skip_record))
       {
-        reset_cache_write(&join_tab->cache);
+        reset_cache_write(cache);
         return NESTED_LOOP_ERROR;
       }
 
       if (!skip_record)
       {
         uint i;
-        reset_cache_read(&join_tab->cache);
-        for (i=(join_tab->cache.records- (skip_last ? 1 : 0)) ; i-- > 0 ;)
+        if (cache->hash_keys)
         {
-          read_cached_record(join_tab);
-          skip_record= FALSE;
-          if (select && select->skip_record(join->thd, &skip_record))
+          /* Only the records with the hash of this row can match it */
+          ulong hash;
+          i= 0;
+          if (!join_cache_hash_key(cache->hash_inner, cache->hash_keys, &hash))
+            i= cache->hash_bucket[hash & (cache->hash_size - 1)];
+          for (; i ; i= cache->hash_next[i - 1])
           {
-            reset_cache_write(&join_tab->cache);
-            return NESTED_LOOP_ERROR;
+            if (cache->rec_hash[i - 1] != hash)
+              continue;
+            cache->record_nr= i - 1;
+            cache->pos= cache->rec_pos[i - 1];
+            rc= join_cached_record(join, join_tab, rc);
+            if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
+            {
+              reset_cache_write(cache);
+              return rc;
+            }
           }
-          if (!skip_record)
+        }
+        else
+        {
+          reset_cache_read(cache);
+          for (i=records ; i-- > 0 ;)
           {
-            rc= (join_tab->next_select)(join,join_tab+1,0);
+            rc= join_cached_record(join, join_tab, rc);
             if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
             {
-              reset_cache_write(&join_tab->cache);
+              reset_cache_write(cache);
               return rc;
             }
           }
@@ -11783,8 +12557,16 @@ flush_cached_records(JOIN *join,JOIN_TAB *join_tab,bool skip_last)
   } while (!(error=info->read_record(info)));
 
   if (skip_last)
+  {
+    if (cache->hash_keys)
+    {
+      /* The probes left the read position anywhere in the buffer */
+      cache->record_nr= records;
+      cache->pos= last_pos;
+    }
     read_cached_record(join_tab);		// Restore current record
-  reset_cache_write(&join_tab->cache);
+  }
+  reset_cache_write(cache);
   if (error > 0)				// Fatal error
     return NESTED_LOOP_ERROR;                   /* purecov: inspected */
   for (JOIN_TAB *tmp2=join->join_tab; tmp2 != join_tab ; tmp2++)
@@ -12249,6 +13031,39 @@ join_read_next(READ_RECORD *info)
 }
 
 
+/**
+  Start a LooseScan of the table: read it in the order of the key and,
+  after a row was passed on, skip the rows with the same value of the
+  first key part.
+*/
+
+static int
+join_read_loosescan_first(JOIN_TAB *tab)
+{
+  int error;
+  tab->loosescan_match= FALSE;
+  error= join_read_first(tab);
+  tab->read_record.read_record= join_read_loosescan_next;
+  return error;
+}
+
+
+static int
+join_read_loosescan_next(READ_RECORD *info)
+{
+  JOIN_TAB *tab= info->table->reginfo.join_tab;
+  int error;
+  if (!tab->loosescan_match)
+    return join_read_next(info);
+  tab->loosescan_match= FALSE;
+  if ((error= info->file->index_read_map(info->record, tab->loosescan_buf,
+                                         make_prev_keypart_map(1),
+                                         HA_READ_AFTER_KEY)))
+    return report_error(info->table, error);
+  return 0;
+}
+
+
 static int
 join_read_last(JOIN_TAB *tab)
 {
@@ -12753,6 +13568,465 @@ end_unique_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 }
 
 
+/*****************************************************************************
+  Hash aggregation of GROUP BY, see HASH_GROUP.
+  A group is stored as the pointer to the next group in insertion order,
+  the group key as made in tmp_table_param.group_buff, and the record of
+  the temporary table. A spilled row is, for each table of the join, its
+  null_row flag and record[0].
+*****************************************************************************/
+
+#define HASH_GROUP_MIN_SLOTS 256
+/** Spilled rows are not split further than this, see hash_group_mix() */
+#define HASH_GROUP_MAX_LEVEL 7
+
+/**
+  Scramble the hash of a group key.
+
+  The slot of a group uses seed 0, the partition of a row spilled by
+  rows at spill level L uses seed L + 1, so that the rows of a partition
+  are spread over all slots and partitions of the next level.
+*/
+
+static inline uint32 hash_group_mix(ulong hash, uint seed)
+{
+  uint32 nr= (uint32) hash ^ (uint32) ((ulonglong) hash >> 32);
+  nr+= seed * 0x9e3779b9U;
+  nr^= nr >> 16;
+  nr*= 0x85ebca6bU;
+  nr^= nr >> 13;
+  nr*= 0xc2b2ae35U;
+  return nr ^ (nr >> 16);
+}
+
+
+/**
+  Check if GROUP BY into a temporary table can be done by end_hash_update.
+
+  The temporary table must not have blobs, which its records only point
+  to, and neither may the columns read from the tables of the join, as
+  rows are spilled by their records.
+*/
+
+static bool hash_group_usable(JOIN *join, TABLE *table)
+{
+  if (!optimizer_flag(join->thd, OPTIMIZER_SWITCH_HASH_GROUP_BY) ||
+      table->s->blob_fields)
+    return FALSE;
+  for (JOIN_TAB *tab= join->join_tab + join->const_tables,
+         *end= join->join_tab + join->tables; tab < end; tab++)
+  {
+    TABLE *t= tab->table;
+    for (uint *blob= t->s->blob_field, *end_blob= blob + t->s->blob_fields;
+         blob < end_blob; blob++)
+    {
+      if (bitmap_is_set(t->read_set, *blob))
+        return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+
+/**
+  Set up join->hash_group for a do_select() into table.
+
+  The index on the group of the temporary table is disabled, as the rows
+  written to it are already grouped.
+*/
+
+static bool hash_group_init(JOIN *join, TABLE *table)
+{
+  THD *thd= join->thd;
+  HASH_GROUP *hg= join->hash_group;
+  DBUG_ENTER("hash_group_init");
+
+  if (!hg &&
+      !(hg= join->hash_group= (HASH_GROUP*) thd->calloc(sizeof(HASH_GROUP))))
+    DBUG_RETURN(TRUE);
+  hg->key_length= join->tmp_table_param.group_length;
+  hg->group_length= ALIGN_SIZE(sizeof(uchar*) + hg->key_length +
+                               table->s->reclength);
+  hg->row_length= 0;
+  for (JOIN_TAB *tab= join->join_tab + join->const_tables,
+         *end= join->join_tab + join->tables; tab < end; tab++)
+    hg->row_length+= 1 + tab->table->s->reclength;
+  hg->max_size= min(thd->variables.tmp_table_size,
+                    thd->variables.max_heap_table_size);
+  hg->slot_count= HASH_GROUP_MIN_SLOTS;
+  if (!(hg->slots= (HASH_GROUP_SLOT*)
+        my_malloc(hg->slot_count * sizeof(HASH_GROUP_SLOT),
+                  MYF(MY_WME | MY_ZEROFILL))))
+    DBUG_RETURN(TRUE);
+  init_alloc_root(&hg->mem_root, (uint) min(hg->max_size, 65536), 0);
+  my_init_dynamic_array(&hg->pending, sizeof(HASH_GROUP_FILE), 16, 16);
+  hg->records= 0;
+  hg->size= 0;
+  hg->first= 0;
+  hg->last= &hg->first;
+  hg->level= 0;
+  bzero((char*) hg->spill, sizeof(hg->spill));
+  hg->inited= TRUE;
+  if (!table->file->indexes_are_disabled())
+    table->file->ha_disable_indexes(HA_KEY_SWITCH_ALL);
+  DBUG_RETURN(FALSE);
+}
+
+
+static void hash_group_close_file(IO_CACHE *file)
+{
+  close_cached_file(file);
+  my_free(file, MYF(0));
+}
+
+
+/** Free what hash_group_init() and the aggregation allocated */
+
+static void hash_group_free(HASH_GROUP *hg)
+{
+  if (!hg->inited)
+    return;
+  my_free(hg->slots, MYF(0));
+  free_root(&hg->mem_root, MYF(0));
+  for (uint i= 0; i < HASH_GROUP_PARTITIONS; i++)
+  {
+    if (hg->spill[i])
+      hash_group_close_file(hg->spill[i]);
+  }
+  for (uint i= 0; i < hg->pending.elements; i++)
+    hash_group_close_file(dynamic_element(&hg->pending, i,
+                                          HASH_GROUP_FILE*)->file);
+  delete_dynamic(&hg->pending);
+  hg->inited= FALSE;
+}
+
+
+/** Hash of the group key in tmp_table_param.group_buff */
+
+static ulong hash_group_key(TABLE *table)
+{
+  ulong nr1= 1, nr2= 4;
+  for (ORDER *group= table->group; group; group= group->next)
+  {
+    if ((*group->item)->maybe_null && group->buff[-1])
+      nr1^= (nr1 << 1) | 1;
+    else
+      group->field->hash(&nr1, &nr2);
+  }
+  return nr1;
+}
+
+
+/** Compare the group key in tmp_table_param.group_buff with key */
+
+static bool hash_group_key_eq(JOIN *join, uchar *key)
+{
+  uchar *group_buff= join->tmp_table_param.group_buff;
+  for (ORDER *group= join->tmp_table->group; group; group= group->next)
+  {
+    uchar *ptr= (uchar*) group->buff;
+    uchar *other= key + (ptr - group_buff);
+    if ((*group->item)->maybe_null)
+    {
+      if (ptr[-1] != other[-1])
+        return FALSE;
+      if (ptr[-1])
+        continue;
+    }
+    if (group->field->cmp(ptr, other))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/**
+  Find the group of the key in tmp_table_param.group_buff.
+
+  @param[out] free_slot  where the group is to be inserted if not found
+
+  @return the group, or 0 if it is not in memory
+*/
+
+static uchar *hash_group_find(JOIN *join, ulong hash,
+                              HASH_GROUP_SLOT **free_slot)
+{
+  HASH_GROUP *hg= join->hash_group;
+  uint mask= hg->slot_count - 1;
+  for (uint idx= hash_group_mix(hash, 0) & mask; ; idx= (idx + 1) & mask)
+  {
+    HASH_GROUP_SLOT *slot= hg->slots + idx;
+    if (!slot->group)
+    {
+      *free_slot= slot;
+      return 0;
+    }
+    if (slot->hash == hash &&
+        hash_group_key_eq(join, slot->group + sizeof(uchar*)))
+      return slot->group;
+  }
+}
+
+
+/** Double the number of slots of the hash table */
+
+static bool hash_group_grow(HASH_GROUP *hg)
+{
+  uint slot_count= hg->slot_count * 2, mask= slot_count - 1;
+  HASH_GROUP_SLOT *slots, *slot, *end;
+  if (!(slots= (HASH_GROUP_SLOT*) my_malloc(slot_count *
+                                            sizeof(HASH_GROUP_SLOT),
+                                            MYF(MY_WME | MY_ZEROFILL))))
+    return TRUE;
+  for (slot= hg->slots, end= slot + hg->slot_count; slot < end; slot++)
+  {
+    if (!slot->group)
+      continue;
+    uint idx= hash_group_mix(slot->hash, 0) & mask;
+    while (slots[idx].group)
+      idx= (idx + 1) & mask;
+    slots[idx]= *slot;
+  }
+  my_free(hg->slots, MYF(0));
+  hg->slots= slots;
+  hg->slot_count= slot_count;
+  return FALSE;
+}
+
+
+/**
+  Write the current row of the join to the spill file of its partition.
+*/
+
+static bool hash_group_spill(JOIN *join, ulong hash)
+{
+  HASH_GROUP *hg= join->hash_group;
+  uint part= hash_group_mix(hash, hg->level + 1) >>
+             (32 - HASH_GROUP_PARTITION_BITS);
+  IO_CACHE *file= hg->spill[part];
+
+  if (!file)
+  {
+    if (!(file= (IO_CACHE*) my_malloc(sizeof(IO_CACHE), MYF(MY_WME))))
+      return TRUE;
+    if (open_cached_file(file, mysql_tmpdir, TEMP_PREFIX, DISK_BUFFER_SIZE,
+                         MYF(MY_WME)))
+    {
+      my_free(file, MYF(0));
+      return TRUE;
+    }
+    hg->spill[part]= file;
+    status_var_increment(join->thd->status_var.hash_group_spills);
+  }
+  for (JOIN_TAB *tab= join->join_tab + join->const_tables,
+         *end= join->join_tab + join->tables; tab < end; tab++)
+  {
+    TABLE *table= tab->table;
+    uchar null_row= (uchar) table->null_row;
+    if (my_b_write(file, &null_row, 1) ||
+        my_b_write(file, table->record[0], table->s->reclength))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
+/**
+  Add the current row of the join to its group, or spill it if its group
+  is new and there is no room for it.
+
+  @retval 0  ok
+  @retval 1  error
+*/
+
+static int hash_group_add_row(JOIN *join)
+{
+  HASH_GROUP *hg= join->hash_group;
+  TABLE *table= join->tmp_table;
+  HASH_GROUP_SLOT *slot;
+  ORDER *group;
+  uchar *pos;
+  ulong hash;
+
+  copy_fields(&join->tmp_table_param);		// Groups are copied twice.
+  /* Make the group key, as end_update() */
+  for (group=table->group ; group ; group=group->next)
+  {
+    Item *item= *group->item;
+    item->save_org_in_field(group->field);
+    if (item->maybe_null)
+      group->buff[-1]= (char) group->field->is_null();
+  }
+  hash= hash_group_key(table);
+  if ((pos= hash_group_find(join, hash, &slot)))
+  {
+    pos+= sizeof(uchar*) + hg->key_length;
+    memcpy(table->record[0], pos, table->s->reclength);
+    update_tmptable_sum_func(join->sum_funcs, table);
+    memcpy(pos, table->record[0], table->s->reclength);
+    return 0;
+  }
+
+  if (hg->records &&
+      hg->size + hg->group_length + 2 * sizeof(HASH_GROUP_SLOT) >
+      hg->max_size &&
+      hg->level < HASH_GROUP_MAX_LEVEL)
+    return hash_group_spill(join, hash);
+
+  KEY_PART_INFO *key_part;
+  for (group=table->group,key_part=table->key_info[0].key_part;
+       group ;
+       group=group->next,key_part++)
+  {
+    if (key_part->null_bit)
+      memcpy(table->record[0]+key_part->offset, group->buff, 1);
+  }
+  init_tmptable_sum_functions(join->sum_funcs);
+  if (copy_funcs(join->tmp_table_param.items_to_copy, join->thd))
+    return 1;
+  if (!(pos= (uchar*) alloc_root(&hg->mem_root, hg->group_length)))
+    return 1;
+  *(uchar**) pos= 0;
+  *hg->last= pos;
+  hg->last= (uchar**) pos;
+  memcpy(pos + sizeof(uchar*), join->tmp_table_param.group_buff,
+         hg->key_length);
+  memcpy(pos + sizeof(uchar*) + hg->key_length, table->record[0],
+         table->s->reclength);
+  slot->hash= hash;
+  slot->group= pos;
+  hg->size+= hg->group_length + 2 * sizeof(HASH_GROUP_SLOT);
+  if (++hg->records * 2 > hg->slot_count && hash_group_grow(hg))
+    return 1;
+  return 0;
+}
+
+
+/**
+  Write the groups in memory to the temporary table, in the order they
+  were found, and empty the hash table.
+*/
+
+static int hash_group_write(JOIN *join)
+{
+  HASH_GROUP *hg= join->hash_group;
+  TABLE *table= join->tmp_table;
+  int error;
+
+  for (uchar *pos= hg->first; pos; pos= *(uchar**) pos)
+  {
+    memcpy(table->record[0], pos + sizeof(uchar*) + hg->key_length,
+           table->s->reclength);
+    if ((error= table->file->ha_write_row(table->record[0])))
+    {
+      if (create_myisam_from_heap(join->thd, table, &join->tmp_table_param,
+                                  error, 0))
+        return 1;
+    }
+    join->send_records++;
+  }
+  bzero((char*) hg->slots, hg->slot_count * sizeof(HASH_GROUP_SLOT));
+  free_root(&hg->mem_root, MYF(MY_MARK_BLOCKS_FREE));
+  hg->records= 0;
+  hg->size= 0;
+  hg->first= 0;
+  hg->last= &hg->first;
+  return 0;
+}
+
+
+/**
+  Aggregate the rows of a spill file, restoring the records of the tables
+  of the join from it.
+*/
+
+static int hash_group_read_file(JOIN *join, IO_CACHE *file)
+{
+  JOIN_TAB *first_tab= join->join_tab + join->const_tables;
+  JOIN_TAB *end_tab= join->join_tab + join->tables;
+  uchar null_row;
+
+  if (reinit_io_cache(file, READ_CACHE, 0L, 0, 0))
+    return 1;
+  while (!my_b_read(file, &null_row, 1))
+  {
+    if (join->thd->killed)
+    {
+      join->thd->send_kill_message();
+      return 1;
+    }
+    for (JOIN_TAB *tab= first_tab; tab < end_tab; tab++)
+    {
+      TABLE *table= tab->table;
+      if (tab != first_tab && my_b_read(file, &null_row, 1))
+        return 1;
+      table->null_row= null_row;
+      if (my_b_read(file, table->record[0], table->s->reclength))
+        return 1;
+    }
+    if (hash_group_add_row(join))
+      return 1;
+  }
+  return file->error ? 1 : 0;
+}
+
+
+/**
+  Group by keeping the groups in a hash table in memory, see HASH_GROUP.
+  At the end of the join, write them to the temporary table and
+  aggregate the spilled partitions.
+*/
+
+static enum_nested_loop_state
+end_hash_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
+                bool end_of_records)
+{
+  HASH_GROUP *hg= join->hash_group;
+  DBUG_ENTER("end_hash_update");
+
+  if (join->thd->killed)			// Aborted by user
+  {
+    join->thd->send_kill_message();
+    DBUG_RETURN(NESTED_LOOP_KILLED);             /* purecov: inspected */
+  }
+  if (!end_of_records)
+  {
+    join->found_records++;
+    DBUG_RETURN(hash_group_add_row(join) ? NESTED_LOOP_ERROR :
+                NESTED_LOOP_OK);
+  }
+
+  for (;;)
+  {
+    HASH_GROUP_FILE next;
+    int error;
+
+    if (hash_group_write(join))
+      DBUG_RETURN(NESTED_LOOP_ERROR);
+    /* The partitions spilled at this level are aggregated one by one */
+    for (uint i= 0; i < HASH_GROUP_PARTITIONS; i++)
+    {
+      if (!hg->spill[i])
+        continue;
+      next.file= hg->spill[i];
+      next.level= hg->level + 1;
+      if (insert_dynamic(&hg->pending, (uchar*) &next))
+        DBUG_RETURN(NESTED_LOOP_ERROR);
+      hg->spill[i]= 0;
+    }
+    if (!hg->pending.elements)
+      break;
+    next= *(HASH_GROUP_FILE*) pop_dynamic(&hg->pending);
+    hg->level= next.level;
+    error= hash_group_read_file(join, next.file);
+    hash_group_close_file(next.file);
+    if (error)
+      DBUG_RETURN(join->thd->killed ? NESTED_LOOP_KILLED : NESTED_LOOP_ERROR);
+  }
+  DBUG_RETURN(NESTED_LOOP_OK);
+}
+
+
 	/* ARGSUSED */
 static enum_nested_loop_state
 end_write_group(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
@@ -14197,8 +15471,8 @@ remove_duplicates(JOIN *join, TABLE *entry,List<Item> &fields, Item *having)
 
   free_io_cache(entry);				// Safety
   entry->file->info(HA_STATUS_VARIABLE);
-  if (entry->s->db_type() == heap_hton ||
-      (!entry->s->blob_fields &&
+  if (!entry->s->blob_fields &&
+      (entry->s->db_type() == heap_hton ||
        ((ALIGN_SIZE(reclength) + HASH_OVERHEAD) * entry->file->stats.records <
 	thd->variables.sortbuff_size)))
     error=remove_dup_with_hash_index(join->thd, entry,
@@ -14470,7 +15744,7 @@ join_init_cache(THD *thd,JOIN_TAB *tables,uint table_count)
 {
   reg1 uint i;
   uint length, blobs;
-  size_t size;
+  size_t size, hash_length;
   CACHE_FIELD *copy,**blob_ptr;
   JOIN_CACHE  *cache;
   JOIN_TAB *join_tab;
@@ -14554,14 +15828,216 @@ join_init_cache(THD *thd,JOIN_TAB *tables,uint table_count)
   cache->blobs=blobs;
   *blob_ptr=0;					/* End sequentel */
   size=max(thd->variables.join_buff_size, cache->length);
-  if (!(cache->buff=(uchar*) my_malloc(size,MYF(0))))
+  hash_length= 0;
+  if (cache->hash_keys || cache->bka_key_length)
+  {
+    /*
+      A record takes at least its fixed part, 2 bytes for a stripped field
+      and the length bytes of a blob, which bounds the records in the buffer.
+    */
+    uint min_length= 0;
+    for (copy= cache->field; copy < cache->field + cache->fields; copy++)
+      min_length+= copy->type == CACHE_STRIPPED ? 2 : copy->length;
+    cache->max_records= (uint) (size / max(min_length, 1)) + 1;
+  }
+  if (cache->hash_keys)
+  {
+    for (cache->hash_size= 1; cache->hash_size < cache->max_records;
+         cache->hash_size<<= 1) ;
+    hash_length= cache->max_records * (sizeof(uchar*) + sizeof(ulong) +
+                                       sizeof(uint)) +
+                 cache->hash_size * sizeof(uint);
+  }
+  else if (cache->bka_key_length)
+    hash_length= cache->max_records * (sizeof(KEY_MULTI_RANGE) +
+                                       sizeof(uchar*) + sizeof(uint) * 2 +
+                                       ALIGN_SIZE(cache->bka_key_length)) +
+                 sizeof(uint);
+  if (!(cache->buff=(uchar*) my_malloc(ALIGN_SIZE(size) + hash_length,
+                                       MYF(0))))
     DBUG_RETURN(1);				/* Don't use cache */ /* purecov: inspected */
   cache->end=cache->buff+size;
+  if (cache->hash_keys)
+  {
+    cache->rec_pos= (uchar**) (cache->buff + ALIGN_SIZE(size));
+    cache->rec_hash= (ulong*) (cache->rec_pos + cache->max_records);
+    cache->hash_next= (uint*) (cache->rec_hash + cache->max_records);
+    cache->hash_bucket= cache->hash_next + cache->max_records;
+  }
+  else if (cache->bka_key_length)
+  {
+    cache->bka_ranges= (KEY_MULTI_RANGE*) (cache->buff + ALIGN_SIZE(size));
+    cache->rec_pos= (uchar**) (cache->bka_ranges + cache->max_records);
+    cache->bka_keys= (uchar*) (cache->rec_pos + cache->max_records);
+    cache->bka_order= (uint*) (cache->bka_keys + cache->max_records *
+                               ALIGN_SIZE(cache->bka_key_length));
+    cache->bka_range_start= cache->bka_order + cache->max_records;
+  }
   reset_cache_write(cache);
   DBUG_RETURN(0);
 }
 
 
+/**
+  Check if an equality of the condition of tab can key a hash join.
+
+  The hash only selects the cached records that the condition is then
+  evaluated on, so it has to give equal values equal hashes: both sides
+  must be compared as integers, or as strings of the same collation.
+
+  @param item           conjunct of the condition
+  @param table          table joined with the cache
+  @param prefix_tables  tables whose records are in the cache
+  @param[out] outer     field of a cached table
+  @param[out] inner     field of table
+
+  @retval TRUE   item is such an equality
+  @retval FALSE  otherwise
+*/
+
+static bool
+hash_join_equality(Item *item, TABLE *table, table_map prefix_tables,
+                   Field **outer, Field **inner)
+{
+  Item **args;
+  Field *field[2];
+  uint i;
+
+  if (item->type() != Item::FUNC_ITEM ||
+      ((Item_func*) item)->functype() != Item_func::EQ_FUNC)
+    return FALSE;
+  args= ((Item_func*) item)->arguments();
+  for (i= 0; i < 2; i++)
+  {
+    Item *real= args[i]->real_item();
+    if (real->type() != Item::FIELD_ITEM)
+      return FALSE;
+    field[i]= ((Item_field*) real)->field;
+    /* Outer references are constant for the join, skip them */
+    if (args[i]->used_tables() != field[i]->table->map)
+      return FALSE;
+  }
+  if (field[1]->table == table)
+    swap_variables(Field*, field[0], field[1]);
+  if (field[0]->table != table || !(field[1]->table->map & prefix_tables))
+    return FALSE;
+
+  for (i= 0; i < 2; i++)
+  {
+    switch (field[i]->real_type()) {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_LONGLONG:
+      if (field[!i]->result_type() != INT_RESULT)
+        return FALSE;
+      break;
+    case MYSQL_TYPE_VARCHAR:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_STRING:
+    case MYSQL_TYPE_BLOB:
+      if (field[!i]->result_type() != STRING_RESULT ||
+          field[!i]->charset() != field[i]->charset())
+        return FALSE;
+      break;
+    default:
+      return FALSE;
+    }
+  }
+  *inner= field[0];
+  *outer= field[1];
+  return TRUE;
+}
+
+
+/**
+  Collect the equalities of a condition that can key a hash join.
+
+  @param cond           condition of the joined table
+  @param table          table joined with the cache
+  @param prefix_tables  tables whose records are in the cache
+  @param[out] outer     fields of cached tables, or NULL to only count
+  @param[out] inner     the fields of table they are equal to
+
+  @return number of equalities
+*/
+
+static uint
+hash_join_equalities(Item *cond, TABLE *table, table_map prefix_tables,
+                     Field **outer, Field **inner)
+{
+  Field *outer_field, *inner_field;
+  uint keys= 0;
+
+  if (cond->type() == Item::COND_ITEM &&
+      ((Item_cond*) cond)->functype() == Item_func::COND_AND_FUNC)
+  {
+    List_iterator<Item> li(*((Item_cond*) cond)->argument_list());
+    Item *item;
+    while ((item= li++))
+    {
+      if (hash_join_equality(item, table, prefix_tables,
+                             &outer_field, &inner_field))
+      {
+        if (outer)
+        {
+          outer[keys]= outer_field;
+          inner[keys]= inner_field;
+        }
+        keys++;
+      }
+    }
+  }
+  else if (hash_join_equality(cond, table, prefix_tables,
+                              &outer_field, &inner_field))
+  {
+    if (outer)
+    {
+      outer[0]= outer_field;
+      inner[0]= inner_field;
+    }
+    keys++;
+  }
+  return keys;
+}
+
+
+/**
+  Find the equalities a join cache can be hashed on.
+
+  Sets tab->cache.hash_keys to the number of top level equalities of the
+  condition of tab between a field of tab and a field of a preceding
+  table, 0 if there is none and the cache is scanned as a whole.
+*/
+
+static void
+join_init_hash_keys(THD *thd, JOIN *join, JOIN_TAB *tab)
+{
+  JOIN_CACHE *cache= &tab->cache;
+  table_map prefix_tables= 0;
+  Item *cond;
+  uint keys;
+  DBUG_ENTER("join_init_hash_keys");
+
+  cache->hash_keys= 0;
+  if (!tab->select || !(cond= tab->select->cond))
+    DBUG_VOID_RETURN;
+  for (JOIN_TAB *prev= join->join_tab; prev != tab; prev++)
+    prefix_tables|= prev->table->map;
+
+  if (!(keys= hash_join_equalities(cond, tab->table, prefix_tables, 0, 0)) ||
+      !(cache->hash_outer= (Field**) thd->alloc(sizeof(Field*) * keys * 2)))
+    DBUG_VOID_RETURN;
+  cache->hash_inner= cache->hash_outer + keys;
+  cache->hash_keys= hash_join_equalities(cond, tab->table, prefix_tables,
+                                         cache->hash_outer, cache->hash_inner);
+  DBUG_PRINT("info", ("table: %s  hash keys: %u", tab->table->alias,
+                      cache->hash_keys));
+  DBUG_VOID_RETURN;
+}
+
+
 static ulong
 used_blob_length(CACHE_FIELD **ptr)
 {
@@ -14713,6 +16189,199 @@ read_cached_record(JOIN_TAB *tab)
 }
 
 
+/**
+  Compute the hash of a hash join key.
+
+  @param fields  fields of the key
+  @param keys    number of fields
+  @param[out] hash
+
+  @retval TRUE   a part of the key is NULL, no record can match it
+  @retval FALSE  ok
+*/
+
+static bool
+join_cache_hash_key(Field **fields, uint keys, ulong *hash)
+{
+  ulong nr1= 1, nr2= 4;
+  for (Field **end= fields + keys; fields < end; fields++)
+  {
+    Field *field= *fields;
+    if (field->is_null())
+      return TRUE;
+    if (field->result_type() == INT_RESULT)
+    {
+      uchar buff[8];
+      int8store(buff, field->val_int());
+      my_charset_bin.coll->hash_sort(&my_charset_bin, buff, sizeof(buff),
+                                     &nr1, &nr2);
+    }
+    else
+    {
+      char buff[MAX_FIELD_WIDTH];
+      String tmp(buff, sizeof(buff), field->charset()), *str;
+      str= field->val_str(&tmp);
+      field->charset()->coll->hash_sort(field->charset(),
+                                        (const uchar*) str->ptr(),
+                                        str->length(), &nr1, &nr2);
+    }
+  }
+  *hash= nr1;
+  return FALSE;
+}
+
+
+/**
+  Hash the first records of a join cache on their hash join key.
+
+  Leaves the read position at the record following them.
+*/
+
+static void
+join_cache_hash_build(JOIN_TAB *tab, uint records)
+{
+  JOIN_CACHE *cache= &tab->cache;
+  uint i;
+
+  DBUG_ASSERT(records <= cache->max_records);
+  bzero((uchar*) cache->hash_bucket, cache->hash_size * sizeof(uint));
+  reset_cache_read(cache);
+  for (i= 0; i < records; i++)
+  {
+    cache->rec_pos[i]= cache->pos;
+    read_cached_record(tab);
+    if (join_cache_hash_key(cache->hash_outer, cache->hash_keys,
+                            cache->rec_hash + i))
+      cache->rec_pos[i]= 0;
+  }
+  /* Link backwards, so that the chains are in buffer order */
+  for (i= records; i-- > 0 ;)
+  {
+    if (cache->rec_pos[i])
+    {
+      uint *bucket= cache->hash_bucket +
+                    (cache->rec_hash[i] & (cache->hash_size - 1));
+      cache->hash_next[i]= *bucket;
+      *bucket= i + 1;
+    }
+  }
+}
+
+
+/**
+  Compare the ref keys of two records of a batched key access join cache
+  in the order of the index.
+
+  @param arg  JOIN_TAB of the cache
+  @param a    record number
+  @param b    record number
+*/
+
+static int
+join_cache_bka_key_cmp(const void *arg, const void *a, const void *b)
+{
+  JOIN_TAB *tab= (JOIN_TAB*) arg;
+  JOIN_CACHE *cache= &tab->cache;
+  uint step= ALIGN_SIZE(cache->bka_key_length);
+  const uchar *key_a= cache->bka_keys + *(const uint*) a * step;
+  const uchar *key_b= cache->bka_keys + *(const uint*) b * step;
+  KEY_PART_INFO *part= tab->table->key_info[tab->ref.key].key_part;
+  KEY_PART_INFO *end= part + tab->ref.key_parts;
+
+  for (; part < end; part++)
+  {
+    uint length= part->store_length;
+    int cmp;
+    if (part->null_bit)
+    {
+      /* NULL comes first; the value of a NULL part is not set */
+      bool is_null= *key_a;
+      if (*key_a != *key_b)
+        return is_null ? -1 : 1;
+      key_a++;
+      key_b++;
+      length--;
+      if (is_null)
+      {
+        key_a+= length;
+        key_b+= length;
+        continue;
+      }
+    }
+    if ((cmp= part->field->key_cmp(key_a, key_b)))
+      return cmp;
+    key_a+= length;
+    key_b+= length;
+  }
+  return 0;
+}
+
+
+/**
+  Prepare the multi-range read of a batched key access join cache.
+
+  Computes the ref key of each record in the buffer and makes a range of
+  each distinct key. The records with the key of range r are
+  bka_order[bka_range_start[r]] to bka_order[bka_range_start[r + 1] - 1].
+  A record whose key has a NULL that no row can match is left out.
+
+  @return number of ranges
+*/
+
+static uint
+join_cache_bka_build(JOIN_TAB *tab)
+{
+  JOIN_CACHE *cache= &tab->cache;
+  TABLE_REF *ref= &tab->ref;
+  uint step= ALIGN_SIZE(cache->bka_key_length);
+  key_part_map keypart_map= make_prev_keypart_map(ref->key_parts);
+  uint i, j, keys, ranges;
+
+  DBUG_ASSERT(cache->records <= cache->max_records);
+  reset_cache_read(cache);
+  for (i= keys= 0; i < cache->records; i++)
+  {
+    cache->rec_pos[i]= cache->pos;
+    read_cached_record(tab);
+    /* Late NULLs filtering, as in join_read_always_key() */
+    for (j= 0; j < ref->key_parts; j++)
+    {
+      if ((ref->null_rejecting & 1 << j) && ref->items[j]->is_null())
+        break;
+    }
+    if (j < ref->key_parts ||
+        cp_buffer_from_ref(tab->join->thd, tab->table, ref))
+      continue;
+    memcpy(cache->bka_keys + i * step, ref->key_buff, ref->key_length);
+    cache->bka_order[keys++]= i;
+  }
+  my_qsort2(cache->bka_order, keys, sizeof(uint), join_cache_bka_key_cmp,
+            tab);
+
+  for (i= ranges= 0; i < keys; i++)
+  {
+    KEY_MULTI_RANGE *range;
+    if (i && !join_cache_bka_key_cmp(tab, cache->bka_order + i - 1,
+                                     cache->bka_order + i))
+      continue;                                 // Same key as the previous
+    cache->bka_range_start[ranges]= i;
+    range= cache->bka_ranges + ranges++;
+    range->start_key.key= cache->bka_keys + cache->bka_order[i] * step;
+    range->start_key.length= ref->key_length;
+    range->start_key.keypart_map= keypart_map;
+    range->start_key.flag= HA_READ_KEY_EXACT;
+    range->end_key= range->start_key;
+    range->end_key.flag= HA_READ_AFTER_KEY;
+    range->range_flag= EQ_RANGE;
+    if (tab->type == JT_EQ_REF)
+      range->range_flag|= UNIQUE_RANGE;
+    range->ptr= 0;
+  }
+  cache->bka_range_start[ranges]= keys;
+  return ranges;
+}
+
+
 static bool
 cmp_buffer_with_ref(JOIN_TAB *tab)
 {
@@ -16670,6 +18339,7 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
       char buff[512]; 
       char buff1[512], buff2[512], buff3[512];
       char keylen_str_buf[64];
+      char hash_type_buf[32];
       String extra(buff, sizeof(buff),cs);
       char table_name_buffer[NAME_LEN];
       String tmp1(buff1,sizeof(buff1),cs);
@@ -16735,9 +18405,19 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
 #endif
       }
       /* "type" column */
-      item_list.push_back(new Item_string(join_type_str[tab->type],
-					  strlen(join_type_str[tab->type]),
-					  cs));
+      if (i > 0 && tab[-1].next_select == sub_select_cache &&
+          tab->cache.hash_keys)
+      {
+        /* The join buffer is probed by hash: "hash_ALL" and so on */
+        uint len= (uint) (strxnmov(hash_type_buf, sizeof(hash_type_buf) - 1,
+                                   "hash_", join_type_str[tab->type],
+                                   NullS) - hash_type_buf);
+        item_list.push_back(new Item_string(hash_type_buf, len, cs));
+      }
+      else
+        item_list.push_back(new Item_string(join_type_str[tab->type],
+                                            strlen(join_type_str[tab->type]),
+                                            cs));
       /* Build "possible_keys" value and add it to item_list */
       if (!tab->keys.is_clear_all())
       {
@@ -16988,8 +18668,37 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
             break;
           }
         }
+        if (tab->sj_strategy == SJ_OPT_LOOSE_SCAN)
+          extra.append(STRING_WITH_LEN("; LooseScan"));
+        if (tab->sj_strategy == SJ_OPT_FIRST_MATCH)
+        {
+          /* The join goes back to the table before the inner tables */
+          JOIN_TAB *first= tab;
+          while (first > join->join_tab + join->const_tables &&
+                 first[-1].last_sj_inner_tab == tab)
+            first--;
+          extra.append(STRING_WITH_LEN("; FirstMatch"));
+          if (first > join->join_tab + join->const_tables)
+          {
+            extra.append('(');
+            extra.append(first[-1].table->alias);
+            extra.append(')');
+          }
+        }
+        if (i == join->const_tables &&
+            join->join_tab[join->tables - 1].sj_strategy ==
+            SJ_OPT_DUPS_WEEDOUT)
+          extra.append(STRING_WITH_LEN("; Start temporary"));
+        if (tab->sj_strategy == SJ_OPT_DUPS_WEEDOUT)
+          extra.append(STRING_WITH_LEN("; End temporary"));
         if (i > 0 && tab[-1].next_select == sub_select_cache)
-          extra.append(STRING_WITH_LEN("; Using join buffer"));
+        {
+          if (tab->cache.bka_key_length)
+            extra.append(STRING_WITH_LEN("; Using join buffer "
+                                         "(Batched Key Access)"));
+          else
+            extra.append(STRING_WITH_LEN("; Using join buffer"));
+        }
         
         /* Skip initial "; "*/
         const char *str= extra.ptr();
@@ -17112,6 +18821,8 @@ static void print_join(THD *thd,
       /* MySQL converts right to left joins */
       str->append(STRING_WITH_LEN(" left join "));
     }
+    else if (curr->sj_inner)
+      str->append(STRING_WITH_LEN(" semi join "));
     else if (curr->straight)
       str->append(STRING_WITH_LEN(" straight_join "));
     else
@@ -117,9 +117,70 @@ typedef struct st_join_cache {
   uint records,record_nr,ptr_record,fields,length,blobs;
   CACHE_FIELD *field,**blob_ptr;
   SQL_SELECT *select;
+  /*
+    Hash join: hash_outer[i] = hash_inner[i] are equalities between fields
+    of the cached tables and of the joined table. Each flush hashes the
+    records in the buffer on hash_outer and chains them by bucket, so an
+    inner row is only compared with the records that have its hash.
+  */
+  uint hash_keys, hash_size, max_records;
+  Field **hash_outer, **hash_inner;
+  uint *hash_bucket, *hash_next;      /**< record number + 1, 0 ends chain */
+  ulong *rec_hash;
+  uchar **rec_pos;                    /**< 0 if the key has a NULL part */
+  /*
+    Batched key access: the joined table is read by ref. Each flush builds
+    the ref keys of the records in the buffer, sorts them and reads the
+    table with one multi-range read of the distinct keys, so that the
+    index is looked up in key order and once per key.
+  */
+  uint bka_key_length;                /**< 0 if the cache is not BKA */
+  uchar *bka_keys;                    /**< ref key of each record */
+  uint *bka_order;                    /**< records sorted by key */
+  uint *bka_range_start;              /**< first in bka_order of a range */
+  KEY_MULTI_RANGE *bka_ranges;
 } JOIN_CACHE;
 
 
+/**
+  Hash aggregation of GROUP BY into a temporary table (end_hash_update).
+
+  The groups are kept in an open addressing hash table in memory, each as
+  its group key followed by a record of the temporary table holding the
+  aggregate values. Once the groups take the space an in-memory temporary
+  table may use, the rows of new groups are written to one of
+  HASH_GROUP_PARTITIONS files chosen by their hash. When the join is done
+  the groups are written to the table, and each file is read back and
+  aggregated the same way, one at a time.
+*/
+
+#define HASH_GROUP_PARTITION_BITS 4
+#define HASH_GROUP_PARTITIONS     (1 << HASH_GROUP_PARTITION_BITS)
+
+typedef struct st_hash_group_slot {
+  ulong hash;
+  uchar *group;                       /**< 0 if the slot is free */
+} HASH_GROUP_SLOT;
+
+typedef struct st_hash_group_file {
+  IO_CACHE *file;
+  uint level;                         /**< times its rows were spilled */
+} HASH_GROUP_FILE;
+
+typedef struct st_hash_group {
+  MEM_ROOT mem_root;                  /**< groups: next, key, record */
+  HASH_GROUP_SLOT *slots;
+  uint slot_count, records;
+  uint key_length, group_length, row_length;
+  ulonglong size, max_size;
+  uchar *first, **last;               /**< groups in insertion order */
+  uint level;                         /**< of the rows being aggregated */
+  IO_CACHE *spill[HASH_GROUP_PARTITIONS];
+  DYNAMIC_ARRAY pending;              /**< HASH_GROUP_FILE to aggregate */
+  bool inited;
+} HASH_GROUP;
+
+
 /*
   The structs which holds the join connections and join states
 */
@@ -143,6 +204,12 @@ enum enum_nested_loop_state
 #define TAB_INFO_USING_WHERE 4
 #define TAB_INFO_FULL_SCAN_ON_NULL 8
 
+/* Values for POSITION::sj_strategy and JOIN_TAB::sj_strategy */
+#define SJ_OPT_NONE 0
+#define SJ_OPT_FIRST_MATCH 1
+#define SJ_OPT_LOOSE_SCAN 2
+#define SJ_OPT_DUPS_WEEDOUT 3
+
 typedef enum_nested_loop_state
 (*Next_select_func)(JOIN *, struct st_join_table *, bool);
 typedef int (*Read_record_func)(struct st_join_table *tab);
@@ -222,6 +289,22 @@ typedef struct st_join_table {
   /** Bitmap of nested joins this table is part of */
   nested_join_map embedding_map;
 
+  /*
+    Semi-join execution (see setup_semijoin_strategy). sj_strategy is the
+    strategy ending at this table, for EXPLAIN.
+  */
+  uint          sj_strategy;
+  /* FirstMatch: last inner table, set for all inner tables of the range */
+  st_join_table *last_sj_inner_tab;
+  /* FirstMatch: the last inner table found a match for the outer row */
+  bool          sj_matched;
+  /* LooseScan: first key part of the last row passed on, and its length */
+  uchar         *loosescan_buf;
+  uint          loosescan_key_len;
+  bool          loosescan_match;
+  /* Duplicate weedout: check the row combination before passing it on */
+  bool          check_weed_out;
+
   void cleanup();
   inline bool is_using_loose_index_scan()
   {
@@ -265,9 +348,33 @@ typedef struct st_position
 
   /* If ref-based access is used: bitmap of tables this table depends on  */
   table_map ref_depend_map;
+
+  /*
+    SJ_OPT_* strategy that removes the semi-join duplicates if this table
+    is the last inner table of the semi-join in the join order, and the
+    index LooseScan reads the table in.
+  */
+  uint sj_strategy;
+  uint loosescan_key;
 } POSITION;
 
 
+/*
+  Join order of a select, kept in the statement memory of a prepared
+  statement or a stored routine for its next executions (see
+  choose_plan()). It is reused while the same tables are constant and
+  the row estimates of the others stay close to the cached ones.
+*/
+
+typedef struct st_join_order_cache
+{
+  table_map const_tables;               /* Constant tables of the plan */
+  uint tables;                          /* Number of tables of the join */
+  uint *order;                          /* tablenr of each position */
+  ha_rows *records;                     /* Its found_records then */
+} JOIN_ORDER_CACHE;
+
+
 typedef struct st_rollup
 {
   enum State { STATE_NONE, STATE_INITED, STATE_READY };
@@ -333,6 +440,19 @@ public:
   TABLE    *tmp_table;
   /// used to store 2 possible tmp table of SELECT
   TABLE    *exec_tmp_table1, *exec_tmp_table2;
+  /*
+    Semi-join made from an IN subquery by JOIN::prepare: the tables of the
+    subquery, the outer tables its condition refers to, those its WHERE
+    clause refers to, and the subquery column if LooseScan can read it
+    from an index
+  */
+  table_map sj_inner_tables, sj_depends, sj_corr_tables;
+  Item_field *sj_inner_field;
+  /// rowids of the outer row combinations passed on by duplicate weedout
+  TABLE    *sj_tmp_table;
+  TMP_TABLE_PARAM *sj_tmp_table_param;
+  /// groups of end_hash_update, when the temporary table is grouped by it
+  HASH_GROUP *hash_group;
   THD	   *thd;
   Item_sum  **sum_funcs, ***sum_funcs_end;
   /** second copy of sumfuncs (for queries with 2 temporary tables */
@@ -475,6 +595,11 @@ public:
     examined_rows= 0;
     exec_tmp_table1= 0;
     exec_tmp_table2= 0;
+    sj_inner_tables= sj_depends= sj_corr_tables= 0;
+    sj_inner_field= 0;
+    sj_tmp_table= 0;
+    sj_tmp_table_param= 0;
+    hash_group= 0;
     sortorder= 0;
     table_reexec[0]= 0;
     join_tab_reexec= 0;
@@ -6862,6 +6862,43 @@ ST_FIELD_INFO referential_constraints_fields_info[]=
 };
 
 
+ST_FIELD_INFO slave_parallel_workers_fields_info[]=
+{
+  {"WORKER_ID", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"THREAD_ID", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"QUEUED_TRANSACTIONS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"QUEUED_EVENTS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"LAG_SECONDS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"TRANSACTIONS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"EVENTS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"RETRIES", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"COMMIT_WAITS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"COMMIT_WAIT_USECS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {"QUEUE_FULL_WAITS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0,
+   SKIP_OPEN_TABLE},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE}
+};
+
+
+#ifndef HAVE_REPLICATION
+/* Without replication there are no slave workers to show */
+int fill_slave_parallel_workers(THD *thd, TABLE_LIST *tables, COND *cond)
+{
+  return 0;
+}
+#endif
+
+
 /*
   Description of ST_FIELD_INFO in table.h
 
@@ -6944,6 +6981,11 @@ ST_SCHEMA_TABLE schema_tables[]=
    fill_table_stats, NULL, NULL, -1, -1, false, 0},
   {"DB_STATISTICS", db_stats_fields_info, create_schema_table,
    fill_db_stats, NULL, NULL, -1, -1, false, 0},
+  {"ADMISSION_CONTROL_POOLS", admission_pools_fields_info,
+   create_schema_table, fill_admission_pools, NULL, NULL, -1, -1, false, 0},
+  {"SLAVE_PARALLEL_WORKERS", slave_parallel_workers_fields_info,
+   create_schema_table, fill_slave_parallel_workers, NULL, NULL, -1, -1,
+   false, 0},
   {"TRIGGERS", triggers_fields_info, create_schema_table,
    get_all_tables, make_old_format, get_schema_triggers_record, 5, 6, 0,
    OPEN_TABLE_ONLY},
@@ -19,10 +19,14 @@
 #define MERGEBUFF2		15
 
 /*
-   The structure SORT_ADDON_FIELD describes a fixed layout
+   The structure SORT_ADDON_FIELD describes a layout
    for field values appended to sorted values in records to be sorted
    in the sort buffer.
-   Only fixed layout is supported now.
+   In the fixed layout each value has its own place in the record.
+   In the packed layout, used when some of the fields are CHAR or
+   VARCHAR, the record starts with the 2-byte length of the appended
+   part and the values follow each other with their packed length; null
+   values take no space (see make_sortkey()).
    Null bit maps for the appended values is placed before the values 
    themselves. Offsets are from the last sorted field, that is from the
    record referefence, which is still last component of sorted records.
@@ -48,6 +52,7 @@ typedef struct st_buffpek {		/* Struktur om sorteringsbuffrarna */
   ha_rows count;			/* Number of rows in table */
   ulong mem_count;			/* numbers of keys in memory */
   ulong max_keys;			/* Max keys in buffert */
+  my_off_t end_pos;			/* End of the sequence in the file */
 } BUFFPEK;
 
 struct BUFFPEK_COMPARE_CONTEXT
@@ -70,6 +75,8 @@ typedef struct st_sort_param {
   SORT_ADDON_FIELD *addon_field; /* Descriptors for companion fields */
   uchar *unique_buff;
   bool not_killable;
+  bool packed_addons;       /* Records have their packed length */
+  uchar *sort_buffer_end;   /* Packed records are made down from here */
   char* tmp_buffer;
   /* The fields below are used only by Unique class */
   qsort2_cmp compare;
@@ -77,6 +84,16 @@ typedef struct st_sort_param {
 } SORTPARAM;
 
 
+/* Length of a record in the sort buffer or in a sort file */
+
+inline uint sort_record_length(SORTPARAM *param, uchar *record)
+{
+  return (param->packed_addons ?
+          param->sort_length + uint2korr(record + param->sort_length) :
+          param->rec_length);
+}
+
+
 int merge_many_buff(SORTPARAM *param, uchar *sort_buffer,
 		    BUFFPEK *buffpek,
 		    uint *maxbuffer, IO_CACHE *t_file);
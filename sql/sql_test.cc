@@ -89,11 +89,13 @@ void print_cached_tables(void)
   for (idx=unused=0 ; idx < open_cache.records ; idx++)
   {
     TABLE *entry=(TABLE*) hash_element(&open_cache,idx);
+    THD *in_use= entry->in_use == TABLE_CACHE_PARKED ? 0 : entry->in_use;
     printf("%-14.14s %-32s%6ld%8ld%6d  %s\n",
            entry->s->db.str, entry->s->table_name.str, entry->s->version,
-	   entry->in_use ? entry->in_use->thread_id : 0L,
+	   in_use ? in_use->thread_id : 0L,
 	   entry->db_stat ? 1 : 0,
-           entry->in_use ? lock_descriptions[(int)entry->reginfo.lock_type] : "Not in use");
+           in_use ? lock_descriptions[(int)entry->reginfo.lock_type] :
+           entry->in_use ? "Parked" : "Not in use");
     if (!entry->in_use)
       unused++;
   }
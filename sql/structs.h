@@ -413,6 +413,8 @@ typedef struct st_table_stats {
   const char* engine_name;
 } TABLE_STATS;
 
+#define MAX_DB_STATS_ENTRIES 255
+
 typedef struct st_db_stats {
 	char db[NAME_LEN + 1];
 	hyperloglog_t hll;
@@ -164,6 +164,7 @@ typedef struct st_filesort_info
   size_t    addon_length;       /* Length of the buffer */
   struct st_sort_addon_field *addon_field;     /* Pointer to the fields info */
   void    (*unpack)(struct st_sort_addon_field *, uchar *); /* To unpack back */
+  bool      packed_addons;      /* Records start with their length */
   uchar     *record_pointers;    /* If sorted in memory */
   ha_rows   found_records;      /* How many records in sort */
 } FILESORT_INFO;
@@ -975,6 +976,8 @@ enum enum_schema_tables
   SCH_TABLE_PRIVILEGES,
   SCH_TABLE_STATISTICS,
   SCH_DB_STATISTICS,
+  SCH_ADMISSION_CONTROL_POOLS,
+  SCH_SLAVE_PARALLEL_WORKERS,
   SCH_TRIGGERS,
   SCH_USER_PRIVILEGES,
   SCH_USER_STATISTICS,
@@ -1360,6 +1363,7 @@ struct TABLE_LIST
   size_t        table_name_length;
   bool          updatable;		/* VIEW/TABLE can be updated now */
   bool		straight;		/* optimize with prev table */
+  bool          sj_inner;               /* table of a semi-joined subquery */
   bool          updating;               /* for replicate-do/ignore table */
   bool		force_index;		/* prefer index over table scan */
   bool          ignore_leaves;          /* preload only non-leaf nodes */
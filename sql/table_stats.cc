@@ -332,6 +332,11 @@ ST_FIELD_INFO table_stats_fields_info[]=
   {"COMPRESS_PRIMARY_OK_USECS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, SKIP_OPEN_TABLE},
   {"UNCOMPRESS_OPS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, SKIP_OPEN_TABLE},
   {"UNCOMPRESS_USECS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, SKIP_OPEN_TABLE},
+  {"COMPRESS_LZ4_OPS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, SKIP_OPEN_TABLE},
+  {"COMPRESS_LZ4_OPS_OK", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, SKIP_OPEN_TABLE},
+  {"COMPRESS_LZ4_USECS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, SKIP_OPEN_TABLE},
+  {"UNCOMPRESS_LZ4_OPS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, SKIP_OPEN_TABLE},
+  {"UNCOMPRESS_LZ4_USECS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, SKIP_OPEN_TABLE},
 
   {"ROWS_INDEX_FIRST", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, SKIP_OPEN_TABLE},
   {"ROWS_INDEX_NEXT", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, SKIP_OPEN_TABLE},
@@ -504,6 +509,11 @@ int fill_table_stats(THD *thd, TABLE_LIST *tables, COND *cond)
     table->field[f++]->store(table_stats->comp_stat.compressed_primary_ok_usec, TRUE);
     table->field[f++]->store(table_stats->comp_stat.decompressed, TRUE);
     table->field[f++]->store(table_stats->comp_stat.decompressed_usec, TRUE);
+    table->field[f++]->store(table_stats->comp_stat.compressed_lz4, TRUE);
+    table->field[f++]->store(table_stats->comp_stat.compressed_lz4_ok, TRUE);
+    table->field[f++]->store(table_stats->comp_stat.compressed_lz4_usec, TRUE);
+    table->field[f++]->store(table_stats->comp_stat.decompressed_lz4, TRUE);
+    table->field[f++]->store(table_stats->comp_stat.decompressed_lz4_usec, TRUE);
 
     table->field[f++]->store(table_stats->rows_index_first, TRUE);
     table->field[f++]->store(table_stats->rows_index_next, TRUE);
@@ -22,7 +22,8 @@ int hp_rectest(register HP_INFO *info, register const uchar *old)
 {
   DBUG_ENTER("hp_rectest");
 
-  if (memcmp(info->current_ptr,old,(size_t) info->s->reclength))
+  /* Only the fixed part of variable-length rows is compared */
+  if (memcmp(info->current_ptr,old,(size_t) info->s->fixed_length))
   {
     DBUG_RETURN((my_errno=HA_ERR_RECORD_CHANGED)); /* Record have changed */
   }
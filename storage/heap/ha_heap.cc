@@ -384,7 +384,11 @@ int ha_heap::rnd_pos(uchar * buf, uchar *pos)
   int error;
   HEAP_PTR heap_position;
   ha_statistic_increment(&SSV::ha_read_rnd_count);
-  memcpy_fixed((char*) &heap_position, pos, sizeof(HEAP_PTR));
+  if (file->s->columns)
+    heap_position= heap_row_position(file, (ulong) my_get_ptr(pos,
+                                                              ref_length));
+  else
+    memcpy_fixed((char*) &heap_position, pos, sizeof(HEAP_PTR));
   error=heap_rrnd(file, buf, heap_position);
   table->status=error ? STATUS_NOT_FOUND: 0;
   stats.rows_requested++;
@@ -392,9 +396,34 @@ int ha_heap::rnd_pos(uchar * buf, uchar *pos)
   return error;
 }
 
+/*
+  Continue a table scan from a position; only references of
+  variable-length rows are scan positions
+*/
+
+int ha_heap::restart_rnd_next(uchar *buf, uchar *pos)
+{
+  int error;
+  if (!file->s->columns)
+    return HA_ERR_WRONG_COMMAND;
+  error= heap_scan_restart(file, buf, (ulong) my_get_ptr(pos, ref_length));
+  table->status=error ? STATUS_NOT_FOUND: 0;
+  stats.rows_requested++;
+  stats.rows_read += (error == 0);
+  return error;
+}
+
 void ha_heap::position(const uchar *record)
 {
-  *(HEAP_PTR*) ref= heap_position(file);	// Ref is aligned
+  /*
+    Variable-length rows are referenced by row number, high byte first,
+    so that filesort returns rows with equal keys in the order they were
+    written, like it does for the MyISAM tables these used to be.
+  */
+  if (file->s->columns)
+    my_store_ptr(ref, ref_length, (my_off_t) heap_row_number(file));
+  else
+    *(HEAP_PTR*) ref= heap_position(file);	// Ref is aligned
 }
 
 int ha_heap::info(uint flag)
@@ -635,26 +664,129 @@ ha_rows ha_heap::records_in_range(uint inx, key_range *min_key,
 }
 
 
+/*
+  Describe the variable-length part of the rows of an internal table
+
+  SYNOPSIS
+    heap_var_columns()
+    table_arg           Table
+    fixed_length        Bytes of the record that the indexes read in place
+    columndef     OUT   Columns to store in the variable-length part
+
+  DESCRIPTION
+    Everything after fixed_length bytes, and the blobs before it, is
+    packed into chunks (see hp_dynrec.c). Adjacent columns that are not
+    VARCHAR or BLOB are merged into one column.
+
+    The format is only worth it if the table has blobs, which fixed-length
+    rows can't store, or enough VARCHAR bytes in the packed part to pay
+    for the chunk overhead.
+
+  RETURN
+    0   Use fixed-length rows
+    #   Number of columns in columndef
+*/
+
+static uint heap_var_columns(TABLE *table_arg, uint fixed_length,
+                             HP_COLUMNDEF *columndef)
+{
+  uint columns= 0, offset= fixed_length, varchar_length= 0;
+  bool blobs= 0;
+  HP_COLUMNDEF *column;
+
+  for (Field **field_ptr= table_arg->field; *field_ptr; field_ptr++)
+  {
+    Field *field= *field_ptr;
+    uint start= (uint) field->offset(table_arg->record[0]);
+    uint length= field->pack_length();
+    uint8 type= HP_COLUMN_FIXED, length_bytes= 0;
+
+    if (field->flags & BLOB_FLAG)
+    {
+      type= HP_COLUMN_BLOB;
+      length_bytes= (uint8) ((Field_blob*) field)->pack_length_no_ptr();
+      blobs= 1;
+    }
+    else if (start < fixed_length)
+      continue;                                 // Stored in the fixed part
+    else if (field->real_type() == MYSQL_TYPE_VARCHAR)
+    {
+      type= HP_COLUMN_VARCHAR;
+      length_bytes= (uint8) ((Field_varstring*) field)->length_bytes;
+      varchar_length+= field->field_length;
+    }
+    if (start >= fixed_length)
+    {
+      if (start < offset)
+        return 0;                               // Not in record order
+      if (start > offset)
+      {
+        /* Null bytes of GROUP BY columns and other unnamed bytes */
+        column= columndef + columns++;
+        column->type= HP_COLUMN_FIXED;
+        column->length_bytes= 0;
+        column->offset= offset;
+        column->length= start - offset;
+      }
+      offset= start + length;
+    }
+    column= columns ? columndef + columns - 1 : 0;
+    if (type == HP_COLUMN_FIXED && column && column->type == HP_COLUMN_FIXED &&
+        column->offset + column->length == start)
+    {
+      column->length+= length;
+      continue;
+    }
+    column= columndef + columns++;
+    column->type= type;
+    column->length_bytes= length_bytes;
+    column->offset= start;
+    column->length= length;
+  }
+  if (offset < table_arg->s->reclength)
+  {
+    column= columndef + columns++;
+    column->type= HP_COLUMN_FIXED;
+    column->length_bytes= 0;
+    column->offset= offset;
+    column->length= table_arg->s->reclength - offset;
+  }
+  if (!blobs && varchar_length < HP_VAR_CHUNK_SIZE)
+    return 0;
+  return columns;
+}
+
+
 int ha_heap::create(const char *name, TABLE *table_arg,
 		    HA_CREATE_INFO *create_info)
 {
   uint key, parts, mem_per_row= 0, keys= table_arg->s->keys;
   uint auto_key= 0, auto_key_type= 0;
-  ha_rows max_rows;
+  uint fixed_length= 0, max_columns= 0;
+  ha_rows max_rows, share_max_rows= table_arg->s->max_rows;
   HP_KEYDEF *keydef;
   HA_KEYSEG *seg;
+  HP_COLUMNDEF *columndef;
   int error;
   TABLE_SHARE *share= table_arg->s;
   bool found_real_auto_increment= 0;
 
   for (key= parts= 0; key < keys; key++)
     parts+= table_arg->key_info[key].key_parts;
+  /*
+    Internal temporary tables may use variable-length rows; there is at
+    most one gap before every field and one after the last one.
+  */
+  if (internal_table)
+    max_columns= share->fields * 2 + 1;
 
   if (!(keydef= (HP_KEYDEF*) my_malloc(keys * sizeof(HP_KEYDEF) +
-				       parts * sizeof(HA_KEYSEG),
+				       parts * sizeof(HA_KEYSEG) +
+                                       max_columns * sizeof(HP_COLUMNDEF),
 				       MYF(MY_WME))))
     return my_errno;
   seg= my_reinterpret_cast(HA_KEYSEG*) (keydef + keys);
+  columndef= (HP_COLUMNDEF*) (seg + parts);
   for (key= 0; key < keys; key++)
   {
     KEY *pos= table_arg->key_info+key;
@@ -706,12 +838,15 @@ int ha_heap::create(const char *name, TABLE *table_arg,
       {
 	seg->null_bit= field->null_bit;
 	seg->null_pos= (uint) (field->null_ptr - (uchar*) table_arg->record[0]);
+        set_if_bigger(fixed_length, seg->null_pos + 1);
       }
       else
       {
 	seg->null_bit= 0;
 	seg->null_pos= 0;
       }
+      set_if_bigger(fixed_length, (uint) key_part->offset +
+                    field->pack_length());
       if (field->flags & AUTO_INCREMENT_FLAG &&
           table_arg->found_next_number_field &&
           key == share->next_number_index)
@@ -725,15 +860,22 @@ int ha_heap::create(const char *name, TABLE *table_arg,
       }
     }
   }
-  mem_per_row+= MY_ALIGN(share->reclength + 1, sizeof(char*));
-  max_rows = (ha_rows) (table_arg->in_use->variables.max_heap_table_size /
-			(ulonglong) mem_per_row);
+  HP_CREATE_INFO hp_create_info;
+  hp_create_info.columns= (max_columns ?
+                           heap_var_columns(table_arg, fixed_length,
+                                            columndef) : 0);
+  hp_create_info.columndef= columndef;
+  hp_create_info.fixed_length= fixed_length;
+  if (hp_create_info.columns)
+    mem_per_row+= MY_ALIGN(fixed_length + HP_VAR_HEADER_LENGTH + 1,
+                           sizeof(char*)) + HP_VAR_CHUNK_SIZE;
+  else
+    mem_per_row+= MY_ALIGN(share->reclength + 1, sizeof(char*));
   if (table_arg->found_next_number_field)
   {
     keydef[share->next_number_index].flag|= HA_AUTO_KEY;
     found_real_auto_increment= share->next_number_key_offset == 0;
   }
-  HP_CREATE_INFO hp_create_info;
   hp_create_info.auto_key= auto_key;
   hp_create_info.auto_key_type= auto_key_type;
   hp_create_info.auto_increment= (create_info->auto_increment_value ?
@@ -741,12 +883,23 @@ int ha_heap::create(const char *name, TABLE *table_arg,
   hp_create_info.max_table_size=current_thd->variables.max_heap_table_size;
   hp_create_info.with_auto_increment= found_real_auto_increment;
   hp_create_info.internal_table= internal_table;
+  if (hp_create_info.columns)
+  {
+    /*
+      share->max_rows of a temporary table is tmp_table_size divided by
+      the full record length; with variable-length rows the memory used
+      is the limit instead.
+    */
+    set_if_smaller(hp_create_info.max_table_size,
+                   current_thd->variables.tmp_table_size);
+    share_max_rows= 0;
+  }
   max_rows = (ha_rows) (hp_create_info.max_table_size / mem_per_row);
   error= heap_create(name,
 		     keys, keydef, share->reclength,
-		     (ulong) ((share->max_rows < max_rows &&
-			       share->max_rows) ? 
-			      share->max_rows : max_rows),
+		     (ulong) ((share_max_rows < max_rows &&
+			       share_max_rows) ? 
+			      share_max_rows : max_rows),
 		     (ulong) share->min_rows, &hp_create_info, &internal_share);
   my_free((uchar*) keydef, MYF(0));
   DBUG_ASSERT(file == 0);
@@ -47,8 +47,11 @@ public:
     return ((table_share->key_info[inx].algorithm == HA_KEY_ALG_BTREE) ?
             "BTREE" : "HASH");
   }
-  /* Rows also use a fixed-size format */
-  enum row_type get_row_type() const { return ROW_TYPE_FIXED; }
+  /* Rows use a fixed-size format, except in some internal tables */
+  enum row_type get_row_type() const
+  {
+    return (file && file->s->columns) ? ROW_TYPE_DYNAMIC : ROW_TYPE_FIXED;
+  }
   const char **bas_ext() const;
   ulonglong table_flags() const
   {
@@ -94,6 +97,7 @@ public:
   int rnd_init(bool scan);
   int rnd_next(uchar *buf);
   int rnd_pos(uchar * buf, uchar *pos);
+  int restart_rnd_next(uchar *buf, uchar *pos);
   void position(const uchar *record);
   int info(uint);
   int extra(enum ha_extra_function operation);
@@ -34,6 +34,23 @@ C_MODE_START
 #define HP_MIN_RECORDS_IN_BLOCK 16
 #define HP_MAX_RECORDS_IN_BLOCK 8192
 
+/*
+  Size of one chunk of a variable-length row, including the pointer to
+  the next chunk of the row.
+*/
+
+#define HP_VAR_CHUNK_SIZE 128
+
+/* Chain pointer and blob length stored after the fixed part of a row */
+
+#define HP_VAR_HEADER_LENGTH (sizeof(uchar*) + 4)
+
+/* Row number stored before the "not deleted" byte of a variable row */
+
+#define HP_ROW_NUMBER_LENGTH 4
+#define hp_var_header_length(share) \
+  ((share)->visible - (share)->fixed_length - HP_ROW_NUMBER_LENGTH)
+
 	/* Some extern variables */
 
 extern LIST *heap_open_list,*heap_share_list;
@@ -100,6 +117,10 @@ extern my_bool hp_if_null_in_key(HP_KEYDEF *keyinfo, const uchar *record);
 extern int hp_close(register HP_INFO *info);
 extern void hp_clear(HP_SHARE *info);
 extern void hp_clear_keys(HP_SHARE *info);
+extern int hp_extract_record(HP_INFO *info, uchar *record, const uchar *pos);
+extern int hp_write_var_part(HP_SHARE *share, const uchar *record,
+                             uchar *header, my_bool check_size);
+extern void hp_free_var_part(HP_SHARE *share, const uchar *header);
 extern uint hp_rb_pack_key(HP_KEYDEF *keydef, uchar *key, const uchar *old,
                            key_part_map keypart_map);
 #ifdef THREAD
@@ -25,7 +25,7 @@ int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
 		uint reclength, ulong max_records, ulong min_records,
 		HP_CREATE_INFO *create_info, HP_SHARE **res)
 {
-  uint i, j, key_segs, max_length, length;
+  uint i, j, key_segs, max_length, length, fixed_length, visible;
   HP_SHARE *share= 0;
   HA_KEYSEG *keyseg;
   DBUG_ENTER("heap_create");
@@ -50,6 +50,29 @@ int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
       so the record length should be at least sizeof(uchar*)
     */
     set_if_bigger(reclength, sizeof (uchar*));
+
+    /*
+      Variable-length rows keep the first fixed_length bytes of the record
+      in block, followed by the chain of the rest of the row and the
+      length of its blobs. See hp_dynrec.c
+    */
+    fixed_length= reclength;
+    visible= reclength;
+    if (create_info->columns)
+    {
+      fixed_length= create_info->fixed_length;
+      visible= fixed_length + sizeof(uchar*) + HP_ROW_NUMBER_LENGTH;
+      for (i= 0; i < create_info->columns; i++)
+      {
+        DBUG_ASSERT(create_info->columndef[i].offset >= fixed_length ||
+                    create_info->columndef[i].type == HP_COLUMN_BLOB);
+        if (create_info->columndef[i].type == HP_COLUMN_BLOB)
+        {
+          visible= fixed_length + HP_VAR_HEADER_LENGTH + HP_ROW_NUMBER_LENGTH;
+          break;
+        }
+      }
+    }
     
     for (i= key_segs= max_length= 0, keyinfo= keydef; i < keys; i++, keyinfo++)
     {
@@ -133,13 +156,28 @@ int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
     }
     if (!(share= (HP_SHARE*) my_malloc((uint) sizeof(HP_SHARE)+
 				       keys*sizeof(HP_KEYDEF)+
-				       key_segs*sizeof(HA_KEYSEG),
+				       key_segs*sizeof(HA_KEYSEG)+
+                                       create_info->columns*
+                                       sizeof(HP_COLUMNDEF),
 				       MYF(MY_ZEROFILL))))
       goto err;
     share->keydef= (HP_KEYDEF*) (share + 1);
     share->key_stat_version= 1;
     keyseg= (HA_KEYSEG*) (share->keydef + keys);
-    init_block(&share->block, reclength + 1, min_records, max_records);
+    init_block(&share->block, visible + 1, min_records, max_records);
+    share->fixed_length= fixed_length;
+    share->visible= visible;
+    if ((share->columns= create_info->columns))
+    {
+      share->columndef= (HP_COLUMNDEF*) (keyseg + key_segs);
+      memcpy(share->columndef, create_info->columndef,
+             (size_t) (sizeof(HP_COLUMNDEF) * create_info->columns));
+      for (i= 0; i < share->columns; i++)
+        if (share->columndef[i].type == HP_COLUMN_BLOB)
+          share->blobs++;
+      init_block(&share->var_block, HP_VAR_CHUNK_SIZE, min_records,
+                 max_records);
+    }
 	/* Fix keys */
     memcpy(share->keydef, keydef, (size_t) (sizeof(keydef[0]) * keys));
     for (i= 0, keyinfo= share->keydef; i < keys; i++, keyinfo++)
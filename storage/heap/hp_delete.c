@@ -43,9 +43,11 @@ int heap_delete(HP_INFO *info, const uchar *record)
   }
 
   info->update=HA_STATE_DELETED;
+  if (share->columns)
+    hp_free_var_part(share, pos + share->fixed_length);
   *((uchar**) pos)=share->del_link;
   share->del_link=pos;
-  pos[share->reclength]=0;		/* Record deleted */
+  pos[share->visible]=0;		/* Record deleted */
   share->deleted++;
   info->current_hash_ptr=0;
 #if !defined(DBUG_OFF) && defined(EXTRA_HEAP_DEBUG)
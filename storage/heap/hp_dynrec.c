@@ -0,0 +1,329 @@
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+/*
+  Variable-length rows.
+
+  A row is split in two parts. The first share->fixed_length bytes of the
+  record, up to the end of the last key column, are stored as is in
+  share->block so that the indexes can compare rows in place. They are
+  followed by a pointer to the chain of the row and, if the table has
+  blobs, the total length of its blobs:
+
+    [fixed part][uchar *chain][uint32 blob length][uint32 row][visible]
+
+  The columns after the fixed part and all blobs are packed into a chain
+  of HP_VAR_CHUNK_SIZE chunks in share->var_block. Each chunk starts with
+  a pointer to the next chunk of the chain. VARCHAR columns store only
+  their used bytes, BLOB columns store their length and data; other
+  columns are copied as is. A deleted row has no chain, so its link to
+  the next deleted row may overwrite the chain pointer.
+
+  The row number is the index of the position in share->block; it is
+  used as the reference of the row, see heap_row_number().
+
+  When a row is read, the blob data is copied to info->blob_buff and the
+  blob pointers of the record point there, so they are valid until the
+  next row is read through the same handle.
+*/
+
+#include "heapdef.h"
+
+typedef struct st_hp_var_pos
+{
+  uchar **link;                         /* Where the next chunk is linked */
+  uchar *data, *end;                    /* Unused part of current chunk */
+} HP_VAR_POS;
+
+
+static uint32 hp_blob_length(uint packlength, const uchar *pos)
+{
+  switch (packlength) {
+  case 1:
+    return (uint32) *pos;
+  case 2:
+    return (uint32) uint2korr(pos);
+  case 3:
+    return (uint32) uint3korr(pos);
+  case 4:
+    return (uint32) uint4korr(pos);
+  default:
+    DBUG_ASSERT(0);
+    return 0;
+  }
+}
+
+
+/*
+  Get a chunk for a variable-length row
+
+  SYNOPSIS
+    hp_alloc_chunk()
+    share               Table
+    check_size          Fail with HA_ERR_RECORD_FILE_FULL if the table
+                        has reached max_table_size
+
+  NOTES
+    Updates don't check the size: a fixed-length table never fails to
+    update a row, and callers don't expect that an update can fill the
+    table.
+
+  RETURN
+    0     Error; my_errno is set
+    #     Chunk
+*/
+
+static uchar *hp_alloc_chunk(HP_SHARE *share, my_bool check_size)
+{
+  uchar *chunk;
+  ulong block_pos;
+  size_t length;
+
+  if ((chunk= share->var_del_link))
+  {
+    share->var_del_link= *((uchar**) chunk);
+    return chunk;
+  }
+  if (!(block_pos= share->var_chunks % share->var_block.records_in_block))
+  {
+    if (check_size &&
+        share->data_length + share->index_length >= share->max_table_size)
+    {
+      my_errno= HA_ERR_RECORD_FILE_FULL;
+      return 0;
+    }
+    if (hp_get_new_block(&share->var_block, &length))
+    {
+      my_errno= HA_ERR_OUT_OF_MEM;
+      return 0;
+    }
+    share->data_length+= length;
+  }
+  share->var_chunks++;
+  return ((uchar*) share->var_block.level_info[0].last_blocks +
+          block_pos * share->var_block.recbuffer);
+}
+
+
+static my_bool hp_var_write(HP_SHARE *share, HP_VAR_POS *pos,
+                            const uchar *from, size_t length,
+                            my_bool check_size)
+{
+  while (length)
+  {
+    size_t part;
+    if (pos->data == pos->end)
+    {
+      uchar *chunk;
+      if (!(chunk= hp_alloc_chunk(share, check_size)))
+        return 1;
+      *pos->link= chunk;
+      pos->link= (uchar**) chunk;
+      *pos->link= 0;
+      pos->data= chunk + sizeof(uchar*);
+      pos->end= chunk + share->var_block.recbuffer;
+    }
+    part= min(length, (size_t) (pos->end - pos->data));
+    memcpy(pos->data, from, part);
+    pos->data+= part;
+    from+= part;
+    length-= part;
+  }
+  return 0;
+}
+
+
+static void hp_var_read(HP_SHARE *share, HP_VAR_POS *pos, uchar *to,
+                        size_t length)
+{
+  while (length)
+  {
+    size_t part;
+    if (pos->data == pos->end)
+    {
+      uchar *chunk= *pos->link;
+      pos->link= (uchar**) chunk;
+      pos->data= chunk + sizeof(uchar*);
+      pos->end= chunk + share->var_block.recbuffer;
+    }
+    part= min(length, (size_t) (pos->end - pos->data));
+    memcpy(to, pos->data, part);
+    pos->data+= part;
+    to+= part;
+    length-= part;
+  }
+}
+
+
+/*
+  Store the variable-length part of a record in a new chain
+
+  SYNOPSIS
+    hp_write_var_part()
+    share               Table
+    record              Record to store
+    header              Buffer of HP_VAR_HEADER_LENGTH bytes where the
+                        chain and the blob length are stored; the caller
+                        copies it after the fixed part of the row
+    check_size          Fail if the table has reached max_table_size
+
+  RETURN
+    0     OK
+    #     Error number; nothing is allocated
+*/
+
+int hp_write_var_part(HP_SHARE *share, const uchar *record, uchar *header,
+                      my_bool check_size)
+{
+  HP_COLUMNDEF *column, *end;
+  HP_VAR_POS var_pos;
+  uchar *chain= 0;
+  uint32 blob_length= 0;
+  DBUG_ENTER("hp_write_var_part");
+
+  var_pos.link= &chain;
+  var_pos.data= var_pos.end= 0;
+  for (column= share->columndef, end= column + share->columns;
+       column < end; column++)
+  {
+    const uchar *from= record + column->offset;
+    size_t length;
+
+    switch (column->type) {
+    case HP_COLUMN_VARCHAR:
+      length= column->length_bytes + (column->length_bytes == 1 ?
+                                       (uint) *from : uint2korr(from));
+      break;
+    case HP_COLUMN_BLOB:
+      length= hp_blob_length(column->length_bytes, from);
+      if (hp_var_write(share, &var_pos, from, column->length_bytes,
+                       check_size))
+        goto err;
+      memcpy(&from, from + column->length_bytes, sizeof(uchar*));
+      blob_length+= length;
+      break;
+    default:
+      length= column->length;
+      break;
+    }
+    if (hp_var_write(share, &var_pos, from, length, check_size))
+      goto err;
+  }
+  memcpy(header, &chain, sizeof(uchar*));
+  int4store(header + sizeof(uchar*), blob_length);
+  DBUG_RETURN(0);
+
+err:
+  memcpy(header, &chain, sizeof(uchar*));
+  hp_free_var_part(share, header);
+  DBUG_RETURN(my_errno);
+}
+
+
+/*
+  Put the chunks of a row in the list of free chunks
+
+  SYNOPSIS
+    hp_free_var_part()
+    share               Table
+    header              Chain pointer of the row, as stored by
+                        hp_write_var_part()
+*/
+
+void hp_free_var_part(HP_SHARE *share, const uchar *header)
+{
+  uchar *chain;
+  memcpy(&chain, header, sizeof(uchar*));
+  while (chain)
+  {
+    uchar *next= *((uchar**) chain);
+    *((uchar**) chain)= share->var_del_link;
+    share->var_del_link= chain;
+    chain= next;
+  }
+}
+
+
+/*
+  Copy a row to the record buffer
+
+  SYNOPSIS
+    hp_extract_record()
+    info                Handle; its blob buffer holds the blobs of record
+    record              Record buffer
+    pos                 Row
+
+  RETURN
+    0     OK
+    #     Error number
+*/
+
+int hp_extract_record(HP_INFO *info, uchar *record, const uchar *pos)
+{
+  HP_SHARE *share= info->s;
+  HP_COLUMNDEF *column, *end;
+  HP_VAR_POS var_pos;
+  uchar *chain, *blob_pos;
+
+  if (!share->columns)
+  {
+    memcpy(record, pos, (size_t) share->reclength);
+    return 0;
+  }
+  memcpy(record, pos, (size_t) share->fixed_length);
+  if (share->blobs)
+  {
+    uint32 blob_length= uint4korr(pos + share->fixed_length + sizeof(uchar*));
+    if (blob_length > info->blob_buff_length)
+    {
+      uchar *buff;
+      if (!(buff= (uchar*) my_realloc(info->blob_buff, blob_length,
+                                      MYF(MY_ALLOW_ZERO_PTR))))
+        return my_errno= HA_ERR_OUT_OF_MEM;
+      info->blob_buff= buff;
+      info->blob_buff_length= blob_length;
+    }
+  }
+  blob_pos= info->blob_buff;
+
+  memcpy(&chain, pos + share->fixed_length, sizeof(uchar*));
+  var_pos.link= &chain;
+  var_pos.data= var_pos.end= 0;
+  for (column= share->columndef, end= column + share->columns;
+       column < end; column++)
+  {
+    uchar *to= record + column->offset;
+    size_t length;
+
+    switch (column->type) {
+    case HP_COLUMN_VARCHAR:
+      hp_var_read(share, &var_pos, to, column->length_bytes);
+      length= column->length_bytes == 1 ? (uint) *to : uint2korr(to);
+      hp_var_read(share, &var_pos, to + column->length_bytes, length);
+      break;
+    case HP_COLUMN_BLOB:
+      hp_var_read(share, &var_pos, to, column->length_bytes);
+      length= hp_blob_length(column->length_bytes, to);
+      hp_var_read(share, &var_pos, blob_pos, length);
+      memcpy(to + column->length_bytes, &blob_pos, sizeof(uchar*));
+      blob_pos+= length;
+      break;
+    default:
+      hp_var_read(share, &var_pos, to, column->length);
+      break;
+    }
+  }
+  return 0;
+}
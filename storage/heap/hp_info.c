@@ -25,6 +25,35 @@ uchar *heap_position(HP_INFO *info)
 }
 
 
+/*
+  Row number of the current record of a table with variable-length rows
+
+  NOTES
+    Unlike the record pointer of heap_position(), row numbers grow in the
+    order rows are written to new positions. The handler stores them high
+    byte first, so that sorting references gives the order of writing.
+*/
+
+ulong heap_row_number(HP_INFO *info)
+{
+  DBUG_ASSERT(info->s->columns);
+  return ((info->update & HA_STATE_AKTIV) ?
+          (ulong) uint4korr(info->current_ptr + info->s->visible -
+                            HP_ROW_NUMBER_LENGTH) : (ulong) ~0L);
+}
+
+
+/* Record pointer of a row number returned by heap_row_number() */
+
+uchar *heap_row_position(HP_INFO *info, ulong row)
+{
+  HP_SHARE *share= info->s;
+  if (row >= share->records + share->deleted)
+    return 0;
+  return hp_find_block(&share->block, row);
+}
+
+
 #ifdef WANT_OLD_HEAP_VERSION
 
 /*
@@ -59,14 +59,30 @@ int heap_scan(register HP_INFO *info, uchar *record)
     }
     hp_find_record(info, pos);
   }
-  if (!info->current_ptr[share->reclength])
+  if (!info->current_ptr[share->visible])
   {
     DBUG_PRINT("warning",("Found deleted record"));
     info->update= HA_STATE_PREV_FOUND | HA_STATE_NEXT_FOUND;
     DBUG_RETURN(my_errno=HA_ERR_RECORD_DELETED);
   }
   info->update= HA_STATE_PREV_FOUND | HA_STATE_NEXT_FOUND | HA_STATE_AKTIV;
-  memcpy(record,info->current_ptr,(size_t) share->reclength);
+  if (hp_extract_record(info, record, info->current_ptr))
+    DBUG_RETURN(my_errno);
   info->current_hash_ptr=0;			/* Can't use read_next */
   DBUG_RETURN(0);
 } /* heap_scan */
+
+
+/*
+  Continue a scan from a row number returned by heap_row_number() and
+  read that row
+*/
+
+int heap_scan_restart(HP_INFO *info, uchar *record, ulong row)
+{
+  DBUG_ENTER("heap_scan_restart");
+  info->lastinx= -1;
+  info->current_record= row - 1;
+  info->next_block= row - row % info->s->block.records_in_block;
+  DBUG_RETURN(heap_scan(info, record));
+}
@@ -21,6 +21,7 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
 {
   HP_KEYDEF *keydef, *end, *p_lastinx;
   uchar *pos;
+  uchar var_header[HP_VAR_HEADER_LENGTH];
   my_bool auto_key_changed= 0;
   HP_SHARE *share= info->s;
   DBUG_ENTER("heap_update");
@@ -30,6 +31,8 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
 
   if (info->opt_flag & READ_CHECK_USED && hp_rectest(info,old))
     DBUG_RETURN(my_errno);				/* Record changed */
+  if (share->columns && hp_write_var_part(share, heap_new, var_header, 0))
+    DBUG_RETURN(my_errno);
   if (--(share->records) < share->blength >> 1) share->blength>>= 1;
   share->changed=1;
 
@@ -46,7 +49,13 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
     }
   }
 
-  memcpy(pos,heap_new,(size_t) share->reclength);
+  memcpy(pos,heap_new,(size_t) share->fixed_length);
+  if (share->columns)
+  {
+    hp_free_var_part(share, pos + share->fixed_length);
+    memcpy(pos + share->fixed_length, var_header,
+           hp_var_header_length(share));
+  }
   if (++(share->records) == share->blength) share->blength+= share->blength;
 
 #if !defined(DBUG_OFF) && defined(EXTRA_HEAP_DEBUG)
@@ -65,6 +74,8 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
       /* we don't need to delete non-inserted key from rb-tree */
       if ((*keydef->write_key)(info, keydef, old, pos))
       {
+        if (share->columns)
+          hp_free_var_part(share, var_header);
         if (++(share->records) == share->blength)
 	  share->blength+= share->blength;
         DBUG_RETURN(my_errno);
@@ -82,6 +93,8 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
       keydef--;
     }
   }
+  if (share->columns)
+    hp_free_var_part(share, var_header);
   if (++(share->records) == share->blength)
     share->blength+= share->blength;
   DBUG_RETURN(my_errno);
@@ -35,7 +35,8 @@ static HASH_INFO *hp_find_free_hash(HP_SHARE *info, HP_BLOCK *block,
 int heap_write(HP_INFO *info, const uchar *record)
 {
   HP_KEYDEF *keydef, *end;
-  uchar *pos;
+  uchar *pos, *del_link;
+  uchar var_header[HP_VAR_HEADER_LENGTH];
   HP_SHARE *share=info->s;
   DBUG_ENTER("heap_write");
 #ifndef DBUG_OFF
@@ -44,8 +45,18 @@ int heap_write(HP_INFO *info, const uchar *record)
     DBUG_RETURN(my_errno=EACCES);
   }
 #endif
+  if (share->columns && hp_write_var_part(share, record, var_header, 1))
+    DBUG_RETURN(my_errno);
+  del_link= share->del_link;
   if (!(pos=next_free_record_pos(share)))
+  {
+    if (share->columns)
+      hp_free_var_part(share, var_header);
     DBUG_RETURN(my_errno);
+  }
+  /* A new position gets the next row number, see heap_row_number() */
+  if (share->columns && pos != del_link)
+    int4store(pos + share->visible - HP_ROW_NUMBER_LENGTH, share->records);
   share->changed=1;
 
   for (keydef = share->keydef, end = keydef + share->keys; keydef < end;
@@ -55,8 +66,11 @@ int heap_write(HP_INFO *info, const uchar *record)
       goto err;
   }
 
-  memcpy(pos,record,(size_t) share->reclength);
-  pos[share->reclength]=1;		/* Mark record as not deleted */
+  memcpy(pos,record,(size_t) share->fixed_length);
+  if (share->columns)
+    memcpy(pos + share->fixed_length, var_header,
+           hp_var_header_length(share));
+  pos[share->visible]=1;		/* Mark record as not deleted */
   if (++share->records == share->blength)
     share->blength+= share->blength;
   info->current_ptr=pos;
@@ -90,10 +104,12 @@ err:
     keydef--;
   } 
 
+  if (share->columns)
+    hp_free_var_part(share, var_header);
   share->deleted++;
   *((uchar**) pos)=share->del_link;
   share->del_link=pos;
-  pos[share->reclength]=0;			/* Record deleted */
+  pos[share->visible]=0;			/* Record deleted */
 
   DBUG_RETURN(my_errno);
 } /* heap_write */
@@ -1250,6 +1250,10 @@ check_trx_exists(
 		trx->check_unique_secondary = TRUE;
 	}
 
+	/* With --thread-handling=pool-of-threads a connection may be
+	handled by a different thread for each statement. */
+	trx->mysql_thread_id = os_thread_get_curr_id();
+
 	return(trx);
 }
 
@@ -7970,6 +7974,9 @@ static INNOBASE_SHARE* get_share(const char* table_name)
 		}
 
 		thr_lock_init(&share->lock);
+		/* Row locks are done by InnoDB, let normal statements
+		skip the table lock mutex */
+		thr_lock_set_fast_path(&share->lock);
 		pthread_mutex_init(&share->mutex,MY_MUTEX_INIT_FAST);
 	}
 
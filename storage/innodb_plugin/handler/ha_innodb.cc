@@ -201,6 +201,23 @@ static TYPELIB innodb_stats_method_typelib = {
 	NULL
 };
 
+/** Possible values for system variable "innodb_compression_algorithm",
+in the order of PAGE_ZIP_ALGORITHM_ZLIB and PAGE_ZIP_ALGORITHM_LZ4 */
+static const char* innodb_compression_algorithm_names[] = {
+	"zlib",
+	"lz4",
+	NullS
+};
+
+/** Used to define an enumerate type of the system variable
+innodb_compression_algorithm. */
+static TYPELIB innodb_compression_algorithm_typelib = {
+	array_elements(innodb_compression_algorithm_names) - 1,
+	"innodb_compression_algorithm_typelib",
+	innodb_compression_algorithm_names,
+	NULL
+};
+
 /* The following counter is used to convey information to InnoDB
 about server activity: in selects it is not sensible to call
 srv_active_wake_master_thread after each fetch or search, we only do
@@ -745,6 +762,10 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_drop_ibuf_skip_row,         SHOW_LONG},
   {"have_atomic_builtins",
   (char*) &export_vars.innodb_have_atomic_builtins,	  SHOW_BOOL},
+  {"ibuf_contract_batches",
+  (char*) &export_vars.innodb_ibuf_contract_batches,      SHOW_LONG},
+  {"ibuf_discarded_records",
+  (char*) &export_vars.innodb_ibuf_discarded_records,     SHOW_LONG},
   {"ibuf_merged_records",
   (char*) &export_vars.innodb_ibuf_merged_records,        SHOW_LONG},
   {"ibuf_merges",
@@ -899,6 +920,8 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_row_lock_current_waits,	  SHOW_LONG},
   {"row_lock_deadlocks",
   (char*) &export_vars.innodb_lock_deadlocks,             SHOW_LONG},
+  {"row_lock_structs_reused",
+  (char*) &export_vars.innodb_lock_rec_structs_reused,    SHOW_LONG},
   {"row_lock_time",
   (char*) &export_vars.innodb_row_lock_time,		  SHOW_LONGLONG},
   {"row_lock_time_avg",
@@ -955,8 +978,12 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_srv_main_sleep_secs,        SHOW_DOUBLE},
   {"transaction_commit_all",
   (char*) &export_vars.innodb_trx_n_commit_all,           SHOW_LONG},
+  {"transaction_commit_read_only",
+  (char*) &export_vars.innodb_trx_n_commit_read_only,     SHOW_LONG},
   {"transaction_commit_with_undo",
   (char*) &export_vars.innodb_trx_n_commit_with_undo,     SHOW_LONG},
+  {"transaction_read_only_to_read_write",
+  (char*) &export_vars.innodb_trx_n_read_only_to_read_write, SHOW_LONG},
   {"transaction_rollback_partial",
   (char*) &export_vars.innodb_trx_n_rollback_partial,     SHOW_LONG},
   {"transaction_rollback_total",
@@ -1329,6 +1356,21 @@ thd_is_select(
 	return(thd_sql_command((const THD*) thd) == SQLCOM_SELECT);
 }
 
+/******************************************************************//**
+Returns true if the thread is executing a SELECT statement in
+autocommit mode, that is, outside BEGIN ... COMMIT.
+@return	true if thd is executing an autocommit SELECT */
+extern "C" UNIV_INTERN
+ibool
+thd_trx_is_auto_commit(
+/*===================*/
+	const void*	thd)	/*!< in: thread handle (THD*) */
+{
+	return(!thd_test_options((const THD*) thd,
+				 OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN)
+	       && thd_is_select(thd));
+}
+
 /******************************************************************//**
 Returns true if the thread supports XA,
 global value of innodb_supports_xa if thd is NULL.
@@ -2102,6 +2144,10 @@ innobase_trx_init(
 
 	trx->fake_changes = THDVAR(thd, fake_changes);
 
+	/* With --thread-handling=pool-of-threads a connection may be
+	handled by a different thread for each statement. */
+	trx->mysql_thread_id = os_thread_get_curr_id();
+
 	/* The replication thread ignores innodb_thread_concurrency. */
 	if (thd_is_replication_slave_thread(thd))
 		trx->always_enter_innodb = TRUE;
@@ -3032,6 +3078,8 @@ innobase_change_buffering_inited_ok:
 	ut_a(DATA_MYSQL_LATIN1_SWEDISH_CHARSET_COLL ==
 					my_charset_latin1.number);
 	ut_a(DATA_MYSQL_BINARY_CHARSET_COLL == my_charset_bin.number);
+	ut_a(DATA_MYSQL_LATIN1_BIN_CHARSET_COLL
+	     == my_charset_latin1_bin.number);
 
 	/* Store the latin1_swedish_ci character ordering table to InnoDB. For
 	non-latin1_swedish_ci charsets we use the MySQL comparison functions,
@@ -10503,6 +10551,9 @@ static INNOBASE_SHARE* get_share(const char* table_name)
 			    innobase_open_tables, fold, share);
 
 		thr_lock_init(&share->lock);
+		/* Row locks are done by InnoDB, let normal statements
+		skip the table lock mutex */
+		thr_lock_set_fast_path(&share->lock);
 
 		/* Index translation table initialization */
 		share->idx_trans_tbl.index_mapping = NULL;
@@ -12807,6 +12858,16 @@ static MYSQL_SYSVAR_UINT(compression_level, page_compression_level,
   " (only for testing), 1 is fastest, 9 is best compression, default is 6.",
   NULL, NULL, 6, 0, 9, 0);
 
+static MYSQL_SYSVAR_ENUM(compression_algorithm, page_zip_compression_algorithm,
+  PLUGIN_VAR_RQCMDARG,
+  "Compression algorithm used for pages of compressed tables. Possible values "
+  "are ZLIB (default), which honors innodb_compression_level, "
+  "innodb_zlib_wrap and innodb_zlib_strategy, and LZ4, which compresses "
+  "less but decompresses several times faster. Every page records the "
+  "algorithm it was compressed with, so changing this only affects pages "
+  "compressed afterwards.",
+  NULL, NULL, PAGE_ZIP_ALGORITHM_ZLIB, &innodb_compression_algorithm_typelib);
+
 static MYSQL_SYSVAR_BOOL(zlib_wrap, page_zip_zlib_wrap,
   PLUGIN_VAR_OPCMDARG,
   "When this parameter is OFF, innodb tells zlib to not compute adler32 values "
@@ -13108,6 +13169,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(background_thread_interval_usecs),
   MYSQL_SYSVAR(adaptive_hash_latch_cache),
   MYSQL_SYSVAR(compression_level),
+  MYSQL_SYSVAR(compression_algorithm),
   MYSQL_SYSVAR(prepare_commit_mutex),
   MYSQL_SYSVAR(expand_import),
   MYSQL_SYSVAR(merge_sort_block_size),
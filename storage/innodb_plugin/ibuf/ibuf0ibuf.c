@@ -248,6 +248,14 @@ page are merged along with the page whose buffer became full */
 batch, in order to merge the entries for them in the insert buffer */
 #define	IBUF_MAX_N_PAGES_MERGED		IBUF_MERGE_AREA
 
+/** Maximum number of merge areas which ibuf_contract_for_n_pages samples
+for a single read batch */
+#define IBUF_MERGE_N_SAMPLES		4
+
+/** Maximum number of pages in a single ibuf contraction read batch */
+#define IBUF_MAX_N_PAGES_BATCHED	(IBUF_MERGE_N_SAMPLES	\
+					 * IBUF_MAX_N_PAGES_MERGED)
+
 /** If the combined size of the ibuf trees exceeds ibuf->max_size by this
 many pages, we start to contract it in connection to inserts there, using
 non-synchronous contract */
@@ -2156,28 +2164,27 @@ ibuf_get_merge_page_nos(
 }
 
 /*********************************************************************//**
-Contracts insert buffer trees by reading pages to the buffer pool.
-@return a lower limit for the combined size in bytes of entries which
-will be merged from ibuf trees to the pages read, 0 if ibuf is
-empty */
+Reads page numbers for an ibuf merge from a randomly chosen position in
+the ibuf tree.
+@return a lower limit for the combined volume of records which will be
+merged, plus one; 0 if ibuf is empty */
 static
 ulint
-ibuf_contract_ext(
-/*==============*/
-	ulint*	n_pages,/*!< out: number of pages to which merged */
-	ibool	sync)	/*!< in: TRUE if the caller wants to wait for the
-			issued read with the highest tablespace address
-			to complete */
+ibuf_get_merge_page_nos_at_rnd_pos(
+/*===============================*/
+	ulint*		space_ids,/*!< out: space id's of the pages */
+	ib_int64_t*	space_versions,/*!< out: tablespace version
+				timestamps */
+	ulint*		page_nos,/*!< out: buffer for at least
+				IBUF_MAX_N_PAGES_MERGED many page numbers;
+				the page numbers are in an ascending order */
+	ulint*		n_stored)/*!< out: number of page numbers stored */
 {
 	btr_pcur_t	pcur;
-	ulint		page_nos[IBUF_MAX_N_PAGES_MERGED];
-	ulint		space_ids[IBUF_MAX_N_PAGES_MERGED];
-	ib_int64_t	space_versions[IBUF_MAX_N_PAGES_MERGED];
-	ulint		n_stored;
 	ulint		sum_sizes;
 	mtr_t		mtr;
 
-	*n_pages = 0;
+	*n_stored = 0;
 	ut_ad(!ibuf_inside());
 
 	mutex_enter(&ibuf_mutex);
@@ -2219,23 +2226,170 @@ ibuf_is_empty:
 
 	sum_sizes = ibuf_get_merge_page_nos(TRUE, btr_pcur_get_rec(&pcur),
 					    space_ids, space_versions,
-					    page_nos, &n_stored);
+					    page_nos, n_stored);
 #if 0 /* defined UNIV_IBUF_DEBUG */
-	fprintf(stderr, "Ibuf contract sync %lu pages %lu volume %lu\n",
-		sync, n_stored, sum_sizes);
+	fprintf(stderr, "Ibuf contract %lu pages %lu volume\n",
+		*n_stored, sum_sizes);
 #endif
 	ibuf_exit();
 
 	mtr_commit(&mtr);
 	btr_pcur_close(&pcur);
 
-	buf_read_ibuf_merge_pages(sync, space_ids, space_versions, page_nos,
-				  n_stored);
-	*n_pages = n_stored;
-
 	return(sum_sizes + 1);
 }
 
+/*********************************************************************//**
+Contracts insert buffer trees by reading pages to the buffer pool.
+Up to n_samples merge areas are picked at random positions of the ibuf
+tree.  The areas whose buffered volume per page is the largest, and
+which thus merge the most entries per read, are served first, and the
+pages of all chosen areas are read in one batch in ascending (space id,
+page number) order, so that the reads can be merged by the i/o layer.
+@return a lower limit for the combined size in bytes of entries which
+will be merged from ibuf trees to the pages read, 0 if ibuf is
+empty */
+static
+ulint
+ibuf_contract_ext(
+/*==============*/
+	ulint*	n_pages,/*!< out: number of pages to which merged */
+	ibool	sync,	/*!< in: TRUE if the caller wants to wait for the
+			issued read with the highest tablespace address
+			to complete */
+	ulint	n_samples,/*!< in: number of merge areas to sample,
+			1 to IBUF_MERGE_N_SAMPLES */
+	ulint	n_wanted)/*!< in: stop adding sampled areas to the batch
+			once this many pages have been chosen */
+{
+	ulint		page_nos[IBUF_MERGE_N_SAMPLES]
+				[IBUF_MAX_N_PAGES_MERGED];
+	ulint		space_ids[IBUF_MERGE_N_SAMPLES]
+				[IBUF_MAX_N_PAGES_MERGED];
+	ib_int64_t	space_versions[IBUF_MERGE_N_SAMPLES]
+				[IBUF_MAX_N_PAGES_MERGED];
+	ulint		n_stored[IBUF_MERGE_N_SAMPLES];
+	ulint		sum_sizes[IBUF_MERGE_N_SAMPLES];
+	ulint		order[IBUF_MERGE_N_SAMPLES];
+	ulint		batch_page_nos[IBUF_MAX_N_PAGES_BATCHED];
+	ulint		batch_space_ids[IBUF_MAX_N_PAGES_BATCHED];
+	ib_int64_t	batch_space_versions[IBUF_MAX_N_PAGES_BATCHED];
+	ulint		n_batched;
+	ulint		n_sampled;
+	ulint		sum_bytes;
+	ulint		i;
+	ulint		j;
+
+	ut_ad(n_samples >= 1);
+	ut_ad(n_samples <= IBUF_MERGE_N_SAMPLES);
+
+	*n_pages = 0;
+
+	for (n_sampled = 0; n_sampled < n_samples; n_sampled++) {
+		ulint	sample_size;
+
+		sample_size = ibuf_get_merge_page_nos_at_rnd_pos(
+			space_ids[n_sampled], space_versions[n_sampled],
+			page_nos[n_sampled], &n_stored[n_sampled]);
+
+		if (sample_size == 0) {
+
+			break;
+		}
+
+		sum_sizes[n_sampled] = sample_size;
+
+		/* Insertion sort the samples by descending volume per
+		page; ties keep the sampling order. */
+
+		for (i = n_sampled; i > 0; i--) {
+			ulint	k = order[i - 1];
+
+			if (sum_sizes[k] * ut_max(n_stored[n_sampled], 1)
+			    >= sample_size * ut_max(n_stored[k], 1)) {
+
+				break;
+			}
+
+			order[i] = k;
+		}
+
+		order[i] = n_sampled;
+	}
+
+	if (n_sampled == 0) {
+
+		return(0);
+	}
+
+	/* Collect the pages of the most profitable samples into one
+	batch, sorted by (space id, page number) and without duplicates:
+	two random positions may well land in the same merge area. */
+
+	n_batched = 0;
+	sum_bytes = 0;
+
+	for (i = 0; i < n_sampled; i++) {
+		ulint	k = order[i];
+		ulint	l;
+
+		if (i > 0 && n_batched >= n_wanted) {
+
+			break;
+		}
+
+		sum_bytes += sum_sizes[k];
+
+		for (l = 0; l < n_stored[k]; l++) {
+			ulint	space	= space_ids[k][l];
+			ulint	page_no	= page_nos[k][l];
+
+			for (j = n_batched; j > 0; j--) {
+				if (batch_space_ids[j - 1] < space
+				    || (batch_space_ids[j - 1] == space
+					&& batch_page_nos[j - 1]
+					<= page_no)) {
+
+					break;
+				}
+			}
+
+			if (j > 0 && batch_space_ids[j - 1] == space
+			    && batch_page_nos[j - 1] == page_no) {
+
+				continue;
+			}
+
+			ut_a(n_batched < IBUF_MAX_N_PAGES_BATCHED);
+
+			memmove(batch_space_ids + j + 1, batch_space_ids + j,
+				(n_batched - j) * sizeof *batch_space_ids);
+			memmove(batch_page_nos + j + 1, batch_page_nos + j,
+				(n_batched - j) * sizeof *batch_page_nos);
+			memmove(batch_space_versions + j + 1,
+				batch_space_versions + j,
+				(n_batched - j)
+				* sizeof *batch_space_versions);
+
+			batch_space_ids[j] = space;
+			batch_page_nos[j] = page_no;
+			batch_space_versions[j] = space_versions[k][l];
+
+			n_batched++;
+		}
+	}
+
+	buf_read_ibuf_merge_pages(sync, batch_space_ids, batch_space_versions,
+				  batch_page_nos, n_batched);
+	*n_pages = n_batched;
+
+	mutex_enter(&ibuf_mutex);
+	ibuf->n_contract_batches++;
+	mutex_exit(&ibuf_mutex);
+
+	return(sum_bytes);
+}
+
 /*********************************************************************//**
 Contracts insert buffer trees by reading pages to the buffer pool.
 @return a lower limit for the combined size in bytes of entries which
@@ -2251,7 +2405,7 @@ ibuf_contract(
 {
 	ulint	n_pages;
 
-	return(ibuf_contract_ext(&n_pages, sync));
+	return(ibuf_contract_ext(&n_pages, sync, 1, 0));
 }
 
 /*********************************************************************//**
@@ -2279,7 +2433,15 @@ ibuf_contract_for_n_pages(
 		return 0;
 
 	while (sum_pages < n_pages) {
-		n_bytes = ibuf_contract_ext(&n_pag2, sync);
+		ulint	n_left		= n_pages - sum_pages;
+		ulint	n_samples;
+
+		/* Sample one merge area more than strictly needed, so
+		that the least profitable one can be left out. */
+		n_samples = ut_min(IBUF_MERGE_N_SAMPLES,
+				   n_left / IBUF_MAX_N_PAGES_MERGED + 2);
+
+		n_bytes = ibuf_contract_ext(&n_pag2, sync, n_samples, n_left);
 
 		if (n_bytes == 0) {
 			return(sum_bytes);
@@ -3280,6 +3442,7 @@ ibuf_merge_or_delete_for_page(
 	btr_pcur_t	pcur;
 	dtuple_t*	search_tuple;
 	ulint		n_inserts;
+	ulint		n_discarded;
 #ifdef UNIV_IBUF_DEBUG
 	ulint		volume;
 #endif
@@ -3432,6 +3595,7 @@ ibuf_merge_or_delete_for_page(
 	}
 
 	n_inserts = 0;
+	n_discarded = 0;
 #ifdef UNIV_IBUF_DEBUG
 	volume = 0;
 #endif
@@ -3491,6 +3655,7 @@ loop:
 			fputs("InnoDB: Discarding record\n ", stderr);
 			rec_print_old(stderr, rec);
 			fputs("\nInnoDB: from the insert buffer!\n\n", stderr);
+			n_discarded++;
 		} else if (block) {
 			/* Now we have at pcur a record which should be
 			inserted to the index page; NOTE that the call below
@@ -3516,9 +3681,11 @@ loop:
 			ibuf_insert_to_index_page(entry, block,
 						  dummy_index, &mtr);
 			ibuf_dummy_index_free(dummy_index);
-		}
 
-		n_inserts++;
+			n_inserts++;
+		} else {
+			n_discarded++;
+		}
 
 		/* Delete the record from ibuf */
 		if (ibuf_delete_rec(space, page_no, &pcur, search_tuple,
@@ -3577,6 +3744,7 @@ reset_bit:
 
 	ibuf->n_merges++;
 	ibuf->n_merged_recs += n_inserts;
+	ibuf->n_discarded_recs += n_discarded;
 
 	mutex_exit(&ibuf_mutex);
 
@@ -3682,7 +3850,7 @@ leave_loop:
 	mutex_enter(&ibuf_mutex);
 
 	ibuf->n_merges++;
-	ibuf->n_merged_recs += n_inserts;
+	ibuf->n_discarded_recs += n_inserts;
 
 	mutex_exit(&ibuf_mutex);
 
@@ -3755,13 +3923,16 @@ ibuf_print(
 
 	fprintf(file,
 		"Ibuf: size %lu, free list len %lu, seg size %lu,\n"
-		"%lu inserts, %lu merged recs, %lu merges\n",
+		"%lu inserts, %lu merged recs, %lu merges\n"
+		"%lu discarded recs, %lu contract batches\n",
 		(ulong) ibuf->size,
 		(ulong) ibuf->free_list_len,
 		(ulong) ibuf->seg_size,
 		(ulong) ibuf->n_inserts,
 		(ulong) ibuf->n_merged_recs,
-		(ulong) ibuf->n_merges);
+		(ulong) ibuf->n_merges,
+		(ulong) ibuf->n_discarded_recs,
+		(ulong) ibuf->n_contract_batches);
 #ifdef UNIV_IBUF_COUNT_DEBUG
 	for (i = 0; i < IBUF_COUNT_N_SPACES; i++) {
 		for (j = 0; j < IBUF_COUNT_N_PAGES; j++) {
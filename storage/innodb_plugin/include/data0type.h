@@ -31,6 +31,7 @@ Created 1/16/1996 Heikki Tuuri
 extern ulint	data_mysql_default_charset_coll;
 #define DATA_MYSQL_LATIN1_SWEDISH_CHARSET_COLL 8
 #define DATA_MYSQL_BINARY_CHARSET_COLL 63
+#define DATA_MYSQL_LATIN1_BIN_CHARSET_COLL 47
 
 /* SQL data type struct */
 typedef struct dtype_struct		dtype_t;
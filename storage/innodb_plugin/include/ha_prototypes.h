@@ -182,6 +182,16 @@ thd_is_select(
 /*==========*/
 	const void*	thd);	/*!< in: thread handle (THD*) */
 
+/******************************************************************//**
+Returns true if the thread is executing a SELECT statement in
+autocommit mode, that is, outside BEGIN ... COMMIT.
+@return	true if thd is executing an autocommit SELECT */
+
+ibool
+thd_trx_is_auto_commit(
+/*===================*/
+	const void*	thd);	/*!< in: thread handle (THD*) */
+
 /******************************************************************//**
 Converts an identifier to a table name. */
 UNIV_INTERN
@@ -57,6 +57,14 @@ struct ibuf_struct{
 					the insert buffer */
 	ulint		n_merges;	/*!< number of pages merged */
 	ulint		n_merged_recs;	/*!< number of records merged */
+	ulint		n_discarded_recs;/*!< number of records removed
+					from the insert buffer without
+					being merged, because the page
+					was freed, its tablespace was
+					dropped or it was corrupt */
+	ulint		n_contract_batches;/*!< number of sorted read
+					batches issued by the insert
+					buffer contraction */
 };
 
 /** Combinations of operations that can be buffered.  Because the enum
@@ -48,6 +48,13 @@ extern mem_block_cache_t* malloc_cache_compress;
 extern mem_block_cache_t* malloc_cache_decompress;
 extern my_bool page_zip_zlib_wrap;
 extern uint page_zip_zlib_strategy;
+
+/** Compression algorithms for compressed pages */
+#define PAGE_ZIP_ALGORITHM_ZLIB	0	/*!< zlib deflate */
+#define PAGE_ZIP_ALGORITHM_LZ4	1	/*!< LZ4 block codec, see ut0lz4.h */
+
+/** Compression algorithm used for compressing pages, PAGE_ZIP_ALGORITHM_ */
+extern ulong page_zip_compression_algorithm;
 UNIV_INTERN
 void
 page_zip_init(void);
@@ -539,9 +546,13 @@ page_zip_compress_write_log_no_data(
 	dict_index_t*	index,
 	mtr_t*		mtr);
 
+/** Value of the compression level bits of the compression flags that
+selects the LZ4 codec.  zlib levels only go up to 9. */
+#define PAGE_ZIP_FLAGS_LZ4	0xf
+
 /**********************************************************************//**
-Read the compression level and other compression options from the compression
-flag. */
+Read the compression algorithm, the compression level and other compression
+options from the compression flag. */
 UNIV_INLINE
 void
 page_zip_decode_compression_flags(
@@ -549,24 +560,27 @@ page_zip_decode_compression_flags(
 	uchar	flags,
 	uint*	level,
 	uint*	no_wrap,
-	uint*	strategy);
+	uint*	strategy,
+	uint*	algorithm);
 
 /**********************************************************************//**
-Write the compression level and other compression options into the compression
-flag and return it. */
+Write the compression algorithm, the compression level and other compression
+options into the compression flag and return it. */
 UNIV_INLINE
 uchar
 page_zip_encode_compression_flags(
 /*=============================*/
 	uint	level,
 	uint	no_wrap,
-	uint	strategy);
+	uint	strategy,
+	uint	algorithm);
 
 #define page_zip_compression_flags \
 	page_zip_encode_compression_flags( \
 	  page_compression_level, \
 	  page_zip_zlib_wrap, \
-	  page_zip_zlib_strategy)
+	  page_zip_zlib_strategy, \
+	  page_zip_compression_algorithm)
 
 /**********************************************************************//**
 This function determines the sign for window_bits and reads the zlib header
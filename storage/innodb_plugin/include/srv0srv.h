@@ -358,6 +358,9 @@ extern ulint	srv_lock_deadlocks;
 /** Number of lock wait timeouts */
 extern ulint	srv_lock_wait_timeouts;
 
+/** Number of record lock structs reused from a transaction's free list */
+extern ulint	srv_lock_rec_structs_reused;
+
 /** Number times purge skipped a row because the table had been dropped */
 extern ulint  srv_drop_purge_skip_row;
 	
@@ -505,6 +508,13 @@ extern ulint srv_n_commit_all;
 /** Number of commits for which undo was generated */
 extern ulint srv_n_commit_with_undo;
 
+/** Number of commits of transactions that were started read-only */
+extern ulint srv_n_commit_read_only;
+
+/** Number of transactions that were started read-only and then
+had to be made read-write */
+extern ulint srv_n_read_only_to_read_write;
+
 /** Number of full rollbacks */
 extern ulint srv_n_rollback_total;
 
@@ -947,9 +957,12 @@ struct export_var_struct{
 	ulint innodb_ibuf_inserts;		/*!< ibuf->n_inserts */
 	ulint innodb_ibuf_merged_records;	/*!< ibuf->n_merged_recs */
 	ulint innodb_ibuf_merges;		/*!< ibuf->n_merges */
+	ulint innodb_ibuf_discarded_records;	/*!< ibuf->n_discarded_recs */
+	ulint innodb_ibuf_contract_batches;	/*!< ibuf->n_contract_batches */
 	ulint innodb_ibuf_size;			/*!< ibuf->size */
 	ulint innodb_lock_deadlocks;		/*!< srv_lock_deadlocks */
 	ulint innodb_lock_wait_timeouts;	/*!< srv_lock_wait_timeouts */
+	ulint innodb_lock_rec_structs_reused;	/*!< srv_lock_rec_structs_reused */
 	ulint innodb_log_checkpoints;
 	ulint innodb_log_syncs;
 	ulint innodb_log_waits;			/*!< srv_log_waits */
@@ -1049,6 +1062,9 @@ struct export_var_struct{
 	ulint innodb_trx_doublewrite_page_no;	/*!< trx_doublewrite->block1 */
 	ulint innodb_trx_n_commit_all; /*!< srv_n_commit_with_undo */
 	ulint innodb_trx_n_commit_with_undo; /*!< srv_n_commit_with_undo */
+	ulint innodb_trx_n_commit_read_only; /*!< srv_n_commit_read_only */
+	ulint innodb_trx_n_read_only_to_read_write;
+					/*!< srv_n_read_only_to_read_write */
 	ulint innodb_trx_n_rollback_partial; /*!< srv_n_rollback_partial */
 	ulint innodb_trx_n_rollback_total; /*!< srv_n_rollback_total */
 
@@ -703,6 +703,10 @@ struct trx_sys_struct{
 	trx_id_t	max_trx_id;	/*!< The smallest number not yet
 					assigned as a transaction id or
 					transaction number */
+	trx_id_t	query_cache_inv_trx_id;
+					/*!< the value of max_trx_id when
+					a transaction last invalidated
+					dict_table_t::query_cache_inv_trx_id */
 	UT_LIST_BASE_NODE_T(trx_t) trx_list;
 					/*!< List of active and committed in
 					memory transactions, sorted on trx id,
@@ -172,14 +172,40 @@ trx_start_low(
 	ulint	rseg_id);/*!< in: rollback segment id; if ULINT_UNDEFINED
 			is passed, the system chooses the rollback segment
 			automatically in a round-robin fashion */
+/****************************************************************//**
+Starts a transaction for a consistent read. An autocommit SELECT that
+does not lock any table cannot write, and it is started read-only:
+without a trx id, without a rollback segment and without the kernel
+mutex. */
+UNIV_INTERN
+void
+trx_start_for_read(
+/*===============*/
+	trx_t*	trx);	/*!< in: transaction */
+/****************************************************************//**
+Turns a transaction that was started read-only into a normal one, so
+that it can lock and modify records. */
+UNIV_INTERN
+void
+trx_set_read_write(
+/*===============*/
+	trx_t*	trx);	/*!< in: transaction */
 /*************************************************************//**
-Starts the transaction if it is not yet started. */
+Starts the transaction if it is not yet started. A transaction that
+was started read-only is made read-write. */
 UNIV_INLINE
 void
 trx_start_if_not_started(
 /*=====================*/
 	trx_t*	trx);	/*!< in: transaction */
 /*************************************************************//**
+Starts the transaction for a consistent read if it is not yet started. */
+UNIV_INLINE
+void
+trx_start_for_read_if_not_started(
+/*==============================*/
+	trx_t*	trx);	/*!< in: transaction */
+/*************************************************************//**
 Starts the transaction if it is not yet started. Assumes we have reserved
 the kernel mutex! */
 UNIV_INLINE
@@ -196,6 +222,16 @@ trx_commit_off_kernel(
 	trx_t*	trx,		/*!< in: transaction */
 	ibool	for_commit);	/*!< in: for rollback when FALSE */
 /****************************************************************//**
+Commits or rolls back a transaction that was started read-only. It has
+no locks and no undo logs: only closing its read view needs the kernel
+mutex. */
+UNIV_INTERN
+void
+trx_commit_read_only(
+/*=================*/
+	trx_t*	trx,		/*!< in: transaction */
+	ibool	for_commit);	/*!< in: for rollback when FALSE */
+/****************************************************************//**
 Cleans up a transaction at database startup. The cleanup is needed if
 the transaction already got to the middle of a commit when the database
 crashed, and we cannot roll it back. */
@@ -527,6 +563,10 @@ struct trx_struct{
 					150 bytes in the undo log size as then
 					we skip XA steps */
 	ulint		fake_changes;
+	ulint		read_only;	/*!< TRUE if the transaction was
+					started by trx_start_for_read(): it
+					has no trx id and no rollback segment,
+					and it is not in trx_sys->trx_list */
 	ulint		flush_log_later;/* In 2PC, we hold the
 					prepare_commit mutex across
 					both phases. In that case, we
@@ -689,6 +729,12 @@ struct trx_struct{
 					transaction */
 	UT_LIST_BASE_NODE_T(lock_t)
 			trx_locks;	/*!< locks reserved by the transaction */
+	UT_LIST_BASE_NODE_T(lock_t)
+			rec_lock_free_list;
+					/*!< record lock structs allocated
+					from lock_heap that were discarded
+					and can be reused; protected by
+					kernel_mutex */
 	/*------------------------------*/
 	mem_heap_t*	global_read_view_heap;
 					/* memory heap for the global read
@@ -0,0 +1,76 @@
+/*****************************************************************************
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+*****************************************************************************/
+
+/*******************************************************************//**
+@file include/ut0lz4.h
+A fast LZ77 block codec producing the LZ4 block format
+
+The compressor is a greedy single-pass matcher with a small hash table
+of 4-byte sequences; the decompressor validates every length and offset,
+so that it can be applied to corrupted input.  Both work on a single
+block of at most UT_LZ4_MAX_INPUT_SIZE bytes, which is all that a
+compressed page needs.
+************************************************************************/
+
+#ifndef ut0lz4_h
+#define ut0lz4_h
+
+#include "univ.i"
+
+/** Maximum size of the input of ut_lz4_compress() */
+#define UT_LZ4_MAX_INPUT_SIZE	65535
+
+/** Number of bits in the hash of a 4-byte sequence */
+#define UT_LZ4_HASH_BITS	12
+
+/** Number of hash table entries used by ut_lz4_compress() */
+#define UT_LZ4_HASH_SIZE	(1 << UT_LZ4_HASH_BITS)
+
+/** Size of the work area of ut_lz4_compress(), in bytes */
+#define UT_LZ4_WORK_SIZE	(UT_LZ4_HASH_SIZE * sizeof(ib_uint32_t))
+
+/** Upper bound for the compressed size of len bytes */
+#define UT_LZ4_COMPRESS_BOUND(len)	((len) + (len) / 255 + 16)
+
+/**********************************************************************//**
+Compresses a block of data.
+@return	length of the compressed data, or 0 if it does not fit in dst_len */
+UNIV_INTERN
+ulint
+ut_lz4_compress(
+/*============*/
+	const byte*	src,	/*!< in: data to compress */
+	ulint		src_len,/*!< in: length of src, at most
+				UT_LZ4_MAX_INPUT_SIZE */
+	byte*		dst,	/*!< out: compressed data */
+	ulint		dst_len,/*!< in: size of dst */
+	void*		work);	/*!< in/out: work area of
+				UT_LZ4_WORK_SIZE bytes */
+
+/**********************************************************************//**
+Decompresses a block of data that was compressed by ut_lz4_compress().
+@return	length of the decompressed data, or ULINT_UNDEFINED if the
+input is corrupted or does not fit in dst_len */
+UNIV_INTERN
+ulint
+ut_lz4_decompress(
+/*==============*/
+	const byte*	src,	/*!< in: compressed data */
+	ulint		src_len,/*!< in: length of src */
+	byte*		dst,	/*!< out: decompressed data */
+	ulint		dst_len);/*!< in: size of dst */
+
+#endif /* ut0lz4_h */
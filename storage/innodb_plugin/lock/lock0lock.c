@@ -58,6 +58,12 @@ bitmap */
 
 #define LOCK_PAGE_BITMAP_MARGIN		64
 
+/* When creating a new record lock, at most this many discarded record lock
+structs of the transaction are examined for one whose bitmap is big enough
+to be reused */
+
+#define LOCK_REC_FREE_LIST_MAX_SCAN	8
+
 /* An explicit record lock affects both the record and the gap before it.
 An implicit x-lock does not affect the gap, it only locks the index
 record from read or update.
@@ -1659,6 +1665,40 @@ lock_number_of_rows_locked(
 
 /*============== RECORD LOCK CREATION AND QUEUE MANAGEMENT =============*/
 
+/*********************************************************************//**
+Takes a discarded record lock struct of the transaction for reuse. The
+structs are allocated from trx->lock_heap, which is only emptied when the
+transaction releases its locks, so without reuse every lock discarded on
+page merges and reorganizations would stay allocated until commit.
+@return	lock struct whose bitmap has at least n_bytes bytes, or NULL */
+static
+lock_t*
+lock_rec_free_list_get(
+/*===================*/
+	trx_t*	trx,	/*!< in: transaction */
+	ulint	n_bytes)/*!< in: minimum bitmap size in bytes */
+{
+	lock_t*	lock;
+	ulint	n_scanned = 0;
+
+	ut_ad(mutex_own(&kernel_mutex));
+
+	for (lock = UT_LIST_GET_FIRST(trx->rec_lock_free_list);
+	     lock != NULL && n_scanned < LOCK_REC_FREE_LIST_MAX_SCAN;
+	     lock = UT_LIST_GET_NEXT(trx_locks, lock), n_scanned++) {
+
+		if (lock_rec_get_n_bits(lock) / 8 >= n_bytes) {
+			UT_LIST_REMOVE(trx_locks, trx->rec_lock_free_list,
+				       lock);
+			srv_lock_rec_structs_reused++;
+
+			return(lock);
+		}
+	}
+
+	return(NULL);
+}
+
 /*********************************************************************//**
 Creates a new record lock and inserts it to the lock queue. Does NOT check
 for deadlocks or lock compatibility!
@@ -1705,7 +1745,15 @@ lock_rec_create(
 	n_bits = page_dir_get_n_heap(page) + LOCK_PAGE_BITMAP_MARGIN;
 	n_bytes = 1 + n_bits / 8;
 
-	lock = mem_heap_alloc(trx->lock_heap, sizeof(lock_t) + n_bytes);
+	lock = lock_rec_free_list_get(trx, n_bytes);
+
+	if (lock != NULL) {
+		/* Keep the full capacity of the reused bitmap */
+		n_bytes = lock_rec_get_n_bits(lock) / 8;
+	} else {
+		lock = mem_heap_alloc(trx->lock_heap,
+				      sizeof(lock_t) + n_bytes);
+	}
 
 	UT_LIST_ADD_LAST(trx_locks, trx->trx_locks, lock);
 
@@ -2314,6 +2362,11 @@ lock_rec_discard(
 		    lock_rec_fold(space, page_no), in_lock);
 
 	UT_LIST_REMOVE(trx_locks, trx->trx_locks, in_lock);
+
+	/* The memory of the lock struct can be reused by the next record
+	lock that the transaction creates. */
+
+	UT_LIST_ADD_FIRST(trx_locks, trx->rec_lock_free_list, in_lock);
 }
 
 /*************************************************************//**
@@ -2350,6 +2403,36 @@ lock_rec_free_all_from_discard_page(
 	}
 }
 
+/*************************************************************//**
+Removes the record lock objects on a page which do not lock any record
+any more and are not waiting. Such objects are left behind when the locks
+are moved to lock objects with bigger bitmaps. */
+static
+void
+lock_rec_free_empty_on_page(
+/*========================*/
+	const buf_block_t*	block)	/*!< in: buffer block */
+{
+	lock_t*	lock;
+	lock_t*	next_lock;
+
+	ut_ad(mutex_own(&kernel_mutex));
+
+	lock = lock_rec_get_first_on_page(block);
+
+	while (lock != NULL) {
+		next_lock = lock_rec_get_next_on_page(lock);
+
+		if (!lock_get_wait(lock)
+		    && lock_rec_find_set_bit(lock) == ULINT_UNDEFINED) {
+
+			lock_rec_discard(lock);
+		}
+
+		lock = next_lock;
+	}
+}
+
 /*============= RECORD LOCK MOVING AND INHERITING ===================*/
 
 /*************************************************************//**
@@ -2650,6 +2733,11 @@ lock_move_reorganize_page(
 #endif /* UNIV_DEBUG */
 	}
 
+	/* A lock whose bitmap was too small for a new heap number, or
+	which was waiting, had its bits moved to a new lock object */
+
+	lock_rec_free_empty_on_page(block);
+
 	lock_mutex_exit_kernel();
 
 	mem_heap_free(heap);
@@ -4118,6 +4206,8 @@ lock_release_off_kernel(
 
 				table->query_cache_inv_trx_id
 					= trx_sys->max_trx_id;
+				trx_sys->query_cache_inv_trx_id
+					= trx_sys->max_trx_id;
 			}
 
 			lock_table_dequeue(lock);
@@ -4140,6 +4230,8 @@ lock_release_off_kernel(
 	ut_a(ib_vector_size(trx->autoinc_locks) == 0);
 
 	mem_heap_empty(trx->lock_heap);
+
+	UT_LIST_INIT(trx->rec_lock_free_list);
 }
 
 /*********************************************************************//**
@@ -4516,8 +4608,9 @@ lock_print_info_summary(
 		srv_lock_deadlocks, srv_lock_wait_timeouts);
 
 	fprintf(file,
-		"Commits: %lu all, %lu with undo\n",
-		srv_n_commit_all, srv_n_commit_with_undo);
+		"Commits: %lu all, %lu with undo, %lu read only\n",
+		srv_n_commit_all, srv_n_commit_with_undo,
+		srv_n_commit_read_only);
 
 	fprintf(file,
 		"Rollback: %lu total, %lu partial\n",
@@ -4559,7 +4652,7 @@ lock_print_info_all_transactions(
 	trx = UT_LIST_GET_FIRST(trx_sys->mysql_trx_list);
 
 	while (trx) {
-		if (trx->conc_state == TRX_NOT_STARTED) {
+		if (trx->conc_state == TRX_NOT_STARTED || trx->read_only) {
 			fputs("---", file);
 			trx_print(file, trx, 600);
 		}
@@ -49,6 +49,7 @@ Created June 2005 by Marko Makela
 #endif /* !UNIV_HOTBACKUP */
 
 #include "blind_fwrite.h"
+#include "ut0lz4.h"
 
 #ifndef UNIV_HOTBACKUP
 /** Statistics on compression, indexed by page_zip_des_t::ssize - 1 */
@@ -56,6 +57,8 @@ UNIV_INTERN page_zip_stat_t page_zip_stat[PAGE_ZIP_NUM_SSIZE - 1];
 #endif /* !UNIV_HOTBACKUP */
 
 UNIV_INTERN uint page_compression_level = 6;
+/** Compression algorithm used for compressing pages, PAGE_ZIP_ALGORITHM_ */
+UNIV_INTERN ulong page_zip_compression_algorithm = PAGE_ZIP_ALGORITHM_ZLIB;
 
 /* Please refer to ../include/page0zip.ic for a description of the
 compressed page format. */
@@ -739,6 +742,258 @@ page_zip_set_alloc(
 	strm->opaque = heap;
 }
 
+/** The uncompressed payload of a page that is compressed with the LZ4
+codec.  The codec works on the whole payload at once, so the payload is
+staged here and page_zip_deflate() and page_zip_inflate() emulate the
+zlib stream on top of it.  A z_stream is set up for the LZ4 codec when
+state is Z_NULL; opaque then points to this descriptor, and next_out
+and avail_out (on compression) or next_in and avail_in (on
+decompression) keep referring to the compressed page. */
+typedef struct page_zip_lz4_struct {
+	byte*	data;	/*!< uncompressed payload */
+	ulint	len;	/*!< length of the payload; while compressing,
+			the number of bytes staged so far */
+	ulint	size;	/*!< size of the data buffer */
+	ulint	n_fields_bytes;/*!< length of the index information
+			at the start of the payload */
+} page_zip_lz4_t;
+
+/** Check if a stream is set up for the LZ4 codec.
+@param strm	in: compression or decompression stream
+@return		TRUE if the stream is emulated over a page_zip_lz4_t */
+#define PAGE_ZIP_STREAM_IS_LZ4(strm)	((strm)->state == Z_NULL)
+
+/**********************************************************************//**
+Wrapper for deflate(). For the LZ4 codec, stage the input.
+@return	deflate() status: Z_OK, Z_STREAM_END, Z_BUF_ERROR, ... */
+static
+int
+page_zip_deflate(
+/*=============*/
+	z_streamp	strm,	/*!< in/out: compressed stream */
+	int		flush)	/*!< in: deflate() flushing method */
+{
+	page_zip_lz4_t*	lz4;
+
+	if (!PAGE_ZIP_STREAM_IS_LZ4(strm)) {
+
+		return(deflate(strm, flush));
+	}
+
+	lz4 = strm->opaque;
+
+	if (UNIV_UNLIKELY(strm->avail_in > lz4->size - lz4->len)) {
+
+		return(Z_BUF_ERROR);
+	}
+
+	memcpy(lz4->data + lz4->len, strm->next_in, strm->avail_in);
+	lz4->len += strm->avail_in;
+	strm->next_in += strm->avail_in;
+	strm->total_in += strm->avail_in;
+	strm->avail_in = 0;
+
+	return(flush == Z_FINISH ? Z_STREAM_END : Z_OK);
+}
+
+/**********************************************************************//**
+Wrapper for deflateEnd().
+@return	deflateEnd() status */
+static
+int
+page_zip_deflate_end(
+/*=================*/
+	z_streamp	strm)	/*!< in/out: compressed stream */
+{
+	return(PAGE_ZIP_STREAM_IS_LZ4(strm) ? Z_OK : deflateEnd(strm));
+}
+
+/**********************************************************************//**
+Set up a compression stream for the LZ4 codec.  The output of the stream,
+next_out and avail_out, must have been initialized. */
+static
+void
+page_zip_lz4_init_c_stream(
+/*=======================*/
+	z_streamp	strm,	/*!< in/out: compressed stream */
+	mem_heap_t*	heap)	/*!< in: memory heap for the staging buffer */
+{
+	page_zip_lz4_t*	lz4 = mem_heap_alloc(heap, sizeof *lz4);
+
+	lz4->size = UNIV_PAGE_SIZE;
+	lz4->data = mem_heap_alloc(heap, lz4->size);
+	lz4->len = 0;
+	lz4->n_fields_bytes = 0;
+
+	strm->zalloc = Z_NULL;
+	strm->zfree = Z_NULL;
+	strm->opaque = lz4;
+	strm->state = Z_NULL;
+	strm->msg = Z_NULL;
+	strm->total_in = 0;
+	strm->total_out = 0;
+}
+
+/**********************************************************************//**
+Compress the payload that was staged by page_zip_deflate() into the
+output of the stream, after the LZ4 stream header.
+@return	TRUE on success, FALSE if the compressed payload does not fit */
+static
+ibool
+page_zip_lz4_compress(
+/*==================*/
+	z_streamp	strm,	/*!< in/out: compressed stream */
+	mem_heap_t*	heap)	/*!< in: memory heap for the work area */
+{
+	const page_zip_lz4_t*	lz4 = strm->opaque;
+	ulint			len;
+
+	ut_ad(PAGE_ZIP_STREAM_IS_LZ4(strm));
+	ut_ad(lz4->len <= UT_LZ4_MAX_INPUT_SIZE);
+
+	if (UNIV_UNLIKELY(strm->avail_out <= PAGE_ZIP_LZ4_HEADER_SIZE)) {
+
+		return(FALSE);
+	}
+
+	len = ut_lz4_compress(lz4->data, lz4->len,
+			      strm->next_out + PAGE_ZIP_LZ4_HEADER_SIZE,
+			      strm->avail_out - PAGE_ZIP_LZ4_HEADER_SIZE,
+			      mem_heap_alloc(heap, UT_LZ4_WORK_SIZE));
+
+	if (UNIV_UNLIKELY(!len)) {
+
+		return(FALSE);
+	}
+
+	mach_write_to_1(strm->next_out, PAGE_ZIP_LZ4_MAGIC);
+	mach_write_to_2(strm->next_out + 1, len);
+	mach_write_to_2(strm->next_out + 3, lz4->n_fields_bytes);
+
+	len += PAGE_ZIP_LZ4_HEADER_SIZE;
+	strm->next_out += len;
+	strm->avail_out -= len;
+	strm->total_out += len;
+
+	return(TRUE);
+}
+
+/**********************************************************************//**
+Set up a decompression stream for a page that was compressed with the
+LZ4 codec.  Decompress the payload and copy the index information to
+the output of the stream.
+@return	TRUE on success, FALSE if the page is corrupted */
+static
+ibool
+page_zip_lz4_init_d_stream(
+/*=======================*/
+	z_streamp	strm,	/*!< in/out: decompression stream, with
+				next_in and avail_in at the compressed
+				stream and next_out, avail_out initialized */
+	mem_heap_t*	heap)	/*!< in: memory heap for the payload */
+{
+	page_zip_lz4_t*	lz4;
+	ulint		len;
+
+	if (UNIV_UNLIKELY(strm->avail_in <= PAGE_ZIP_LZ4_HEADER_SIZE)) {
+
+		return(FALSE);
+	}
+
+	ut_ad(mach_read_from_1(strm->next_in) == PAGE_ZIP_LZ4_MAGIC);
+
+	len = mach_read_from_2(strm->next_in + 1);
+
+	if (UNIV_UNLIKELY(len > strm->avail_in
+			  - PAGE_ZIP_LZ4_HEADER_SIZE)) {
+
+		return(FALSE);
+	}
+
+	lz4 = mem_heap_alloc(heap, sizeof *lz4);
+	lz4->size = UNIV_PAGE_SIZE;
+	lz4->data = mem_heap_alloc(heap, lz4->size);
+	lz4->n_fields_bytes = mach_read_from_2(strm->next_in + 3);
+	lz4->len = ut_lz4_decompress(strm->next_in + PAGE_ZIP_LZ4_HEADER_SIZE,
+				     len, lz4->data, lz4->size);
+
+	if (UNIV_UNLIKELY(lz4->len == ULINT_UNDEFINED)
+	    || UNIV_UNLIKELY(lz4->n_fields_bytes > lz4->len)
+	    || UNIV_UNLIKELY(lz4->n_fields_bytes > strm->avail_out)) {
+
+		return(FALSE);
+	}
+
+	strm->zalloc = Z_NULL;
+	strm->zfree = Z_NULL;
+	strm->opaque = lz4;
+	strm->state = Z_NULL;
+	strm->msg = Z_NULL;
+
+	/* The modification log follows the compressed block. */
+	len += PAGE_ZIP_LZ4_HEADER_SIZE;
+	strm->next_in += len;
+	strm->avail_in -= len;
+	strm->total_in = len;
+
+	/* Decode the index information. */
+	memcpy(strm->next_out, lz4->data, lz4->n_fields_bytes);
+	strm->next_out += lz4->n_fields_bytes;
+	strm->avail_out -= lz4->n_fields_bytes;
+	strm->total_out = lz4->n_fields_bytes;
+
+	return(TRUE);
+}
+
+/**********************************************************************//**
+Wrapper for inflate().  For the LZ4 codec, copy from the decompressed
+payload.
+@return	inflate() status: Z_OK, Z_STREAM_END, Z_BUF_ERROR, ... */
+static
+int
+page_zip_inflate(
+/*=============*/
+	z_streamp	strm,	/*!< in/out: decompression stream */
+	int		flush)	/*!< in: inflate() flushing method */
+{
+	const page_zip_lz4_t*	lz4;
+	ulint			len;
+
+	if (!PAGE_ZIP_STREAM_IS_LZ4(strm)) {
+
+		return(inflate(strm, flush));
+	}
+
+	lz4 = strm->opaque;
+	ut_ad(strm->total_out <= lz4->len);
+
+	len = ut_min(lz4->len - strm->total_out, strm->avail_out);
+	memcpy(strm->next_out, lz4->data + strm->total_out, len);
+	strm->next_out += len;
+	strm->avail_out -= len;
+	strm->total_out += len;
+
+	if (strm->total_out == lz4->len
+	    && (strm->avail_out || flush == Z_FINISH)) {
+
+		return(Z_STREAM_END);
+	}
+
+	return(len ? Z_OK : Z_BUF_ERROR);
+}
+
+/**********************************************************************//**
+Wrapper for inflateEnd().
+@return	inflateEnd() status */
+static
+int
+page_zip_inflate_end(
+/*=================*/
+	z_streamp	strm)	/*!< in/out: decompression stream */
+{
+	return(PAGE_ZIP_STREAM_IS_LZ4(strm) ? Z_OK : inflateEnd(strm));
+}
+
 #if 0 || defined UNIV_DEBUG || defined UNIV_ZIP_DEBUG
 /** Symbol for enabling compression and decompression diagnostics */
 # define PAGE_ZIP_COMPRESS_DBG
@@ -755,7 +1010,8 @@ as a log file name generator. */
 UNIV_INTERN unsigned	page_zip_compress_log;
 
 /**********************************************************************//**
-Wrapper for deflate().  Log the operation if page_zip_compress_dbg is set.
+Wrapper for page_zip_deflate().  Log the operation if page_zip_compress_dbg
+is set.
 @return	deflate() status: Z_OK, Z_BUF_ERROR, ... */
 static
 int
@@ -772,21 +1028,20 @@ page_zip_compress_deflate(
 	if (UNIV_LIKELY_NULL(logfile)) {
 		blind_fwrite(strm->next_in, 1, strm->avail_in, logfile);
 	}
-	status = deflate(strm, flush);
+	status = page_zip_deflate(strm, flush);
 	if (UNIV_UNLIKELY(page_zip_compress_dbg)) {
 		fprintf(stderr, " -> %d\n", status);
 	}
 	return(status);
 }
 
-/* Redefine deflate(). */
-# undef deflate
-/** Debug wrapper for the zlib compression routine deflate().
+/** Debug wrapper for the compression routine page_zip_deflate().
 Log the operation if page_zip_compress_dbg is set.
 @param strm	in/out: compressed stream
 @param flush	in: flushing method
 @return		deflate() status: Z_OK, Z_BUF_ERROR, ... */
-# define deflate(strm, flush) page_zip_compress_deflate(logfile, strm, flush)
+# define page_zip_deflate(strm, flush)				\
+	page_zip_compress_deflate(logfile, strm, flush)
 /** Declaration of the logfile parameter */
 # define FILE_LOGFILE FILE* logfile,
 /** The logfile parameter */
@@ -834,7 +1089,7 @@ page_zip_compress_node_ptrs(
 			- c_stream->next_in;
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 				break;
 			}
@@ -847,7 +1102,7 @@ page_zip_compress_node_ptrs(
 			- REC_NODE_PTR_SIZE;
 		ut_ad(c_stream->avail_in);
 
-		err = deflate(c_stream, Z_NO_FLUSH);
+		err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 		if (UNIV_UNLIKELY(err != Z_OK)) {
 			break;
 		}
@@ -890,7 +1145,7 @@ page_zip_compress_sec(
 		if (UNIV_LIKELY(c_stream->avail_in)) {
 			UNIV_MEM_ASSERT_RW(c_stream->next_in,
 					   c_stream->avail_in);
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 				break;
 			}
@@ -954,7 +1209,7 @@ page_zip_compress_clust_ext(
 				= src - c_stream->next_in;
 
 			if (c_stream->avail_in) {
-				err = deflate(c_stream, Z_NO_FLUSH);
+				err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 				if (UNIV_UNLIKELY(err != Z_OK)) {
 
 					return(err);
@@ -983,7 +1238,7 @@ page_zip_compress_clust_ext(
 			c_stream->avail_in = src
 				- c_stream->next_in;
 			if (UNIV_LIKELY(c_stream->avail_in)) {
-				err = deflate(c_stream, Z_NO_FLUSH);
+				err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 				if (UNIV_UNLIKELY(err != Z_OK)) {
 
 					return(err);
@@ -1080,7 +1335,7 @@ page_zip_compress_clust(
 			- c_stream->next_in;
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 
 				goto func_exit;
@@ -1127,7 +1382,7 @@ page_zip_compress_clust(
 			c_stream->avail_in = src - c_stream->next_in;
 
 			if (c_stream->avail_in) {
-				err = deflate(c_stream, Z_NO_FLUSH);
+				err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 				if (UNIV_UNLIKELY(err != Z_OK)) {
 
 					return(err);
@@ -1155,7 +1410,7 @@ page_zip_compress_clust(
 			- c_stream->next_in;
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 
 				goto func_exit;
@@ -1259,9 +1514,10 @@ page_zip_compress(
 	uint level;
 	uint wrap;
 	uint strategy;
+	uint algorithm;
 	int window_bits;
 	page_zip_decode_compression_flags(compression_flags, &level,
-	                                  &wrap, &strategy);
+	                                  &wrap, &strategy, &algorithm);
 	window_bits = wrap ? UNIV_PAGE_SIZE_SHIFT
 	                   : -((int)UNIV_PAGE_SIZE_SHIFT);
 	my_get_fast_timer(&start);
@@ -1420,17 +1676,23 @@ page_zip_compress(
 						   trx_id_col, fields);
 	c_stream.next_in = fields;
 
-	err = deflateInit2(&c_stream, level,
-			   Z_DEFLATED, window_bits,
-			   MAX_MEM_LEVEL, strategy);
-	ut_a(err == Z_OK);
+	if (algorithm == PAGE_ZIP_ALGORITHM_LZ4) {
+		page_zip_lz4_init_c_stream(&c_stream, heap);
+		((page_zip_lz4_t*) c_stream.opaque)->n_fields_bytes
+			= c_stream.avail_in;
+	} else {
+		err = deflateInit2(&c_stream, level,
+				   Z_DEFLATED, window_bits,
+				   MAX_MEM_LEVEL, strategy);
+		ut_a(err == Z_OK);
+	}
 
 	if (UNIV_LIKELY(!trx_id_col)) {
 		trx_id_col = ULINT_UNDEFINED;
 	}
 
 	UNIV_MEM_ASSERT_RW(c_stream.next_in, c_stream.avail_in);
-	err = deflate(&c_stream, Z_FULL_FLUSH);
+	err = page_zip_deflate(&c_stream, Z_FULL_FLUSH);
 	if (err != Z_OK) {
 		goto zlib_error;
 	}
@@ -1484,11 +1746,18 @@ page_zip_compress(
 	ut_a(c_stream.avail_in <= UNIV_PAGE_SIZE - PAGE_ZIP_START - PAGE_DIR);
 
 	UNIV_MEM_ASSERT_RW(c_stream.next_in, c_stream.avail_in);
-	err = deflate(&c_stream, Z_FINISH);
+	err = page_zip_deflate(&c_stream, Z_FINISH);
+
+	if (algorithm == PAGE_ZIP_ALGORITHM_LZ4
+	    && UNIV_LIKELY(err == Z_STREAM_END)
+	    && UNIV_UNLIKELY(!page_zip_lz4_compress(&c_stream, heap))) {
+
+		err = Z_BUF_ERROR;
+	}
 
 	if (UNIV_UNLIKELY(err != Z_STREAM_END)) {
 zlib_error:
-		deflateEnd(&c_stream);
+		page_zip_deflate_end(&c_stream);
 		mem_heap_free(heap);
 err_exit:
 #ifdef PAGE_ZIP_COMPRESS_DBG
@@ -1512,6 +1781,10 @@ err_exit:
 				stats->comp_stat.page_size = comp_stat_page_size;
 
 		 	stats->comp_stat.compressed_usec += udiff;
+			if (algorithm == PAGE_ZIP_ALGORITHM_LZ4) {
+				++stats->comp_stat.compressed_lz4;
+				stats->comp_stat.compressed_lz4_usec += udiff;
+			}
 			if (dict_index_is_clust(index)) {
 				++stats->comp_stat.compressed_primary;
 				stats->comp_stat.compressed_primary_usec += udiff;
@@ -1532,7 +1805,7 @@ err_exit:
 		return(FALSE);
 	}
 
-	err = deflateEnd(&c_stream);
+	err = page_zip_deflate_end(&c_stream);
 	ut_a(err == Z_OK);
 
 	ut_ad(buf + c_stream.total_out == c_stream.next_out);
@@ -1611,6 +1884,11 @@ err_exit:
 		++stats->comp_stat.compressed_ok;
 		stats->comp_stat.compressed_usec += udiff;
 		stats->comp_stat.compressed_ok_usec += udiff;
+		if (algorithm == PAGE_ZIP_ALGORITHM_LZ4) {
+			++stats->comp_stat.compressed_lz4;
+			++stats->comp_stat.compressed_lz4_ok;
+			stats->comp_stat.compressed_lz4_usec += udiff;
+		}
 		if (dict_index_is_clust(index)) {
 			++stats->comp_stat.compressed_primary;
 			++stats->comp_stat.compressed_primary_ok;
@@ -2316,7 +2594,7 @@ page_zip_decompress_node_ptrs(
 
 		ut_ad(d_stream->avail_out < UNIV_PAGE_SIZE
 		      - PAGE_ZIP_START - PAGE_DIR);
-		switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+		switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 		case Z_STREAM_END:
 			/* Apparently, n_dense has grown
 			since the time the page was last compressed. */
@@ -2353,7 +2631,7 @@ page_zip_decompress_node_ptrs(
 		d_stream->avail_out = rec_offs_data_size(offsets)
 			- REC_NODE_PTR_SIZE;
 
-		switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+		switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 		case Z_STREAM_END:
 			goto zlib_done;
 		case Z_OK:
@@ -2392,12 +2670,12 @@ page_zip_decompress_node_ptrs(
 		goto zlib_error;
 	}
 
-	if (UNIV_UNLIKELY(inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
 		page_zip_fail(("page_zip_decompress_node_ptrs:"
 			       " inflate(Z_FINISH)=%s\n",
 			       d_stream->msg));
 zlib_error:
-		inflateEnd(d_stream);
+		page_zip_inflate_end(d_stream);
 		return(FALSE);
 	}
 
@@ -2405,7 +2683,7 @@ zlib_error:
 	if the modification log is nonempty. */
 
 zlib_done:
-	if (UNIV_UNLIKELY(inflateEnd(d_stream) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate_end(d_stream) != Z_OK)) {
 		ut_error;
 	}
 
@@ -2506,7 +2784,7 @@ page_zip_decompress_sec(
 			- d_stream->next_out;
 
 		if (UNIV_LIKELY(d_stream->avail_out)) {
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 				/* Apparently, n_dense has grown
 				since the time the page was last compressed. */
@@ -2551,12 +2829,12 @@ page_zip_decompress_sec(
 		goto zlib_error;
 	}
 
-	if (UNIV_UNLIKELY(inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
 		page_zip_fail(("page_zip_decompress_sec:"
 			       " inflate(Z_FINISH)=%s\n",
 			       d_stream->msg));
 zlib_error:
-		inflateEnd(d_stream);
+		page_zip_inflate_end(d_stream);
 		return(FALSE);
 	}
 
@@ -2564,7 +2842,7 @@ zlib_error:
 	if the modification log is nonempty. */
 
 zlib_done:
-	if (UNIV_UNLIKELY(inflateEnd(d_stream) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate_end(d_stream) != Z_OK)) {
 		ut_error;
 	}
 
@@ -2656,7 +2934,7 @@ page_zip_decompress_clust_ext(
 
 			d_stream->avail_out = dst - d_stream->next_out;
 
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 			case Z_OK:
 			case Z_BUF_ERROR:
@@ -2686,7 +2964,7 @@ page_zip_decompress_clust_ext(
 			dst += len - BTR_EXTERN_FIELD_REF_SIZE;
 
 			d_stream->avail_out = dst - d_stream->next_out;
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 			case Z_OK:
 			case Z_BUF_ERROR:
@@ -2764,7 +3042,7 @@ page_zip_decompress_clust(
 
 		ut_ad(d_stream->avail_out < UNIV_PAGE_SIZE
 		      - PAGE_ZIP_START - PAGE_DIR);
-		err = inflate(d_stream, Z_SYNC_FLUSH);
+		err = page_zip_inflate(d_stream, Z_SYNC_FLUSH);
 		switch (err) {
 		case Z_STREAM_END:
 			/* Apparently, n_dense has grown
@@ -2822,7 +3100,7 @@ page_zip_decompress_clust(
 
 			d_stream->avail_out = dst - d_stream->next_out;
 
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 			case Z_OK:
 			case Z_BUF_ERROR:
@@ -2852,7 +3130,7 @@ page_zip_decompress_clust(
 		d_stream->avail_out = rec_get_end(rec, offsets)
 			- d_stream->next_out;
 
-		switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+		switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 		case Z_STREAM_END:
 		case Z_OK:
 		case Z_BUF_ERROR:
@@ -2882,12 +3160,12 @@ page_zip_decompress_clust(
 		goto zlib_error;
 	}
 
-	if (UNIV_UNLIKELY(inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
 		page_zip_fail(("page_zip_decompress_clust:"
 			       " inflate(Z_FINISH)=%s\n",
 			       d_stream->msg));
 zlib_error:
-		inflateEnd(d_stream);
+		page_zip_inflate_end(d_stream);
 		return(FALSE);
 	}
 
@@ -2895,7 +3173,7 @@ zlib_error:
 	if the modification log is nonempty. */
 
 zlib_done:
-	if (UNIV_UNLIKELY(inflateEnd(d_stream) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate_end(d_stream) != Z_OK)) {
 		ut_error;
 	}
 
@@ -3096,6 +3374,7 @@ page_zip_decompress(
 	ulint		trx_id_col = ULINT_UNDEFINED;
 	mem_heap_t*	heap;
 	ulint*		offsets;
+	ibool		lz4	= FALSE;/* TRUE if compressed with LZ4 */
 #ifndef UNIV_HOTBACKUP
 	my_fast_timer_t start;
 	ullint udiff;
@@ -3190,16 +3469,24 @@ zlib_error:
 	d_stream.next_out = page + PAGE_ZIP_START;
 	d_stream.avail_out = UNIV_PAGE_SIZE - PAGE_ZIP_START;
 
-	if (UNIV_UNLIKELY(!page_zip_init_d_stream(&d_stream, UNIV_PAGE_SIZE_SHIFT,
-	                                          TRUE))) {
+	if (mach_read_from_1(d_stream.next_in) == PAGE_ZIP_LZ4_MAGIC) {
+		lz4 = TRUE;
+
+		/* Decompress the page and decode index */
+		if (UNIV_UNLIKELY(!page_zip_lz4_init_d_stream(&d_stream,
+							      heap))) {
+			page_zip_fail(("page_zip_decompress:"
+				       " LZ4 stream is corrupted\n"));
+			goto zlib_error;
+		}
+	} else if (UNIV_UNLIKELY(!page_zip_init_d_stream(&d_stream,
+							 UNIV_PAGE_SIZE_SHIFT,
+							 TRUE))) {
 		page_zip_fail(("page_zip_decompress:"
 		       " 1 inflate(Z_BLOCK)=%s\n", d_stream.msg));
 		goto zlib_error;
-	}
-
-	/* Decode index */
-	if (UNIV_UNLIKELY(inflate(&d_stream, Z_BLOCK) != Z_OK)) {
-
+	} else if (UNIV_UNLIKELY(inflate(&d_stream, Z_BLOCK) != Z_OK)) {
+		/* Decode index */
 		page_zip_fail(("page_zip_decompress:"
 			       " 2 inflate(Z_BLOCK)=%s\n", d_stream.msg));
 		goto zlib_error;
@@ -3297,6 +3584,10 @@ err_exit:
 	if (stats) {
 		++stats->comp_stat.decompressed;
 		stats->comp_stat.decompressed_usec += udiff;
+		if (lz4) {
+			++stats->comp_stat.decompressed_lz4;
+			stats->comp_stat.decompressed_lz4_usec += udiff;
+		}
 		if (space_id)
 			stats->comp_stat.page_size = comp_stat_page_size;
 	}
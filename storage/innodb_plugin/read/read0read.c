@@ -263,6 +263,18 @@ read_view_open_now(
 
 	ut_ad(mutex_own(&kernel_mutex));
 
+	if (ut_dulint_is_zero(cr_trx_id)
+	    && !ut_dulint_cmp(trx_sys->query_cache_inv_trx_id,
+			      trx_sys->max_trx_id)) {
+		/* A read-only transaction has no trx id, and it compares
+		dict_table_t::query_cache_inv_trx_id with the low limit of
+		its view instead. Consume a trx id so that a transaction
+		committing after the view was opened cannot invalidate the
+		query cache at the low limit. */
+
+		trx_sys_get_new_trx_id();
+	}
+
 	view = read_view_create_low(UT_LIST_GET_LEN(trx_sys->trx_list), heap);
 
 	view->creator_trx_id = cr_trx_id;
@@ -31,6 +31,10 @@ Created 7/1/1994 Heikki Tuuri
 
 #include "srv0srv.h"
 
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
 /*		ALPHABETICAL ORDER
 		==================
 
@@ -104,6 +108,111 @@ cmp_collate(
 	return((ulint) srv_latin1_ordering[code]);
 }
 
+/*************************************************************//**
+Checks if fields of a data type must be compared as a whole by
+cmp_whole_field(), or if they can be compared byte by byte, padding
+the shorter field and, for latin1_swedish_ci, collating the first
+differing bytes.  Besides the binary types, the latin1_swedish_ci
+strings and the latin1_bin strings are compared byte by byte: the
+latin1_bin collation orders by byte value and pads with spaces, which
+is exactly what the byte by byte comparison does.
+@return	TRUE if the fields must be compared by cmp_whole_field() */
+UNIV_INLINE
+ibool
+cmp_type_is_whole_field(
+/*====================*/
+	ulint	mtype,	/*!< in: main type */
+	ulint	prtype)	/*!< in: precise type */
+{
+	switch (mtype) {
+	case DATA_BLOB:
+		if (prtype & DATA_BINARY_TYPE) {
+
+			return(FALSE);
+		}
+
+		if (dtype_get_charset_coll(prtype)
+		    == DATA_MYSQL_LATIN1_SWEDISH_CHARSET_COLL) {
+
+			return(FALSE);
+		}
+		/* fall through */
+	case DATA_VARMYSQL:
+	case DATA_MYSQL:
+		return(dtype_get_charset_coll(prtype)
+		       != DATA_MYSQL_LATIN1_BIN_CHARSET_COLL);
+	default:
+		return(mtype >= DATA_FLOAT);
+	}
+}
+
+/*************************************************************//**
+Checks if differing bytes of fields of a data type which is compared
+byte by byte must be transformed with cmp_collate() before comparing.
+@return	TRUE if the latin1_swedish_ci ordering applies */
+UNIV_INLINE
+ibool
+cmp_type_is_collated(
+/*=================*/
+	ulint	mtype,	/*!< in: main type */
+	ulint	prtype)	/*!< in: precise type */
+{
+	return(mtype <= DATA_CHAR
+	       || (mtype == DATA_BLOB
+		   && !(prtype & DATA_BINARY_TYPE)
+		   && dtype_get_charset_coll(prtype)
+		   == DATA_MYSQL_LATIN1_SWEDISH_CHARSET_COLL));
+}
+
+/*************************************************************//**
+Computes the length of the common prefix of two byte strings.  The
+bytes are compared 16 at a time with SSE2 where available and a
+machine word at a time otherwise; the byte by byte comparison loops
+use this to skip the equal leading bytes of two fields, which are
+equal also after the collation transformation.
+@return	number of equal leading bytes, at most len */
+UNIV_INLINE
+ulint
+cmp_common_prefix_len(
+/*==================*/
+	const byte*	a,	/*!< in: byte string */
+	const byte*	b,	/*!< in: byte string */
+	ulint		len)	/*!< in: number of bytes to compare */
+{
+	ulint	i = 0;
+
+#ifdef __SSE2__
+	for (; i + 16 <= len; i += 16) {
+		__m128i	va = _mm_loadu_si128((const __m128i*) (a + i));
+		__m128i	vb = _mm_loadu_si128((const __m128i*) (b + i));
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xFFFF) {
+
+			break;
+		}
+	}
+#endif /* __SSE2__ */
+
+	for (; i + sizeof(ulint) <= len; i += sizeof(ulint)) {
+		ulint	wa;
+		ulint	wb;
+
+		memcpy(&wa, a + i, sizeof wa);
+		memcpy(&wb, b + i, sizeof wb);
+
+		if (wa != wb) {
+
+			break;
+		}
+	}
+
+	while (i < len && a[i] == b[i]) {
+		i++;
+	}
+
+	return(i);
+}
+
 /*************************************************************//**
 Returns TRUE if two columns are equal for comparison purposes.
 @return	TRUE if the columns are considered equal in comparisons */
@@ -321,20 +430,18 @@ cmp_data_data_slow(
 		return(1);
 	}
 
-	if (mtype >= DATA_FLOAT
-	    || (mtype == DATA_BLOB
-		&& 0 == (prtype & DATA_BINARY_TYPE)
-		&& dtype_get_charset_coll(prtype)
-		!= DATA_MYSQL_LATIN1_SWEDISH_CHARSET_COLL)) {
+	if (cmp_type_is_whole_field(mtype, prtype)) {
 
 		return(cmp_whole_field(mtype, prtype,
 				       data1, (unsigned) len1,
 				       data2, (unsigned) len2));
 	}
 
-	/* Compare then the fields */
+	/* Skip the common prefix, then compare the rest of the fields */
 
-	cur_bytes = 0;
+	cur_bytes = cmp_common_prefix_len(data1, data2, ut_min(len1, len2));
+	data1 += cur_bytes;
+	data2 += cur_bytes;
 
 	for (;;) {
 		if (len1 <= cur_bytes) {
@@ -371,9 +478,7 @@ cmp_data_data_slow(
 			goto next_byte;
 		}
 
-		if (mtype <= DATA_CHAR
-		    || (mtype == DATA_BLOB
-			&& 0 == (prtype & DATA_BINARY_TYPE))) {
+		if (cmp_type_is_collated(mtype, prtype)) {
 
 			data1_byte = cmp_collate(data1_byte);
 			data2_byte = cmp_collate(data2_byte);
@@ -521,11 +626,7 @@ cmp_dtuple_rec_with_match(
 			}
 		}
 
-		if (mtype >= DATA_FLOAT
-		    || (mtype == DATA_BLOB
-			&& 0 == (prtype & DATA_BINARY_TYPE)
-			&& dtype_get_charset_coll(prtype)
-			!= DATA_MYSQL_LATIN1_SWEDISH_CHARSET_COLL)) {
+		if (cmp_type_is_whole_field(mtype, prtype)) {
 
 			ret = cmp_whole_field(mtype, prtype,
 					      dfield_get_data(dtuple_field),
@@ -546,6 +647,19 @@ cmp_dtuple_rec_with_match(
 		rec_b_ptr = rec_b_ptr + cur_bytes;
 		dtuple_b_ptr = (byte*)dfield_get_data(dtuple_field)
 			+ cur_bytes;
+
+		/* Skip the bytes that are equal in both fields */
+
+		if (cur_bytes < ut_min(rec_f_len, dtuple_f_len)) {
+			ulint	n_equal = cmp_common_prefix_len(
+				dtuple_b_ptr, rec_b_ptr,
+				ut_min(rec_f_len, dtuple_f_len) - cur_bytes);
+
+			cur_bytes += n_equal;
+			rec_b_ptr += n_equal;
+			dtuple_b_ptr += n_equal;
+		}
+
 		/* Compare then the fields */
 
 		for (;;) {
@@ -587,9 +701,7 @@ cmp_dtuple_rec_with_match(
 				goto next_byte;
 			}
 
-			if (mtype <= DATA_CHAR
-			    || (mtype == DATA_BLOB
-				&& !(prtype & DATA_BINARY_TYPE))) {
+			if (cmp_type_is_collated(mtype, prtype)) {
 
 				rec_byte = cmp_collate(rec_byte);
 				dtuple_byte = cmp_collate(dtuple_byte);
@@ -773,11 +885,7 @@ cmp_rec_rec_simple(
 			}
 		}
 
-		if (mtype >= DATA_FLOAT
-		    || (mtype == DATA_BLOB
-			&& 0 == (prtype & DATA_BINARY_TYPE)
-			&& dtype_get_charset_coll(prtype)
-			!= DATA_MYSQL_LATIN1_SWEDISH_CHARSET_COLL)) {
+		if (cmp_type_is_whole_field(mtype, prtype)) {
 			int ret = cmp_whole_field(mtype, prtype,
 						  rec1_b_ptr,
 						  (unsigned) rec1_f_len,
@@ -790,8 +898,13 @@ cmp_rec_rec_simple(
 			goto next_field;
 		}
 
-		/* Compare the fields */
-		for (cur_bytes = 0;; cur_bytes++, rec1_b_ptr++, rec2_b_ptr++) {
+		/* Skip the common prefix, then compare the fields */
+		cur_bytes = cmp_common_prefix_len(
+			rec1_b_ptr, rec2_b_ptr, ut_min(rec1_f_len, rec2_f_len));
+		rec1_b_ptr += cur_bytes;
+		rec2_b_ptr += cur_bytes;
+
+		for (;; cur_bytes++, rec1_b_ptr++, rec2_b_ptr++) {
 			if (rec2_f_len <= cur_bytes) {
 
 				if (rec1_f_len <= cur_bytes) {
@@ -826,9 +939,7 @@ cmp_rec_rec_simple(
 				continue;
 			}
 
-			if (mtype <= DATA_CHAR
-			    || (mtype == DATA_BLOB
-				&& !(prtype & DATA_BINARY_TYPE))) {
+			if (cmp_type_is_collated(mtype, prtype)) {
 
 				rec1_byte = cmp_collate(rec1_byte);
 				rec2_byte = cmp_collate(rec2_byte);
@@ -987,11 +1098,7 @@ cmp_rec_rec_with_match(
 			}
 		}
 
-		if (mtype >= DATA_FLOAT
-		    || (mtype == DATA_BLOB
-			&& 0 == (prtype & DATA_BINARY_TYPE)
-			&& dtype_get_charset_coll(prtype)
-			!= DATA_MYSQL_LATIN1_SWEDISH_CHARSET_COLL)) {
+		if (cmp_type_is_whole_field(mtype, prtype)) {
 
 			ret = cmp_whole_field(mtype, prtype,
 					      rec1_b_ptr,
@@ -1011,6 +1118,18 @@ cmp_rec_rec_with_match(
 		rec1_b_ptr = rec1_b_ptr + cur_bytes;
 		rec2_b_ptr = rec2_b_ptr + cur_bytes;
 
+		/* Skip the bytes that are equal in both fields */
+
+		if (cur_bytes < ut_min(rec1_f_len, rec2_f_len)) {
+			ulint	n_equal = cmp_common_prefix_len(
+				rec1_b_ptr, rec2_b_ptr,
+				ut_min(rec1_f_len, rec2_f_len) - cur_bytes);
+
+			cur_bytes += n_equal;
+			rec1_b_ptr += n_equal;
+			rec2_b_ptr += n_equal;
+		}
+
 		/* Compare then the fields */
 		for (;;) {
 			if (rec2_f_len <= cur_bytes) {
@@ -1051,9 +1170,7 @@ cmp_rec_rec_with_match(
 				goto next_byte;
 			}
 
-			if (mtype <= DATA_CHAR
-			    || (mtype == DATA_BLOB
-				&& !(prtype & DATA_BINARY_TYPE))) {
+			if (cmp_type_is_collated(mtype, prtype)) {
 
 				rec1_byte = cmp_collate(rec1_byte);
 				rec2_byte = cmp_collate(rec2_byte);
@@ -3774,7 +3774,11 @@ release_search_latch_if_needed:
 	      || prebuilt->select_lock_type != LOCK_NONE
 	      || trx->read_view);
 
-	trx_start_if_not_started(trx);
+	if (prebuilt->select_lock_type == LOCK_NONE) {
+		trx_start_for_read_if_not_started(trx);
+	} else {
+		trx_start_if_not_started(trx);
+	}
 
 	if (trx->isolation_level <= TRX_ISO_READ_COMMITTED
 	    && prebuilt->select_lock_type != LOCK_NONE
@@ -4828,6 +4832,7 @@ row_search_check_if_query_cache_permitted(
 					'/' char, table name */
 {
 	dict_table_t*	table;
+	trx_id_t	inv_limit;
 	ibool		ret	= FALSE;
 
 	table = dict_table_get(norm_name, FALSE, TRUE);
@@ -4837,11 +4842,27 @@ row_search_check_if_query_cache_permitted(
 		return(FALSE);
 	}
 
+	/* Start the transaction if it is not started yet */
+
+	trx_start_for_read_if_not_started(trx);
+
 	mutex_enter(&kernel_mutex);
 
-	/* Start the transaction if it is not started yet */
+	if (!trx->read_only) {
+		inv_limit = ut_dulint_add(trx->id, 1);
+	} else {
+		/* A read-only transaction has no trx id: the changes of
+		the transactions that invalidated the cache below the
+		low limit of its read view are visible in the view. */
 
-	trx_start_if_not_started_low(trx);
+		if (!trx->read_view) {
+			trx->read_view = read_view_open_now(
+				trx->id, trx->global_read_view_heap);
+			trx->global_read_view = trx->read_view;
+		}
+
+		inv_limit = trx->read_view->low_limit_id;
+	}
 
 	/* If there are locks on the table or some trx has invalidated the
 	cache up to our trx id, then ret = FALSE.
@@ -4849,8 +4870,8 @@ row_search_check_if_query_cache_permitted(
 	IX type locks actually would require ret = FALSE. */
 
 	if (UT_LIST_GET_LEN(table->locks) == 0
-	    && ut_dulint_cmp(trx->id,
-			     table->query_cache_inv_trx_id) >= 0) {
+	    && ut_dulint_cmp(table->query_cache_inv_trx_id,
+			     inv_limit) < 0) {
 
 		ret = TRUE;
 
@@ -400,6 +400,9 @@ UNIV_INTERN ulint	srv_lock_deadlocks	= 0;
 /** Number of row lock wait timeouts */
 UNIV_INTERN ulint	srv_lock_wait_timeouts	= 0;
 
+/** Number of record lock structs reused from a transaction's free list */
+UNIV_INTERN ulint	srv_lock_rec_structs_reused = 0;
+
 /** Number times purge skipped a row because the table had been dropped */
 UNIV_INTERN ulint  srv_drop_purge_skip_row  = 0;
 	
@@ -724,6 +727,8 @@ static ulint   srv_log_writes_and_flush		= 0;
 
 ulint	srv_n_commit_all	= 0;
 ulint	srv_n_commit_with_undo	= 0;
+ulint	srv_n_commit_read_only	= 0;
+ulint	srv_n_read_only_to_read_write = 0;
 ulint	srv_n_rollback_total	= 0;
 ulint	srv_n_rollback_partial	= 0;
 
@@ -2472,12 +2477,16 @@ srv_export_innodb_status(void)
 	export_vars.innodb_ibuf_inserts = ibuf->n_inserts;
 	export_vars.innodb_ibuf_merged_records = ibuf->n_merged_recs;
 	export_vars.innodb_ibuf_merges = ibuf->n_merges;
+	export_vars.innodb_ibuf_discarded_records = ibuf->n_discarded_recs;
+	export_vars.innodb_ibuf_contract_batches = ibuf->n_contract_batches;
 	export_vars.innodb_ibuf_size = ibuf->size;
 
 	export_vars.innodb_page_size = UNIV_PAGE_SIZE;
 
 	export_vars.innodb_lock_deadlocks= srv_lock_deadlocks;
 	export_vars.innodb_lock_wait_timeouts= srv_lock_wait_timeouts;
+	export_vars.innodb_lock_rec_structs_reused
+		= srv_lock_rec_structs_reused;
 
 	export_vars.innodb_log_checkpoints= log_sys->n_checkpoints;
 	export_vars.innodb_log_syncs= log_sys->n_syncs;
@@ -2604,6 +2613,9 @@ srv_export_innodb_status(void)
 
 	export_vars.innodb_trx_n_commit_all= srv_n_commit_all;
 	export_vars.innodb_trx_n_commit_with_undo= srv_n_commit_with_undo;
+	export_vars.innodb_trx_n_commit_read_only= srv_n_commit_read_only;
+	export_vars.innodb_trx_n_read_only_to_read_write=
+		srv_n_read_only_to_read_write;
 	export_vars.innodb_trx_n_rollback_partial= srv_n_rollback_partial;
 	export_vars.innodb_trx_n_rollback_total= srv_n_rollback_total;
 
@@ -138,6 +138,12 @@ trx_rollback_for_mysql(
 		return(DB_SUCCESS);
 	}
 
+	if (trx->read_only) {
+		trx_commit_read_only(trx, FALSE);
+
+		return(DB_SUCCESS);
+	}
+
 	trx->op_info = "rollback";
 
 	/* If we are doing the XA recovery of prepared transactions, then
@@ -162,7 +168,9 @@ trx_rollback_last_sql_stat_for_mysql(
 {
 	int	err;
 
-	if (trx->conc_state == TRX_NOT_STARTED) {
+	if (trx->conc_state == TRX_NOT_STARTED || trx->read_only) {
+
+		/* A read-only transaction has nothing to roll back */
 
 		return(DB_SUCCESS);
 	}
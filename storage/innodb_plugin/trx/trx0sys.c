@@ -1369,6 +1369,8 @@ trx_sys_init_at_db_start(void)
 				   TRX_SYS_TRX_ID_WRITE_MARGIN),
 		2 * TRX_SYS_TRX_ID_WRITE_MARGIN);
 
+	trx_sys->query_cache_inv_trx_id = ut_dulint_zero;
+
 	UT_LIST_INIT(trx_sys->mysql_trx_list);
 	trx_dummy_sess = sess_open();
 	trx_lists_init_at_db_start();
@@ -216,6 +216,7 @@ trx_create(
 	trx->support_xa = TRUE;
 
 	trx->fake_changes = FALSE;
+	trx->read_only = FALSE;
 
 	trx->check_foreigns = TRUE;
 	trx->check_unique_secondary = TRUE;
@@ -273,6 +274,7 @@ trx_create(
 
 	trx->lock_heap = mem_heap_create_in_buffer(256);
 	UT_LIST_INIT(trx->trx_locks);
+	UT_LIST_INIT(trx->rec_lock_free_list);
 
 	UT_LIST_INIT(trx->trx_savepoints);
 
@@ -896,6 +898,78 @@ trx_start(
 	return(ret);
 }
 
+/****************************************************************//**
+Starts a transaction for a consistent read. An autocommit SELECT that
+does not lock any table cannot write, and it is started read-only:
+without a trx id, without a rollback segment and without the kernel
+mutex. */
+UNIV_INTERN
+void
+trx_start_for_read(
+/*===============*/
+	trx_t*	trx)	/*!< in: transaction */
+{
+	ut_ad(trx->conc_state == TRX_NOT_STARTED);
+	ut_ad(!trx->read_only);
+
+	/* Tables locked by the statement, including those used by
+	its stored functions, are counted in mysql_n_tables_locked
+	before any row is read. */
+
+	if (trx->mysql_thd == NULL
+	    || trx->mysql_n_tables_locked > 0
+	    || !thd_trx_is_auto_commit(trx->mysql_thd)) {
+
+		trx_start(trx, ULINT_UNDEFINED);
+
+		return;
+	}
+
+	trx->support_xa = thd_supports_xa(trx->mysql_thd);
+
+	trx->id = ut_dulint_zero;
+	trx->no = ut_dulint_max;
+	trx->read_only = TRUE;
+	trx->start_time = time(NULL);
+
+	trx->conc_state = TRX_ACTIVE;
+}
+
+/****************************************************************//**
+Turns a transaction that was started read-only into a normal one, so
+that it can lock and modify records. */
+UNIV_INTERN
+void
+trx_set_read_write(
+/*===============*/
+	trx_t*	trx)	/*!< in: transaction */
+{
+	ut_ad(trx->read_only);
+	ut_ad(trx->conc_state == TRX_ACTIVE);
+
+	mutex_enter(&kernel_mutex);
+
+	trx->read_only = FALSE;
+	trx->conc_state = TRX_NOT_STARTED;
+
+	trx_start_low(trx, ULINT_UNDEFINED);
+
+	/* The new trx id is above the low limit of the read view:
+	make the view see the changes of the transaction itself. */
+
+	if (trx->read_view) {
+		trx->read_view->creator_trx_id = trx->id;
+	}
+
+	if (trx->global_read_view) {
+		trx->global_read_view->creator_trx_id = trx->id;
+	}
+
+	mutex_exit(&kernel_mutex);
+
+	srv_n_read_only_to_read_write++;
+}
+
 /****************************************************************//**
 Commits a transaction. */
 UNIV_INTERN
@@ -1172,6 +1246,50 @@ trx_commit_off_kernel(
 	trx->error_state = DB_SUCCESS;
 }
 
+/****************************************************************//**
+Commits or rolls back a transaction that was started read-only. It has
+no locks and no undo logs: only closing its read view needs the kernel
+mutex. */
+UNIV_INTERN
+void
+trx_commit_read_only(
+/*=================*/
+	trx_t*	trx,		/*!< in: transaction */
+	ibool	for_commit)	/*!< in: for rollback when FALSE */
+{
+	ut_ad(trx->read_only);
+	ut_ad(trx->conc_state == TRX_ACTIVE);
+	ut_ad(trx->insert_undo == NULL && trx->update_undo == NULL);
+	ut_ad(UT_LIST_GET_LEN(trx->trx_locks) == 0);
+
+	if (for_commit) {
+		srv_n_commit_all++;
+		srv_n_commit_read_only++;
+	} else {
+		srv_n_rollback_total++;
+	}
+
+	if (trx->global_read_view) {
+		mutex_enter(&kernel_mutex);
+		read_view_close(trx->global_read_view);
+		mutex_exit(&kernel_mutex);
+
+		mem_heap_empty(trx->global_read_view_heap);
+		trx->global_read_view = NULL;
+	}
+
+	trx->read_view = NULL;
+
+	trx_roll_free_all_savepoints(trx);
+
+	trx->must_flush_log_later = FALSE;
+	trx->read_only = FALSE;
+	trx->conc_state = TRX_NOT_STARTED;
+	trx->undo_no = ut_dulint_zero;
+	trx->last_sql_stat_start.least_undo_no = ut_dulint_zero;
+	trx->error_state = DB_SUCCESS;
+}
+
 /****************************************************************//**
 Cleans up a transaction at database startup. The cleanup is needed if
 the transaction already got to the middle of a commit when the database
@@ -1780,6 +1898,12 @@ trx_commit_for_mysql(
 
 	ut_a(trx);
 
+	if (trx->read_only) {
+		trx_commit_read_only(trx, TRUE);
+
+		return(DB_SUCCESS);
+	}
+
 	trx_start_if_not_started(trx);
 
 	trx->op_info = "committing";
@@ -1917,6 +2041,10 @@ trx_print(
 		fputs(" purge trx", f);
 	}
 
+	if (trx->read_only) {
+		fputs(" read only", f);
+	}
+
 	if (trx->declared_to_be_inside_innodb) {
 		fprintf(f, ", thread declared inside InnoDB %lu",
 			(ulong) trx->n_tickets_to_enter_innodb);
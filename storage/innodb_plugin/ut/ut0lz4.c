@@ -0,0 +1,341 @@
+/*****************************************************************************
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+*****************************************************************************/
+
+/*******************************************************************//**
+@file ut/ut0lz4.c
+A fast LZ77 block codec producing the LZ4 block format
+
+A block is a sequence of sequences.  Each sequence starts with a token
+byte whose high nibble is the number of literals and whose low nibble
+is the match length minus UT_LZ4_MIN_MATCH; the value 15 in either
+nibble is continued by bytes that are added to it until a byte other
+than 255.  The literals follow, then a 2-byte little-endian match
+offset.  The last sequence consists of literals only.
+************************************************************************/
+
+#include "ut0lz4.h"
+#include "ut0mem.h"
+
+/** Minimum length of a match */
+#define UT_LZ4_MIN_MATCH	4
+/** The last bytes of a block are always literals */
+#define UT_LZ4_LAST_LITERALS	5
+/** A match may not start within this many bytes of the end of a block */
+#define UT_LZ4_MF_LIMIT		12
+/** Maximum distance of a match */
+#define UT_LZ4_MAX_DISTANCE	65535
+/** Value of a token nibble that is continued by extra length bytes */
+#define UT_LZ4_RUN_MASK		15
+
+/**********************************************************************//**
+Reads 4 bytes of unaligned memory.
+@return	the bytes as an integer in host byte order */
+UNIV_INLINE
+ib_uint32_t
+ut_lz4_read32(
+/*==========*/
+	const byte*	p)	/*!< in: pointer to 4 bytes */
+{
+	ib_uint32_t	v;
+
+	memcpy(&v, p, sizeof v);
+
+	return(v);
+}
+
+/**********************************************************************//**
+Computes the hash table slot of the 4-byte sequence at p.
+@return	hash table slot */
+UNIV_INLINE
+ulint
+ut_lz4_hash(
+/*========*/
+	const byte*	p)	/*!< in: pointer to 4 bytes */
+{
+	return((ulint) ((ut_lz4_read32(p) * 2654435761U) & 0xFFFFFFFFU)
+	       >> (32 - UT_LZ4_HASH_BITS));
+}
+
+/**********************************************************************//**
+Writes the continuation bytes of a length that did not fit in a token
+nibble.
+@return	pointer past the written bytes */
+UNIV_INLINE
+byte*
+ut_lz4_write_len(
+/*=============*/
+	byte*	op,	/*!< out: output buffer */
+	ulint	len)	/*!< in: length minus UT_LZ4_RUN_MASK */
+{
+	for (; len >= 255; len -= 255) {
+		*op++ = 255;
+	}
+
+	*op++ = (byte) len;
+
+	return(op);
+}
+
+/**********************************************************************//**
+Compresses a block of data.
+@return	length of the compressed data, or 0 if it does not fit in dst_len */
+UNIV_INTERN
+ulint
+ut_lz4_compress(
+/*============*/
+	const byte*	src,	/*!< in: data to compress */
+	ulint		src_len,/*!< in: length of src, at most
+				UT_LZ4_MAX_INPUT_SIZE */
+	byte*		dst,	/*!< out: compressed data */
+	ulint		dst_len,/*!< in: size of dst */
+	void*		work)	/*!< in/out: work area of
+				UT_LZ4_WORK_SIZE bytes */
+{
+	ib_uint32_t*	hash	= work;
+	const byte*	ip	= src;
+	const byte*	anchor	= src;
+	const byte*	iend	= src + src_len;
+	byte*		op	= dst;
+	byte*		oend	= dst + dst_len;
+	ulint		lit_len;
+
+	ut_ad(src_len <= UT_LZ4_MAX_INPUT_SIZE);
+
+	if (src_len > UT_LZ4_MF_LIMIT) {
+		const byte*	mflimit = iend - UT_LZ4_MF_LIMIT;
+		const byte*	matchlimit = iend - UT_LZ4_LAST_LITERALS;
+
+		/* Stale or unset slots are harmless: every candidate
+		is verified before it is used. */
+		memset(hash, 0, UT_LZ4_WORK_SIZE);
+		hash[ut_lz4_hash(ip)] = 0;
+		ip++;
+
+		while (ip < mflimit) {
+			ulint		h = ut_lz4_hash(ip);
+			const byte*	ref = src + hash[h];
+			ulint		match_len;
+			ulint		offset;
+			byte*		token;
+
+			hash[h] = (ib_uint32_t) (ip - src);
+
+			if (ref >= ip
+			    || ip - ref > UT_LZ4_MAX_DISTANCE
+			    || ut_lz4_read32(ref) != ut_lz4_read32(ip)) {
+				ip++;
+				continue;
+			}
+
+			/* Extend the match forward, then backward. */
+			match_len = UT_LZ4_MIN_MATCH;
+
+			while (ip + match_len < matchlimit
+			       && ip[match_len] == ref[match_len]) {
+				match_len++;
+			}
+
+			while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+				ip--;
+				ref--;
+				match_len++;
+			}
+
+			lit_len = ip - anchor;
+
+			/* token, literals with their length bytes,
+			offset, match length bytes */
+			if (UNIV_UNLIKELY(
+				    (ulint) (oend - op)
+				    < 1 + lit_len + lit_len / 255 + 1
+				    + 2 + match_len / 255 + 1)) {
+
+				return(0);
+			}
+
+			token = op++;
+
+			if (lit_len >= UT_LZ4_RUN_MASK) {
+				*token = UT_LZ4_RUN_MASK << 4;
+				op = ut_lz4_write_len(
+					op, lit_len - UT_LZ4_RUN_MASK);
+			} else {
+				*token = (byte) (lit_len << 4);
+			}
+
+			memcpy(op, anchor, lit_len);
+			op += lit_len;
+
+			offset = ip - ref;
+			*op++ = (byte) offset;
+			*op++ = (byte) (offset >> 8);
+
+			if (match_len - UT_LZ4_MIN_MATCH >= UT_LZ4_RUN_MASK) {
+				*token |= UT_LZ4_RUN_MASK;
+				op = ut_lz4_write_len(
+					op, match_len - UT_LZ4_MIN_MATCH
+					- UT_LZ4_RUN_MASK);
+			} else {
+				*token |= (byte) (match_len
+						  - UT_LZ4_MIN_MATCH);
+			}
+
+			ip += match_len;
+			anchor = ip;
+
+			if (ip < mflimit) {
+				hash[ut_lz4_hash(ip - 2)]
+					= (ib_uint32_t) (ip - 2 - src);
+			}
+		}
+	}
+
+	/* The last literals */
+	lit_len = iend - anchor;
+
+	if (UNIV_UNLIKELY((ulint) (oend - op)
+			  < 1 + lit_len + lit_len / 255 + 1)) {
+
+		return(0);
+	}
+
+	if (lit_len >= UT_LZ4_RUN_MASK) {
+		*op++ = UT_LZ4_RUN_MASK << 4;
+		op = ut_lz4_write_len(op, lit_len - UT_LZ4_RUN_MASK);
+	} else {
+		*op++ = (byte) (lit_len << 4);
+	}
+
+	memcpy(op, anchor, lit_len);
+	op += lit_len;
+
+	return(op - dst);
+}
+
+/**********************************************************************//**
+Decompresses a block of data that was compressed by ut_lz4_compress().
+@return	length of the decompressed data, or ULINT_UNDEFINED if the
+input is corrupted or does not fit in dst_len */
+UNIV_INTERN
+ulint
+ut_lz4_decompress(
+/*==============*/
+	const byte*	src,	/*!< in: compressed data */
+	ulint		src_len,/*!< in: length of src */
+	byte*		dst,	/*!< out: decompressed data */
+	ulint		dst_len)/*!< in: size of dst */
+{
+	const byte*	ip	= src;
+	const byte*	iend	= src + src_len;
+	byte*		op	= dst;
+	byte*		oend	= dst + dst_len;
+
+	for (;;) {
+		ulint		token;
+		ulint		len;
+		ulint		offset;
+		const byte*	ref;
+		ulint		s;
+
+		if (UNIV_UNLIKELY(ip >= iend)) {
+
+			return(ULINT_UNDEFINED);
+		}
+
+		token = *ip++;
+
+		/* Copy the literals. */
+		len = token >> 4;
+
+		if (len == UT_LZ4_RUN_MASK) {
+			do {
+				if (UNIV_UNLIKELY(ip >= iend)) {
+
+					return(ULINT_UNDEFINED);
+				}
+
+				s = *ip++;
+				len += s;
+			} while (s == 255);
+		}
+
+		if (UNIV_UNLIKELY(len > (ulint) (iend - ip)
+				  || len > (ulint) (oend - op))) {
+
+			return(ULINT_UNDEFINED);
+		}
+
+		memcpy(op, ip, len);
+		op += len;
+		ip += len;
+
+		if (ip == iend) {
+			/* The last sequence has no match. */
+			break;
+		}
+
+		/* Copy the match. */
+		if (UNIV_UNLIKELY(iend - ip < 2)) {
+
+			return(ULINT_UNDEFINED);
+		}
+
+		offset = ip[0] | ((ulint) ip[1] << 8);
+		ip += 2;
+
+		if (UNIV_UNLIKELY(offset == 0
+				  || offset > (ulint) (op - dst))) {
+
+			return(ULINT_UNDEFINED);
+		}
+
+		len = token & UT_LZ4_RUN_MASK;
+
+		if (len == UT_LZ4_RUN_MASK) {
+			do {
+				if (UNIV_UNLIKELY(ip >= iend)) {
+
+					return(ULINT_UNDEFINED);
+				}
+
+				s = *ip++;
+				len += s;
+			} while (s == 255);
+		}
+
+		len += UT_LZ4_MIN_MATCH;
+
+		if (UNIV_UNLIKELY(len > (ulint) (oend - op))) {
+
+			return(ULINT_UNDEFINED);
+		}
+
+		ref = op - offset;
+
+		if (offset >= len) {
+			memcpy(op, ref, len);
+			op += len;
+		} else {
+			/* The match overlaps the output: copy it
+			byte by byte to replicate the pattern. */
+			while (len--) {
+				*op++ = *ref++;
+			}
+		}
+	}
+
+	return(op - dst);
+}
@@ -1234,6 +1234,15 @@ thd_is_select(
 	return(FALSE);
 }
 
+ibool
+thd_trx_is_auto_commit(
+	const void*	thd)
+{
+	(void)thd;
+	fprintf(stderr, "xtrabackup: thd_trx_is_auto_commit() is called\n");
+	return(FALSE);
+}
+
 void
 innobase_mysql_prepare_print_arbitrary_thd(void)
 {